@@ -0,0 +1,79 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_ARENA_H
+#define ASL_ARENA_H
+
+#include <asl/defs.h>
+
+namespace asl {
+
+/**
+An Arena is a memory region from which blocks are allocated by just advancing a pointer, and that is released all at
+once instead of block by block.
+
+Arrays can be allocated in an arena (`Array<T>(arena, n)`); if they later grow beyond their capacity they move to the
+heap (and stop holding the arena), so arrays copied out of an arena can be modified anywhere. The JSON and XDL decoders
+can put the string values and arrays of a Var tree (and the property lists of its objects) in an arena, which avoids
+a malloc per value while decoding and a free per value when discarding it (object keys longer than 15 bytes still
+use the heap):
+
+~~~
+Arena arena;
+Var request = Json::decode(body, arena);
+handle(request["items"]);
+~~~
+
+The region stays alive while the Arena or any array allocated in it exists, so vars and arrays can be copied and kept
+after the Arena object is gone (but then they keep the whole region in memory; use `Var::clone()` to get a fully
+independent copy). Allocation in the same arena should not happen from several threads at once.
+*/
+class ASL_API Arena
+{
+public:
+	struct Region
+	{
+		char* p;
+		char* end;
+		void* chunks;
+		size_t chunkSize;
+		Long size;
+		AtomicCount rc;
+		/**
+		Returns a block of `n` bytes aligned to 16 bytes
+		*/
+		void* alloc(size_t n)
+		{
+			n = (n + 15) & ~(size_t)15;
+			if ((size_t)(end - p) < n)
+				return allocChunk(n);
+			void* q = p;
+			p += n;
+			return q;
+		}
+		void* allocChunk(size_t n);
+		void retain() { ++rc; }
+		void release();
+	};
+	/**
+	Constructs an arena that reserves memory in chunks of `chunkSize` bytes (larger blocks get their own chunk)
+	*/
+	ASL_EXPLICIT Arena(int chunkSize = 65536);
+	~Arena() { _r->release(); }
+	/**
+	Returns a block of `n` bytes aligned to 16 bytes, valid while the arena exists
+	*/
+	void* alloc(size_t n) { return _r->alloc(n); }
+	/**
+	Returns the total memory reserved by the arena in bytes
+	*/
+	Long size() const { return _r->size; }
+	Region* region() const { return _r; }
+private:
+	Arena(const Arena&);
+	void operator=(const Arena&);
+	Region* _r;
+};
+
+}
+#endif
@@ -16,6 +16,8 @@ class Array;
 }
 
 #include <asl/defs.h>
+#include <asl/Arena.h>
+#include <asl/ArrayOps.h>
 #include "foreach1.h"
 #include <string.h>
 #include <stdlib.h>
@@ -69,9 +71,12 @@ class Array
 {
 protected:
 	T* _a;
-	struct Data{int n, s; AtomicCount rc; int pad;}; // n=num. elems, s=allocated size
+	struct Data{int n, s; AtomicCount rc; int arena;}; // n=num. elems, s=allocated size, arena=1 if in an Arena
 	Data& d() const {return *((Data*)_a-1);}
-	void alloc(int m);
+	Arena::Region* region() const { return *(Arena::Region**)((char*)_a - sizeof(Data) - 16); }
+	T* newBlock(int s, Arena::Region* region);
+	void toHeap(int s);
+	void alloc(int m, Arena* arena = 0);
 	void free();
 	ASL_EXPLICIT Array(T* p);
 	/*ASL_EXPLICIT*/ operator void* () { return NULL; }
@@ -95,6 +100,11 @@ public:
 	Creates an array of n elements and gives them the value x
 	*/
 	ASL_EXPLICIT Array(int n, const T& x) { alloc(n); for (int i = 0; i<n; i++) _a[i] = x; }
+	/**
+	Creates an array of n elements allocated in an Arena, and the arena memory is kept while the array exists;
+	when it grows beyond its capacity it moves to the heap (so arena arrays can later be modified from any thread)
+	*/
+	ASL_EXPLICIT Array(Arena& arena, int n = 0) { alloc(n, &arena); }
 	template<class K>
 	Array(const Array<K>& b)
 	{
@@ -128,14 +138,14 @@ public:
 	~Array() {if(_a && --d().rc==0) free();}
 
 	/**
-	Returns a copy of this array with all element converted to another type
+	Returns a copy of this array with all element converted to another type (as with a C++ cast, so ints converted to byte
+	keep their low 8 bits)
 	*/
 	template<class K>
 	Array<K> with() const
 	{
 		Array<K> b(length());
-		for (int i = 0; i < length(); i++)
-			b[i] = (K)_a[i];
+		ops::cast(_a, b.ptr(), length());
 		return b;
 	}
 
@@ -606,12 +616,15 @@ Array<T>& Array<T>::resize(int m)
 	int s1 = (m > s)? max(8*s/4, m) : s;
 	T* b = _a;
 	int n=d().n;
+	if(s1 != s && d().arena)
+	{
+		toHeap(s1);
+		b = _a;
+		s = s1;
+	}
 	if(s1 != s && s*sizeof(T) < 2048)
 	{
-		char* p = (char*) malloc( s1*sizeof(T)+sizeof(Data) );
-		if(!p)
-			ASL_BAD_ALLOC();
-		b = (T*) ( p + sizeof(Data) );
+		b = newBlock(s1, 0);
 		int i = min(m,n), j = sizeof(T), k = i*j;
 		memcpy(b, _a, k);
 	}
@@ -630,8 +643,7 @@ Array<T>& Array<T>::resize(int m)
 	if(s1 != s)
 	{
 		int rc = d().rc;
-		char* p = (char*)_a - sizeof(Data);
-		::free(p);
+		::free((char*)_a - sizeof(Data));
 		_a = b;
 		d().rc = rc;
 		d().s = s1;
@@ -654,11 +666,15 @@ Array<T>& Array<T>::insert(int k, const T& x)
 		if (n == 2147483647)
 			ASL_BAD_ALLOC();
 		int s1 = s < 1073741823 ? 2 * s : 2147483647;
-		char* p = (char*)realloc((char*)_a - sizeof(Data), s1 * sizeof(T) + sizeof(Data));
-		if(!p)
-			ASL_BAD_ALLOC();
-		T* b = (T*) ( p + sizeof(Data) );
-		_a = b;
+		if (h->arena)
+			toHeap(s1);
+		else
+		{
+			char* p = (char*)realloc((char*)_a - sizeof(Data), s1 * sizeof(T) + sizeof(Data));
+			if(!p)
+				ASL_BAD_ALLOC();
+			_a = (T*) ( p + sizeof(Data) );
+		}
 		h = &d();
 		h->s=s1;
 	}
@@ -670,14 +686,60 @@ Array<T>& Array<T>::insert(int k, const T& x)
 	return *this;
 }
 
+// allocates a block for s elements and the header, in the heap or in an arena region (then preceded by a pointer to
+// it); a region reference is taken by alloc() and released by free() or when the block moves to the heap
+
+template<class T>
+T* Array<T>::newBlock(int s, Arena::Region* region)
+{
+	char* p;
+	if (region)
+	{
+		p = (char*)region->alloc(s * sizeof(T) + sizeof(Data) + 16) + 16;
+		*(Arena::Region**)(p - 16) = region;
+	}
+	else
+	{
+		p = (char*)malloc(s * sizeof(T) + sizeof(Data));
+		if (!p)
+			ASL_BAD_ALLOC();
+	}
+	((Data*)p)->arena = region ? 1 : 0;
+	return (T*)(p + sizeof(Data));
+}
+
+// moves an arena block to the heap with room for s elements: the elements are moved if this array is the only user of
+// the block, or copied otherwise (then the other arrays keep the old block)
+
 template<class T>
-void Array<T>::alloc(int m)
+void Array<T>::toHeap(int s)
+{
+	int n = d().n;
+	T* b = newBlock(s, 0);
+	if (d().rc == 1)
+	{
+		memcpy((void*)b, _a, n * sizeof(T));
+		region()->release();
+	}
+	else
+	{
+		for (int i = 0; i < n; i++)
+			asl_construct_copy(b + i, _a[i]);
+		--d().rc;
+	}
+	_a = b;
+	d().n = n;
+	d().s = s;
+	d().rc = 1;
+}
+
+template<class T>
+void Array<T>::alloc(int m, Arena* arena)
 {
 	int s=max(m, 3);
-	char* p = (char*) malloc( s*sizeof(T)+sizeof(Data) );
-	if(!p)
-		ASL_BAD_ALLOC();
-	_a = (T*) ( p + sizeof(Data) );
+	_a = newBlock(s, arena ? arena->region() : 0);
+	if (arena)
+		arena->region()->retain();
 	d().s = s;
 	d().n = m;
 	d().rc=1;
@@ -688,7 +750,10 @@ template<class T>
 void Array<T>::free()
 {
 	asl_destroy(_a, d().n);
-	::free( (char*)_a - sizeof(Data) );
+	if (d().arena)
+		region()->release();
+	else
+		::free( (char*)_a - sizeof(Data) );
 	_a=0;
 }
 
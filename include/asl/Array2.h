@@ -10,6 +10,118 @@ namespace asl {
 
 struct IndexIJEnumerator;
 
+template <class T>
+class Array2;
+
+/**
+A non-owning view of a rectangular block of a 2D array (or of any row-major buffer with a given row stride). Views
+are created with Array2::view(), Array2::rowView() and Array2::colView() and access the elements of the original
+array without copying them, so they are cheap to create and pass around, but they must not outlive it.
+
+~~~
+Array2<float> frame(480, 640);
+Array2View<float> roi = frame.view(100, 200, 300, 400);   // rows [100, 200), columns [300, 400)
+roi.set(0);                          // clears that region of frame
+Array2<float> copy = roi.clone();    // an independent 100 x 100 array
+float x = frame.colView(5)(10, 0);   // frame(10, 5)
+~~~
+
+Like Array, views do not propagate constness: a view of a const array can modify its elements.
+\ingroup Containers
+*/
+template <class T>
+class Array2View
+{
+public:
+	Array2View() : _p(0), _rows(0), _cols(0), _stride(0) {}
+	/**
+	Creates a view of rows x cols elements starting at p, with `stride` elements between the starts of rows
+	*/
+	Array2View(T* p, int rows, int cols, int stride) : _p(p), _rows(rows), _cols(cols), _stride(stride) {}
+	/**
+	Creates a view of a whole array
+	*/
+	Array2View(const Array2<T>& a) : _p(const_cast<T*>(a.data().ptr())), _rows(a.rows()), _cols(a.cols()), _stride(a.cols()) {}
+	/**
+	Returns the number of rows
+	*/
+	int rows() const { return _rows; }
+	/**
+	Returns the number of columns
+	*/
+	int cols() const { return _cols; }
+	/**
+	Returns the number of elements between the starts of consecutive rows
+	*/
+	int stride() const { return _stride; }
+	/**
+	Returns a pointer to the first element
+	*/
+	T* ptr() const { return _p; }
+	/**
+	Returns true if the rows are consecutive in memory
+	*/
+	bool isContiguous() const { return _stride == _cols || _rows <= 1; }
+	/**
+	Returns the element at row i, column j
+	*/
+	T& operator()(int i, int j) const { return _p[i * _stride + j]; }
+	/**
+	Returns a pointer to the start of row i
+	*/
+	T* operator[](int i) const { return _p + i * _stride; }
+	/**
+	Returns a view of rows [i1, i2) and columns [j1, j2) of this view
+	*/
+	Array2View view(int i1, int i2, int j1, int j2) const { return Array2View(_p + i1 * _stride + j1, i2 - i1, j2 - j1, _stride); }
+	/**
+	Returns a view of row i
+	*/
+	Array2View rowView(int i) const { return view(i, i + 1, 0, _cols); }
+	/**
+	Returns a view of column j
+	*/
+	Array2View colView(int j) const { return view(0, _rows, j, j + 1); }
+	/**
+	Sets all elements to value x
+	*/
+	void set(const T& x) const
+	{
+		for (int i = 0; i < _rows; i++)
+		{
+			T* p = (*this)[i];
+			for (int j = 0; j < _cols; j++)
+				p[j] = x;
+		}
+	}
+	/**
+	Copies the elements of b, which must have the same size, into this view
+	*/
+	void copy(const Array2View& b) const
+	{
+		for (int i = 0; i < _rows; i++)
+		{
+			T* p = (*this)[i];
+			const T* q = b[i];
+			for (int j = 0; j < _cols; j++)
+				p[j] = q[j];
+		}
+	}
+	/**
+	Returns a new array with a copy of the elements of this view
+	*/
+	Array2<T> clone() const
+	{
+		Array2<T> a(_rows, _cols);
+		if (_rows > 0 && _cols > 0)
+			Array2View(a).copy(*this);
+		return a;
+	}
+private:
+	T* _p;
+	int _rows, _cols, _stride;
+};
+
 /**
 A simple 2-dimensional dynamic array or matrix
 
@@ -56,7 +168,7 @@ public:
 	Creates an array of rows x cols elements and copies them from the pointer p (row-wise)
 	*/
 	ASL_EXPLICIT Array2(int rows, int cols, const T* p) :
-		_a(rows * cols, p), _rows(rows), _cols(cols)
+		_a(p, rows * cols), _rows(rows), _cols(cols)
 	{}
 
 	ASL_EXPLICIT Array2(int rows, int cols, const Array<T>& a) :
@@ -147,6 +259,37 @@ public:
 		return b;
 	}
 
+	/**
+	Returns a view (without copying) of rows [i1, i2) and columns [j1, j2)
+	*/
+	Array2View<T> view(int i1, int i2, int j1, int j2) const { return Array2View<T>(*this).view(i1, i2, j1, j2); }
+
+	/**
+	Returns a view of the whole array
+	*/
+	Array2View<T> view() const { return Array2View<T>(*this); }
+
+	/**
+	Returns a view of row i
+	*/
+	Array2View<T> rowView(int i) const { return view(i, i + 1, 0, _cols); }
+
+	/**
+	Returns a view of column j
+	*/
+	Array2View<T> colView(int j) const { return view(0, _rows, j, j + 1); }
+
+	/**
+	Returns this array transposed
+	*/
+	Array2 transposed() const
+	{
+		Array2 b(_cols, _rows);
+		if (_a.length() > 0)
+			ops::transpose(_a.ptr(), _rows, _cols, b._a.ptr());
+		return b;
+	}
+
 	/**
 	Resizes the matrix to r x c
 	*/
@@ -0,0 +1,436 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_ARRAYOPS_H
+#define ASL_ARRAYOPS_H
+
+#include <asl/defs.h>
+#include <math.h>
+
+namespace asl {
+
+template<class T>
+class Array;
+
+template<class T>
+class Array2;
+
+/**
+Types used by the array kernels for element type T: `Sum` for sums and dot products (64-bit for integers) and
+`Real` for norms.
+\ingroup Math3D
+*/
+template<class T>
+struct ArrayOpTraits
+{
+	typedef T Value;
+	typedef T Sum;
+	typedef T Real;
+};
+
+template<>
+struct ArrayOpTraits<int>
+{
+	typedef int Value;
+	typedef Long Sum;
+	typedef double Real;
+};
+
+template<>
+struct ArrayOpTraits<byte>
+{
+	typedef byte Value;
+	typedef Long Sum;
+	typedef double Real;
+};
+
+namespace ops {
+
+/**
+\defgroup ArrayOps Array kernels
+
+Numeric kernels on contiguous arrays of `float`, `double`, `int` and `byte`. They use AVX2 when the CPU supports it
+(checked at run time) and portable code otherwise. Other element types use generic loops.
+
+They are in namespace `asl::ops` and work on raw pointers (output pointers can be equal to input pointers for
+in-place operation), or on `Array`, `Array2` and `Matrix_` objects, returning new arrays:
+
+~~~
+Array<float> a = ..., b = ...;
+float s = ops::sum(a), d = ops::dot(a, b);
+float lo, hi;
+ops::minmax(a, lo, hi);
+Array<float> c = ops::add(a, ops::multiply(b, b));
+Array2<byte> img = ...;
+Array2<float> fimg = img.with<float>();  // vectorized conversion
+~~~
+
+Integer sums and dot products are accumulated in 64 bits. Elementwise integer results wrap around as in C++, except
+`convert()` to `byte`, which saturates to [0, 255]. `cast()`, used by `Array::with()`, is a plain C++ cast instead.
+\ingroup Math3D
+@{
+*/
+
+ASL_API float sum(const float* a, int n);
+ASL_API double sum(const double* a, int n);
+ASL_API Long sum(const int* a, int n);
+ASL_API Long sum(const byte* a, int n);
+
+/**
+Returns the sum of the n elements of a
+*/
+template<class T>
+typename ArrayOpTraits<T>::Sum sum(const T* a, int n)
+{
+	typename ArrayOpTraits<T>::Sum s = 0;
+	for (int i = 0; i < n; i++)
+		s += a[i];
+	return s;
+}
+
+ASL_API float dot(const float* a, const float* b, int n);
+ASL_API double dot(const double* a, const double* b, int n);
+ASL_API Long dot(const int* a, const int* b, int n);
+ASL_API Long dot(const byte* a, const byte* b, int n);
+
+/**
+Returns the dot product of the n elements of a and b
+*/
+template<class T>
+typename ArrayOpTraits<T>::Sum dot(const T* a, const T* b, int n)
+{
+	typename ArrayOpTraits<T>::Sum s = 0;
+	for (int i = 0; i < n; i++)
+		s += a[i] * b[i];
+	return s;
+}
+
+/**
+Returns the Euclidean norm of the n elements of a
+*/
+template<class T>
+typename ArrayOpTraits<T>::Real norm(const T* a, int n)
+{
+	return sqrt((typename ArrayOpTraits<T>::Real)dot(a, a, n));
+}
+
+ASL_API void minmax(const float* a, int n, float& lo, float& hi);
+ASL_API void minmax(const double* a, int n, double& lo, double& hi);
+ASL_API void minmax(const int* a, int n, int& lo, int& hi);
+ASL_API void minmax(const byte* a, int n, byte& lo, byte& hi);
+
+/**
+Computes the minimum and maximum of the n elements of a (lo and hi are not modified if n is 0)
+*/
+template<class T>
+void minmax(const T* a, int n, T& lo, T& hi)
+{
+	if (n <= 0)
+		return;
+	lo = hi = a[0];
+	for (int i = 1; i < n; i++)
+	{
+		if (a[i] < lo) lo = a[i];
+		if (a[i] > hi) hi = a[i];
+	}
+}
+
+ASL_API void scale(const float* a, float s, float* out, int n);
+ASL_API void scale(const double* a, double s, double* out, int n);
+ASL_API void scale(const int* a, int s, int* out, int n);
+ASL_API void scale(const byte* a, byte s, byte* out, int n);
+
+/**
+Computes out = a * s for n elements
+*/
+template<class T>
+void scale(const T* a, typename ArrayOpTraits<T>::Value s, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = a[i] * s;
+}
+
+ASL_API void add(const float* a, const float* b, float* out, int n);
+ASL_API void add(const double* a, const double* b, double* out, int n);
+ASL_API void add(const int* a, const int* b, int* out, int n);
+ASL_API void add(const byte* a, const byte* b, byte* out, int n);
+
+/**
+Computes out = a + b for n elements
+*/
+template<class T>
+void add(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = a[i] + b[i];
+}
+
+ASL_API void subtract(const float* a, const float* b, float* out, int n);
+ASL_API void subtract(const double* a, const double* b, double* out, int n);
+ASL_API void subtract(const int* a, const int* b, int* out, int n);
+ASL_API void subtract(const byte* a, const byte* b, byte* out, int n);
+
+/**
+Computes out = a - b for n elements
+*/
+template<class T>
+void subtract(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = a[i] - b[i];
+}
+
+ASL_API void multiply(const float* a, const float* b, float* out, int n);
+ASL_API void multiply(const double* a, const double* b, double* out, int n);
+ASL_API void multiply(const int* a, const int* b, int* out, int n);
+ASL_API void multiply(const byte* a, const byte* b, byte* out, int n);
+
+/**
+Computes the elementwise product out = a * b for n elements
+*/
+template<class T>
+void multiply(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = a[i] * b[i];
+}
+
+ASL_API void clamp(const float* a, float lo, float hi, float* out, int n);
+ASL_API void clamp(const double* a, double lo, double hi, double* out, int n);
+ASL_API void clamp(const int* a, int lo, int hi, int* out, int n);
+ASL_API void clamp(const byte* a, byte lo, byte hi, byte* out, int n);
+
+/**
+Computes out = a limited to the range [lo, hi] for n elements
+*/
+template<class T>
+void clamp(const T* a, typename ArrayOpTraits<T>::Value lo, typename ArrayOpTraits<T>::Value hi, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = asl::clamp(a[i], lo, hi);
+}
+
+ASL_API void convert(const float* a, double* out, int n);
+ASL_API void convert(const float* a, int* out, int n);
+ASL_API void convert(const float* a, byte* out, int n);
+ASL_API void convert(const double* a, float* out, int n);
+ASL_API void convert(const double* a, int* out, int n);
+ASL_API void convert(const double* a, byte* out, int n);
+ASL_API void convert(const int* a, float* out, int n);
+ASL_API void convert(const int* a, double* out, int n);
+ASL_API void convert(const int* a, byte* out, int n);
+ASL_API void convert(const byte* a, float* out, int n);
+ASL_API void convert(const byte* a, double* out, int n);
+ASL_API void convert(const byte* a, int* out, int n);
+
+/**
+Converts n elements of a to type K into out (floating point values are truncated toward zero)
+*/
+template<class T, class K>
+void convert(const T* a, K* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = (K)a[i];
+}
+
+ASL_API void cast(const int* a, byte* out, int n);
+
+/**
+Converts n elements of a to type K into out like `(K)a[i]` (ints cast to byte keep their low 8 bits), using the
+vectorized `convert()` where it gives the same result
+*/
+template<class T, class K>
+void cast(const T* a, K* out, int n)
+{
+	convert(a, out, n);
+}
+
+template<class T>
+void cast(const T* a, byte* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = (byte)a[i];
+}
+
+ASL_API void transpose(const float* a, int rows, int cols, int lda, float* out, int ldo);
+ASL_API void transpose(const double* a, int rows, int cols, int lda, double* out, int ldo);
+ASL_API void transpose(const int* a, int rows, int cols, int lda, int* out, int ldo);
+ASL_API void transpose(const byte* a, int rows, int cols, int lda, byte* out, int ldo);
+
+/**
+Writes into out (cols x rows) the transpose of a (rows x cols), both row-major with row strides lda and ldo,
+processing it in tiles that fit in the cache (with SIMD register tiles for 4 and 8-byte types)
+*/
+template<class T>
+void transpose(const T* a, int rows, int cols, int lda, T* out, int ldo)
+{
+	const int B = 32;
+	for (int i0 = 0; i0 < rows; i0 += B)
+		for (int j0 = 0; j0 < cols; j0 += B)
+		{
+			int i1 = min(i0 + B, rows), j1 = min(j0 + B, cols);
+			for (int i = i0; i < i1; i++)
+				for (int j = j0; j < j1; j++)
+					out[j * ldo + i] = a[i * lda + j];
+		}
+}
+
+/**
+Writes into out (cols x rows) the transpose of a (rows x cols), both contiguous and row-major
+*/
+template<class T>
+void transpose(const T* a, int rows, int cols, T* out)
+{
+	transpose(a, rows, cols, cols, out, rows);
+}
+
+/**
+Returns the sum of the elements of a
+*/
+template<class T>
+typename ArrayOpTraits<T>::Sum sum(const Array<T>& a) { return sum(a.ptr(), a.length()); }
+
+/**
+Returns the dot product of a and b (which should have the same length)
+*/
+template<class T>
+typename ArrayOpTraits<T>::Sum dot(const Array<T>& a, const Array<T>& b) { return dot(a.ptr(), b.ptr(), min(a.length(), b.length())); }
+
+/**
+Returns the Euclidean norm of a
+*/
+template<class T>
+typename ArrayOpTraits<T>::Real norm(const Array<T>& a) { return norm(a.ptr(), a.length()); }
+
+/**
+Computes the minimum and maximum elements of a
+*/
+template<class T>
+void minmax(const Array<T>& a, T& lo, T& hi) { minmax(a.ptr(), a.length(), lo, hi); }
+
+/**
+Returns a multiplied by s
+*/
+template<class T>
+Array<T> scale(const Array<T>& a, typename ArrayOpTraits<T>::Value s)
+{
+	Array<T> c(a.length());
+	scale(a.ptr(), s, c.ptr(), a.length());
+	return c;
+}
+
+/**
+Returns the sum of a and b (or an empty array if their lengths differ)
+*/
+template<class T>
+Array<T> add(const Array<T>& a, const Array<T>& b)
+{
+	if (a.length() != b.length())
+		return Array<T>();
+	Array<T> c(a.length());
+	add(a.ptr(), b.ptr(), c.ptr(), a.length());
+	return c;
+}
+
+/**
+Returns a minus b (or an empty array if their lengths differ)
+*/
+template<class T>
+Array<T> subtract(const Array<T>& a, const Array<T>& b)
+{
+	if (a.length() != b.length())
+		return Array<T>();
+	Array<T> c(a.length());
+	subtract(a.ptr(), b.ptr(), c.ptr(), a.length());
+	return c;
+}
+
+/**
+Returns the elementwise product of a and b (or an empty array if their lengths differ)
+*/
+template<class T>
+Array<T> multiply(const Array<T>& a, const Array<T>& b)
+{
+	if (a.length() != b.length())
+		return Array<T>();
+	Array<T> c(a.length());
+	multiply(a.ptr(), b.ptr(), c.ptr(), a.length());
+	return c;
+}
+
+/**
+Returns a with its elements limited to the range [lo, hi]
+*/
+template<class T>
+Array<T> clamp(const Array<T>& a, T lo, T hi)
+{
+	Array<T> c(a.length());
+	clamp(a.ptr(), lo, hi, c.ptr(), a.length());
+	return c;
+}
+
+template<class T>
+typename ArrayOpTraits<T>::Sum sum(const Array2<T>& a) { return sum(a.data()); }
+
+template<class T>
+typename ArrayOpTraits<T>::Sum dot(const Array2<T>& a, const Array2<T>& b) { return dot(a.data(), b.data()); }
+
+template<class T>
+typename ArrayOpTraits<T>::Real norm(const Array2<T>& a) { return norm(a.data()); }
+
+template<class T>
+void minmax(const Array2<T>& a, T& lo, T& hi) { minmax(a.data(), lo, hi); }
+
+template<class T>
+Array2<T> scale(const Array2<T>& a, typename ArrayOpTraits<T>::Value s)
+{
+	return Array2<T>(a.rows(), a.cols(), scale(a.data(), s));
+}
+
+template<class T>
+Array2<T> add(const Array2<T>& a, const Array2<T>& b)
+{
+	if (a.rows() != b.rows() || a.cols() != b.cols())
+		return Array2<T>();
+	return Array2<T>(a.rows(), a.cols(), add(a.data(), b.data()));
+}
+
+template<class T>
+Array2<T> subtract(const Array2<T>& a, const Array2<T>& b)
+{
+	if (a.rows() != b.rows() || a.cols() != b.cols())
+		return Array2<T>();
+	return Array2<T>(a.rows(), a.cols(), subtract(a.data(), b.data()));
+}
+
+template<class T>
+Array2<T> multiply(const Array2<T>& a, const Array2<T>& b)
+{
+	if (a.rows() != b.rows() || a.cols() != b.cols())
+		return Array2<T>();
+	return Array2<T>(a.rows(), a.cols(), multiply(a.data(), b.data()));
+}
+
+template<class T>
+Array2<T> clamp(const Array2<T>& a, T lo, T hi)
+{
+	return Array2<T>(a.rows(), a.cols(), clamp(a.data(), lo, hi));
+}
+
+/**
+Returns the transpose of a
+*/
+template<class T>
+Array2<T> transpose(const Array2<T>& a)
+{
+	Array2<T> b(a.cols(), a.rows());
+	if (b.data().length() > 0)
+		transpose(a.data().ptr(), a.rows(), a.cols(), b.data().ptr());
+	return b;
+}
+
+/**@}*/
+
+}
+}
+#endif
@@ -0,0 +1,71 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_CBOR_H
+#define ASL_CBOR_H
+
+#include <asl/Var.h>
+#include <asl/StreamBuffer.h>
+
+namespace asl {
+
+/**
+Functions to encode/decode data in the binary CBOR format (RFC 8949). These functions use class Var to represent values,
+like the JSON functions, but the result is more compact and much faster to encode and decode, and numbers keep their
+exact value and type (int, float or double).
+
+Arrays whose elements are all floats, all doubles or all ints are encoded as typed arrays (RFC 8746), a raw block of
+little-endian numbers, which is the most efficient way to transfer large numeric arrays. Any CBOR typed array can be
+decoded (into a Var array of numbers).
+
+~~~
+Array<byte> data = Cbor::encode(Var("points", points)("id", 5));
+Var v = Cbor::decode(data);
+
+ws.send(Cbor::encode(v));                 // send as a binary WebSocket message
+Var msg = Cbor::decode(ws.receive());
+
+HttpRequest request("POST", url);
+request.setHeader("Content-Type", "application/cbor");
+request.put(v);                           // a Var body is encoded as CBOR with this content type
+~~~
+
+Decoding malformed or truncated data gives a `Var::NONE` var.
+
+\ingroup XDL
+*/
+struct ASL_API Cbor
+{
+	/**
+	Encodes the given Var into CBOR
+	*/
+	static Array<byte> encode(const Var& v);
+
+	/**
+	Encodes the given Var into CBOR appending it to a StreamBuffer
+	*/
+	static void encode(const Var& v, StreamBuffer& out);
+
+	/**
+	Decodes a Var from CBOR data
+	*/
+	static Var decode(const Array<byte>& data);
+
+	/**
+	Decodes the next CBOR item from a StreamBufferReader, leaving the reader after it
+	*/
+	static Var decode(StreamBufferReader& in);
+
+	/**
+	Reads and decodes data from a file in CBOR format
+	*/
+	static Var read(const String& file);
+
+	/**
+	Writes a var to a file in CBOR format
+	*/
+	static bool write(const String& file, const Var& v);
+};
+
+}
+#endif
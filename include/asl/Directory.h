@@ -88,6 +88,11 @@ public:
 	Returns the subdirectories of a directory
 	*/
 	const Array<File> subdirs(const String& which="*") {return items(which, DIRE);}
+	/**
+	Returns the files in this directory and all its subdirectories (recursively), using up to `nthreads` threads
+	to scan separate subtrees. Symbolic links to directories are not followed.
+	*/
+	const Array<File> filesRecursive(const String& which = "*", int nthreads = 4);
 	static FileInfo getInfo(const String& path);
 	/**
 	Returns the current working directory
@@ -125,6 +130,8 @@ public:
 	Removes the given directory with all its content recursively and returns true on success (USE WITH CARE!)
 	*/
 	static bool removeRecursive(const String& path);
+protected:
+	static bool removeTree(const String& path);
 };
 
 }
@@ -229,6 +229,12 @@ public:
 	*/
 	int write(const void* p, int n);
 
+	/**
+	Writes `n` blocks of bytes one after the other with a single gather write where available, returning the
+	total number of bytes written
+	*/
+	Long writeBlocks(const StringView* blocks, int n);
+
 	/**
 	Writes variable x to the file respecting endianness in binary form
 	*/
@@ -114,7 +114,7 @@ public:
 
 	void put(const char* body) { put(Array<byte>((const byte*)body, (int)strlen(body))); }
 	/**
-	Sets the body of the message as a JSON document.
+	Sets the body of the message as a JSON document (or CBOR if the Content-Type header is already `application/cbor`).
 	*/
 	void put(const Var& data);
 	/**
@@ -130,7 +130,7 @@ public:
 	*/
 	String text() const;
 	/**
-	Returns the message body interpreted as JSON
+	Returns the message body interpreted as JSON (or CBOR if that is the Content-Type)
 	*/
 	Var json() const;
 
@@ -7,6 +7,8 @@
 
 namespace asl {
 
+class StringBuilder;
+
 /**
  * \defgroup XDL XML, XDL, and JSON
  * @{
@@ -44,7 +46,7 @@ Var data {
 struct ASL_API Json
 {
 	/**
-	Options for Json::encode and Json::write
+	Options for Json::encode and Json::write, and PACKED for decoding
 	*/
 	enum Mode {
 		NONE = 0,    //!< Compact format in a single line
@@ -53,6 +55,7 @@ struct ASL_API Json
 		COMPACT = 4,
 		JSON = 8,
 		EXACT = 16,
+		PACKED = 32, //!< Decode arrays of numbers as packed arrays (see Var::pack())
 		NICE = 3     //!< Same as PRETTY and SIMPLE
 	};
 
@@ -75,11 +78,30 @@ struct ASL_API Json
 	*/
 	static Var decode(const String& json);
 
+	/**
+	Decodes JSON with options; with `PACKED`, arrays whose elements are all numbers are decoded as packed arrays
+	(of ints if all are integers, otherwise of doubles)
+	*/
+	static Var decode(const String& json, Mode mode);
+
+	/**
+	Decodes JSON allocating the string values and arrays of the result (and the property lists of its objects) in an
+	arena; object keys longer than 15 bytes still use the heap. This is faster for documents that are read and then
+	discarded. The arena memory is kept while the result or any part of it exists.
+	*/
+	static Var decode(const String& json, Arena& arena, Mode mode = NONE);
+
 	/**
 	Encodes the given Var into a JSON-format representation. It is similar to JavaScript's
 	`JSON.stringify()`.
 	*/
 	static String encode(const Var& v, Mode mode = NONE);
+
+	/**
+	Encodes the given Var into a JSON-format representation appended to a StringBuilder, which can then be written
+	to a file or socket without joining it into a single string.
+	*/
+	static void encode(const Var& v, StringBuilder& out, Mode mode = NONE);
 };
 
 inline Json::Mode operator|(Json::Mode a, Json::Mode b)
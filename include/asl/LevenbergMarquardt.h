@@ -0,0 +1,238 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_LEVENBERGMARQUARDT_H
+#define ASL_LEVENBERGMARQUARDT_H
+
+#include <asl/Matrix.h>
+#include <asl/Thread.h>
+
+namespace asl {
+
+/**
+ * A nonlinear least-squares solver using the Levenberg-Marquardt method. It finds the vector x that minimizes
+ * |f(x)|<sup>2</sup>, where f is a functor returning a column matrix of residuals for a column matrix of unknowns.
+ *
+ * The Jacobian of f can be given as another functor returning a matrix with one row per residual and one column
+ * per unknown. Otherwise it is approximated with finite differences, whose columns can be evaluated in parallel
+ * (f must then be safe to call from several threads at once).
+ *
+ * ~~~
+ * // fit y = a * exp(b * t) to samples (t[i], y[i])
+ * auto residuals = [&](const Matrixd& p) {
+ *     Matrixd r(n, 1);
+ *     for (int i = 0; i < n; i++)
+ *         r[i] = p[0] * exp(p[1] * t[i]) - y[i];
+ *     return r;
+ * };
+ * LevenbergMarquardt<double> lm;
+ * lm.maxIterations(200).threads(4);
+ * Matrixd p = lm.solve(residuals, Matrixd(2, 1, 1.0));
+ * if (lm.converged())
+ *     printf("a = %f, b = %f, error = %f\n", p[0], p[1], lm.residual());
+ * ~~~
+ *
+ * Each step solves the damped normal equations (J<sup>T</sup>J + &mu; I) h = -J<sup>T</sup>f with a Cholesky
+ * decomposition. The iteration stops when the residual norm, the gradient or the step become smaller than their
+ * tolerances, or after the maximum number of iterations.
+ * \ingroup Math3D
+ */
+template<class T>
+class LevenbergMarquardt
+{
+public:
+	LevenbergMarquardt() :
+		_maxIterations(100),
+		_ftol(sizeof(T) == sizeof(float) ? T(1e-6) : T(1e-12)),
+		_gtol(sizeof(T) == sizeof(float) ? T(1e-6) : T(1e-12)),
+		_xtol(sizeof(T) == sizeof(float) ? T(1e-6) : T(1e-10)),
+		_dx(sizeof(T) == sizeof(float) ? T(3e-4) : T(1.5e-8)),
+		_threads(1), _iterations(0), _residual(0), _converged(false)
+	{}
+	/**
+	 * Sets the maximum number of iterations (attempted steps)
+	 */
+	LevenbergMarquardt& maxIterations(int n) { _maxIterations = n; return *this; }
+	/**
+	 * Stops when the norm of the residual vector is at most `tol`
+	 */
+	LevenbergMarquardt& residualTolerance(T tol) { _ftol = tol; return *this; }
+	/**
+	 * Stops when the largest component of the gradient J<sup>T</sup>f is at most `tol`
+	 */
+	LevenbergMarquardt& gradientTolerance(T tol) { _gtol = tol; return *this; }
+	/**
+	 * Stops when the step norm is at most `tol` relative to the norm of x
+	 */
+	LevenbergMarquardt& stepTolerance(T tol) { _xtol = tol; return *this; }
+	/**
+	 * Sets the relative increment used for finite-difference derivatives
+	 */
+	LevenbergMarquardt& differenceStep(T dx) { _dx = dx; return *this; }
+	/**
+	 * Sets the number of threads used to evaluate finite-difference Jacobian columns
+	 */
+	LevenbergMarquardt& threads(int n) { _threads = n; return *this; }
+
+	/**
+	 * Minimizes |f(x)|<sup>2</sup> starting at x0, computing the Jacobian numerically
+	 */
+	template<class F>
+	Matrix_<T> solve(F f, const Matrix_<T>& x0)
+	{
+		NumericJacobian<F> jacobian(f, _dx, _threads);
+		return minimize(f, jacobian, x0);
+	}
+
+	/**
+	 * Minimizes |f(x)|<sup>2</sup> starting at x0, with the Jacobian computed by functor `jacobian(x)`
+	 */
+	template<class F, class J>
+	Matrix_<T> solve(F f, J jacobian, const Matrix_<T>& x0)
+	{
+		GivenJacobian<J> jac(jacobian);
+		return minimize(f, jac, x0);
+	}
+
+	/**
+	 * Returns the number of iterations done in the last solve
+	 */
+	int iterations() const { return _iterations; }
+	/**
+	 * Returns the norm of the residual vector at the last solution
+	 */
+	T residual() const { return _residual; }
+	/**
+	 * Returns true if the last solve stopped by one of the tolerances rather than by the iteration limit
+	 */
+	bool converged() const { return _converged; }
+
+protected:
+	template<class J>
+	struct GivenJacobian
+	{
+		J& jacobian;
+		GivenJacobian(J& j) : jacobian(j) {}
+		Matrix_<T> operator()(const Matrix_<T>& x, const Matrix_<T>&) { return jacobian(x); }
+	};
+
+	template<class F>
+	struct NumericJacobian
+	{
+		F& f;
+		T dx;
+		int threads;
+		NumericJacobian(F& f, T dx, int n) : f(f), dx(dx), threads(n) {}
+		Matrix_<T> operator()(const Matrix_<T>& x, const Matrix_<T>& fx)
+		{
+			Matrix_<T> J(fx.rows(), x.rows());
+			int nth = min(threads, Thread::numProcessors());
+#ifdef ASL_EXP_THREADING
+			if (nth > 1)
+			{
+				Thread::parallel_for(0, J.cols(), [&](int j) { column(J, x.clone(), fx, j); }, nth);
+				return J;
+			}
+#endif
+			Matrix_<T> x1 = x.clone();
+			for (int j = 0; j < J.cols(); j++)
+				column(J, x1, fx, j);
+			return J;
+		}
+		void column(Matrix_<T>& J, Matrix_<T> x, const Matrix_<T>& fx, int j)
+		{
+			T x0 = x[j], h = dx * max(T(1), (T)fabs(x0));
+			x[j] = x0 + h;
+			Matrix_<T> f2 = f(x);
+			x[j] = x0;
+			for (int i = 0; i < J.rows(); i++)
+				J(i, j) = (f2[i] - fx[i]) / h;
+		}
+	};
+
+	template<class F, class J>
+	Matrix_<T> minimize(F& f, J& jacobian, const Matrix_<T>& x0);
+
+	int _maxIterations;
+	T _ftol, _gtol, _xtol, _dx;
+	int _threads;
+	int _iterations;
+	T _residual;
+	bool _converged;
+};
+
+template<class T>
+template<class F, class J>
+Matrix_<T> LevenbergMarquardt<T>::minimize(F& f, J& jacobian, const Matrix_<T>& x0)
+{
+	Matrix_<T> x = x0.clone();
+	Matrix_<T> r = f(x);
+	T cost = r.normSq();
+	int n = x.rows();
+	_iterations = 0;
+	_converged = false;
+	Matrix_<T> Jt = jacobian(x, r).transposed();
+	Matrix_<T> A = Jt.multiply(Jt.transposed(), _threads), g = Jt * r;
+	T mu = 0, nu = 2;
+	for (int i = 0; i < n; i++)
+		mu = max(mu, A(i, i));
+	mu *= T(1e-3);
+	while (1)
+	{
+		T gmax = 0;
+		for (int i = 0; i < n; i++)
+			gmax = max(gmax, (T)fabs(g[i]));
+		if (sqrt(cost) <= _ftol || gmax <= _gtol)
+		{
+			_converged = true;
+			break;
+		}
+		if (_iterations >= _maxIterations || !(mu < T(1e30)))
+			break;
+		_iterations++;
+		Matrix_<T> N = A.clone();
+		for (int i = 0; i < n; i++)
+			N(i, i) += mu;
+		Cholesky<T> chol(N);
+		if (!chol.ok())
+		{
+			mu *= nu;
+			nu *= 2;
+			continue;
+		}
+		Matrix_<T> h = chol.solve(-g);
+		if (h.norm() <= _xtol * (x.norm() + _xtol))
+		{
+			_converged = true;
+			break;
+		}
+		Matrix_<T> x2 = x + h;
+		Matrix_<T> r2 = f(x2);
+		T cost2 = r2.normSq();
+		T predicted = 0;
+		for (int i = 0; i < n; i++)
+			predicted += h[i] * (mu * h[i] - g[i]);
+		T rho = (cost - cost2) / predicted;
+		if (rho > 0)
+		{
+			x = x2;
+			r = r2;
+			cost = cost2;
+			Jt = jacobian(x, r).transposed();
+			A = Jt.multiply(Jt.transposed(), _threads);
+			g = Jt * r;
+			mu *= max(T(1) / 3, 1 - T(pow(2 * rho - 1, 3)));
+			nu = 2;
+		}
+		else
+		{
+			mu *= nu;
+			nu *= 2;
+		}
+	}
+	_residual = sqrt(cost);
+	return x;
+}
+
+}
+#endif
@@ -13,7 +13,8 @@ template <class T>
 inline int compare(const T& a, const T& b) { return (a<b)? -1 : (a == b) ? 0 : 1; }
 
 inline int compare(const String& a, const char* b) {return a.compare(b);}
-inline int compare(const String& a, const String& b) {return a.compare(b);}
+// the first chars are compared inline, that is enough for most keys in a binary search
+inline int compare(const String& a, const String& b) { int c = (byte)a[0] - (byte)b[0]; return c != 0 ? c : a.compare(b); }
 
 //template <class T>
 //inline int compare(const T* a, const T* b) {int c=a-b; return (c<0)? -1: (c>0)? 1: 0;}
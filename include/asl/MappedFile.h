@@ -0,0 +1,75 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_MAPPEDFILE_H
+#define ASL_MAPPEDFILE_H
+
+#include <asl/String.h>
+
+namespace asl {
+
+/**
+A read-only view of a whole file mapped into memory. The contents can be accessed as a byte array without
+reading them into a buffer first; the operating system loads pages as they are accessed. This is convenient
+to parse or search large files.
+
+~~~
+MappedFile file("table.bin");
+if (file)
+	process(file.data(), file.length());
+~~~
+
+The data is not null-terminated and is only valid while the object exists.
+*/
+class ASL_API MappedFile
+{
+public:
+	/**
+	Constructs a MappedFile with no associated file
+	*/
+	MappedFile() : _data(0), _length(0), _handle(0), _mapping(0), _ok(false) {}
+	/**
+	Maps the file with the given name
+	*/
+	ASL_EXPLICIT MappedFile(const String& name) : _data(0), _length(0), _handle(0), _mapping(0), _ok(false)
+	{
+		open(name);
+	}
+	~MappedFile() { close(); }
+	/**
+	Maps the file with the given name (closing any previous mapping) and returns true on success
+	*/
+	bool open(const String& name);
+	/**
+	Unmaps the file
+	*/
+	void close();
+	/**
+	Returns the file contents (null for an empty file)
+	*/
+	const byte* data() const { return _data; }
+	/**
+	Returns the file contents as chars
+	*/
+	const char* ptr() const { return (const char*)_data; }
+	/**
+	Returns the file size in bytes
+	*/
+	Long length() const { return _length; }
+	/**
+	Returns true if the file was successfully mapped
+	*/
+	operator bool() const { return _ok; }
+	bool operator!() const { return !_ok; }
+private:
+	MappedFile(const MappedFile&);
+	void operator=(const MappedFile&);
+	const byte* _data;
+	Long _length;
+	void* _handle;
+	void* _mapping;
+	bool _ok;
+};
+
+}
+#endif
@@ -8,6 +8,161 @@
 
 namespace asl {
 
+/**
+Computes the matrix product C = A * B, with A of size m x k, B of size k x n and C of size m x n, all stored
+row-major with row strides `lda`, `ldb` and `ldc`. Large products use a cache-blocked kernel (with AVX2/FMA
+if the CPU supports it) and can be split in row blocks among `nthreads` threads.
+\ingroup Math3D
+*/
+ASL_API void matmul(int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc, int nthreads = 1);
+
+ASL_API void matmul(int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc, int nthreads = 1);
+
+template<class T>
+void matmul(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, int nthreads = 1)
+{
+	for (int i = 0; i < m; i++)
+	{
+		T* ci = c + i * ldc;
+		for (int j = 0; j < n; j++)
+			ci[j] = T(0);
+		for (int p = 0; p < k; p++)
+		{
+			T aip = a[i * lda + p];
+			const T* bp = b + p * ldb;
+			for (int j = 0; j < n; j++)
+				ci[j] += aip * bp[j];
+		}
+	}
+}
+
+template<class T>
+class Matrix_;
+
+/**
+Base of lazy elementwise matrix expressions. They are created with `lazy(A)` and combined with `+`, `-`, unary `-`
+and products by scalars, and they are only evaluated when assigned to a matrix, in a single loop and without
+temporary matrices:
+
+~~~
+Matrixd C = lazy(A) * s + B - D;   // one allocation, one pass
+C.assign(lazy(A) * 0.5 + B);       // no allocation, writes in C's current storage
+~~~
+
+Expressions keep references to the matrices they use, so they should not outlive the full expression where they
+are created.
+\ingroup Math3D
+*/
+template<class T, class E>
+struct MatrixExpr
+{
+	typedef T Scalar;
+	const E& self() const { return static_cast<const E&>(*this); }
+};
+
+template<class T>
+struct MatrixRefExpr : public MatrixExpr<T, MatrixRefExpr<T> >
+{
+	const T* p;
+	int r, c;
+	MatrixRefExpr(const Matrix_<T>& m) : p(m.data().ptr()), r(m.rows()), c(m.cols()) {}
+	int rows() const { return r; }
+	int cols() const { return c; }
+	bool ok() const { return true; }
+	T operator[](int i) const { return p[i]; }
+};
+
+struct MatrixAddOp { template<class T> static T apply(T a, T b) { return a + b; } };
+struct MatrixSubOp { template<class T> static T apply(T a, T b) { return a - b; } };
+
+template<class T, class A, class B, class Op>
+struct MatrixBinExpr : public MatrixExpr<T, MatrixBinExpr<T, A, B, Op> >
+{
+	A a;
+	B b;
+	MatrixBinExpr(const A& a, const B& b) : a(a), b(b) {}
+	int rows() const { return a.rows(); }
+	int cols() const { return a.cols(); }
+	bool ok() const { return a.ok() && b.ok() && a.rows() == b.rows() && a.cols() == b.cols(); }
+	T operator[](int i) const { return Op::apply(a[i], b[i]); }
+};
+
+template<class T, class A>
+struct MatrixScaleExpr : public MatrixExpr<T, MatrixScaleExpr<T, A> >
+{
+	A a;
+	T s;
+	MatrixScaleExpr(const A& a, T s) : a(a), s(s) {}
+	int rows() const { return a.rows(); }
+	int cols() const { return a.cols(); }
+	bool ok() const { return a.ok(); }
+	T operator[](int i) const { return a[i] * s; }
+};
+
+template<class T, class A, class B>
+MatrixBinExpr<T, A, B, MatrixAddOp> operator+(const MatrixExpr<T, A>& a, const MatrixExpr<T, B>& b)
+{
+	return MatrixBinExpr<T, A, B, MatrixAddOp>(a.self(), b.self());
+}
+
+template<class T, class A>
+MatrixBinExpr<T, A, MatrixRefExpr<T>, MatrixAddOp> operator+(const MatrixExpr<T, A>& a, const Matrix_<T>& b)
+{
+	return MatrixBinExpr<T, A, MatrixRefExpr<T>, MatrixAddOp>(a.self(), b);
+}
+
+template<class T, class B>
+MatrixBinExpr<T, MatrixRefExpr<T>, B, MatrixAddOp> operator+(const Matrix_<T>& a, const MatrixExpr<T, B>& b)
+{
+	return MatrixBinExpr<T, MatrixRefExpr<T>, B, MatrixAddOp>(a, b.self());
+}
+
+template<class T, class A, class B>
+MatrixBinExpr<T, A, B, MatrixSubOp> operator-(const MatrixExpr<T, A>& a, const MatrixExpr<T, B>& b)
+{
+	return MatrixBinExpr<T, A, B, MatrixSubOp>(a.self(), b.self());
+}
+
+template<class T, class A>
+MatrixBinExpr<T, A, MatrixRefExpr<T>, MatrixSubOp> operator-(const MatrixExpr<T, A>& a, const Matrix_<T>& b)
+{
+	return MatrixBinExpr<T, A, MatrixRefExpr<T>, MatrixSubOp>(a.self(), b);
+}
+
+template<class T, class B>
+MatrixBinExpr<T, MatrixRefExpr<T>, B, MatrixSubOp> operator-(const Matrix_<T>& a, const MatrixExpr<T, B>& b)
+{
+	return MatrixBinExpr<T, MatrixRefExpr<T>, B, MatrixSubOp>(a, b.self());
+}
+
+template<class T, class A>
+MatrixScaleExpr<T, A> operator*(const MatrixExpr<T, A>& a, typename MatrixExpr<T, A>::Scalar s)
+{
+	return MatrixScaleExpr<T, A>(a.self(), s);
+}
+
+template<class T, class A>
+MatrixScaleExpr<T, A> operator*(typename MatrixExpr<T, A>::Scalar s, const MatrixExpr<T, A>& a)
+{
+	return MatrixScaleExpr<T, A>(a.self(), s);
+}
+
+template<class T, class A>
+MatrixScaleExpr<T, A> operator-(const MatrixExpr<T, A>& a)
+{
+	return MatrixScaleExpr<T, A>(a.self(), T(-1));
+}
+
+/**
+Starts a lazy expression with matrix `a` (see MatrixExpr)
+\ingroup Math3D
+*/
+template<class T>
+MatrixRefExpr<T> lazy(const Matrix_<T>& a)
+{
+	return MatrixRefExpr<T>(a);
+}
+
 /**
  * A matrix supporting basic arithmetic operations. With two predefined specializations: `Matrix` for doubles and `Matrixf` for floats.
  * 
@@ -60,6 +215,15 @@ public:
 
 	Matrix_(const Array<T>& a) : Array2<T>(a.length(), 1, a) {}
 
+	/**
+	Creates a matrix with a copy of the elements of a view (a block of another matrix or 2D array)
+	*/
+	ASL_EXPLICIT Matrix_(const Array2View<T>& v) : Array2<T>(v.rows(), v.cols())
+	{
+		if (length() > 0)
+			this->view().copy(v);
+	}
+
 #ifdef ASL_HAVE_INITLIST
 	/**
 	Creates a matrix with size rows x cols and the given elements
@@ -77,6 +241,53 @@ public:
 	Matrix_(std::initializer_list<T> a) : Array2<T>((int)a.size(), 1, a) {}
 #endif
 
+	/**
+	Creates a matrix evaluating a lazy expression (see MatrixExpr)
+	*/
+	template<class E>
+	Matrix_(const MatrixExpr<T, E>& e)
+	{
+		const E& x = e.self();
+		if (!x.ok())
+			return;
+		this->resize(x.rows(), x.cols());
+		T* a = this->_a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			a[i] = x[i];
+	}
+
+	/**
+	Evaluates a lazy expression into this matrix, reusing its storage if it already has the right size (so other
+	matrices sharing it will see the change, as with `+=`). The expression can reference this same matrix.
+	*/
+	template<class E>
+	Matrix_& assign(const MatrixExpr<T, E>& e)
+	{
+		const E& x = e.self();
+		if (!x.ok())
+			return clear();
+		if (x.rows() != this->rows() || x.cols() != this->cols())
+			*this = Matrix_(x.rows(), x.cols());
+		T* a = this->_a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			a[i] = x[i];
+		return *this;
+	}
+
+	/**
+	Adds matrix x multiplied by s to this matrix, in place (this += s * x)
+	*/
+	Matrix_& axpy(T s, const Matrix_& x)
+	{
+		if (this->rows() != x.rows() || this->cols() != x.cols())
+			return *this;
+		T* a = this->_a.ptr();
+		const T* b = x._a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			a[i] += s * b[i];
+		return *this;
+	}
+
 	/**
 	 * Returns the trace of this matrix
 	*/
@@ -173,9 +384,8 @@ public:
 	Matrix_ transposed() const
 	{
 		Matrix_ b(this->_cols, this->_rows);
-		for (int i = 0; i < b.rows(); i++)
-			for (int j = 0; j < b.cols(); j++)
-				b(i, j) = (*this)(j, i);
+		if (length() > 0)
+			ops::transpose(this->_a.ptr(), this->_rows, this->_cols, b._a.ptr());
 		return b;
 	}
 
@@ -185,30 +395,49 @@ public:
 	Matrix_ inverse() const;
 
 	/**
-	 * Computes the pseudoinverse of this matrix.
+	 * Computes the pseudoinverse of this matrix (using a QR decomposition); the matrix must have full rank
 	 */
-	Matrix_ pseudoinverse() const
-	{
-		Matrix_ aT = transposed();
-		return (aT * *this).inverse() * aT;
-	}
+	Matrix_ pseudoinverse() const;
+
+	/**
+	 * Returns the determinant of this matrix, which must be square
+	 */
+	T det() const;
 
 	/**
 	 * Computes the product of this matrix and b
 	 */
 	Matrix_ operator*(const Matrix_& b) const
 	{
-		const Matrix_& a = *this;
+		return multiply(b);
+	}
+
+	/**
+	 * Computes the product of this matrix and a view of a block of another matrix
+	 */
+	Matrix_ operator*(const Array2View<T>& b) const
+	{
+		return multiply(b);
+	}
+
+	/**
+	 * Computes the product of this matrix and b, splitting the work among up to `nthreads` threads for large matrices
+	 */
+	Matrix_ multiply(const Array2View<T>& b, int nthreads = 1) const
+	{
+		return product(this->view(), b, nthreads);
+	}
+
+	/**
+	 * Computes the product of two matrix views (blocks of other matrices, used without copying them)
+	 */
+	static Matrix_ product(const Array2View<T>& a, const Array2View<T>& b, int nthreads = 1)
+	{
 		Matrix_ c(a.rows(), b.cols());
 		if (a.cols() != b.rows())
 			return c.clear();
-		for (int i = 0; i < c.rows(); i++)
-			for (int j = 0; j < c.cols(); j++)
-			{
-				c(i, j) = 0;
-				for (int k = 0; k < a.cols(); k++)
-					c(i, j) += a(i, k) * b(k, j);
-			}
+		if (c.length() > 0)
+			matmul(a.rows(), b.cols(), a.cols(), a.ptr(), a.stride(), b.ptr(), b.stride(), c._a.ptr(), c.cols(), nthreads);
 		return c;
 	}
 	
@@ -218,12 +447,12 @@ public:
 	Matrix_ operator+(const Matrix_& b) const
 	{
 		const Matrix_& a = *this;
-		Matrix_ c(a.rows(), a.cols());
 		if (a.rows() != b.rows() || a.cols() != b.cols())
-			return c.clear();
-		for (int i = 0; i < c.rows(); i++)
-			for (int j = 0; j < c.cols(); j++)
-				c(i, j) = a(i, j) + b(i, j);
+			return Matrix_();
+		Matrix_ c(a.rows(), a.cols());
+		const T* p = a._a.ptr(), *q = b._a.ptr();
+		T* r = c._a.ptr();
+		ops::add(p, q, r, c.length());
 		return c;
 	}
 	
@@ -233,12 +462,38 @@ public:
 	Matrix_ operator-(const Matrix_& b) const
 	{
 		const Matrix_& a = *this;
-		Matrix_ c(a.rows(), a.cols());
 		if (a.rows() != b.rows() || a.cols() != b.cols())
-			return c.clear();
+			return Matrix_();
+		Matrix_ c(a.rows(), a.cols());
+		const T* p = a._a.ptr(), *q = b._a.ptr();
+		T* r = c._a.ptr();
+		ops::subtract(p, q, r, c.length());
+		return c;
+	}
+
+	/**
+	 * Computes the sum of this matrix and a view
+	 */
+	Matrix_ operator+(const Array2View<T>& b) const
+	{
+		if (this->rows() != b.rows() || this->cols() != b.cols())
+			return Matrix_();
+		Matrix_ c(this->rows(), this->cols());
 		for (int i = 0; i < c.rows(); i++)
-			for (int j = 0; j < c.cols(); j++)
-				c(i, j) = a(i, j) - b(i, j);
+			ops::add(&(*this)(i, 0), b[i], &c(i, 0), c.cols());
+		return c;
+	}
+
+	/**
+	 * Computes the subtraction of this matrix and a view
+	 */
+	Matrix_ operator-(const Array2View<T>& b) const
+	{
+		if (this->rows() != b.rows() || this->cols() != b.cols())
+			return Matrix_();
+		Matrix_ c(this->rows(), this->cols());
+		for (int i = 0; i < c.rows(); i++)
+			ops::subtract(&(*this)(i, 0), b[i], &c(i, 0), c.cols());
 		return c;
 	}
 
@@ -249,9 +504,9 @@ public:
 	{
 		const Matrix_& a = *this;
 		Matrix_ c(a.rows(), a.cols());
-		for (int i = 0; i < c.rows(); i++)
-			for (int j = 0; j < c.cols(); j++)
-				c(i, j) = a(i, j) * s;
+		const T* p = a._a.ptr();
+		T* r = c._a.ptr();
+		ops::scale(p, s, r, c.length());
 		return c;
 	}
 
@@ -260,12 +515,30 @@ public:
 	 */
 	void operator+=(const Matrix_& b)
 	{
-		Matrix_& a = *this;
-		if (a.rows() != b.rows() || a.cols() != b.cols())
+		if (this->rows() != b.rows() || this->cols() != b.cols())
 			return;
-		for (int i = 0; i < a.rows(); i++)
-			for (int j = 0; j < a.cols(); j++)
-				a(i, j) += b(i, j);
+		T* p = this->_a.ptr();
+		const T* q = b._a.ptr();
+		ops::add(p, q, p, length());
+	}
+
+	void operator+=(const Array2View<T>& b)
+	{
+		if (this->rows() != b.rows() || this->cols() != b.cols())
+			return;
+		for (int i = 0; i < this->rows(); i++)
+			ops::add(&(*this)(i, 0), b[i], &(*this)(i, 0), this->cols());
+	}
+
+	template<class E>
+	void operator+=(const MatrixExpr<T, E>& e)
+	{
+		const E& x = e.self();
+		if (!x.ok() || this->rows() != x.rows() || this->cols() != x.cols())
+			return;
+		T* p = this->_a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			p[i] += x[i];
 	}
 
 	/**
@@ -273,12 +546,30 @@ public:
 	 */
 	void operator-=(const Matrix_& b)
 	{
-		Matrix_& a = *this;
-		if (a.rows() != b.rows() || a.cols() != b.cols())
+		if (this->rows() != b.rows() || this->cols() != b.cols())
+			return;
+		T* p = this->_a.ptr();
+		const T* q = b._a.ptr();
+		ops::subtract(p, q, p, length());
+	}
+
+	void operator-=(const Array2View<T>& b)
+	{
+		if (this->rows() != b.rows() || this->cols() != b.cols())
 			return;
-		for (int i = 0; i < a.rows(); i++)
-			for (int j = 0; j < a.cols(); j++)
-				a(i, j) -= b(i, j);
+		for (int i = 0; i < this->rows(); i++)
+			ops::subtract(&(*this)(i, 0), b[i], &(*this)(i, 0), this->cols());
+	}
+
+	template<class E>
+	void operator-=(const MatrixExpr<T, E>& e)
+	{
+		const E& x = e.self();
+		if (!x.ok() || this->rows() != x.rows() || this->cols() != x.cols())
+			return;
+		T* p = this->_a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			p[i] -= x[i];
 	}
 
 	/**
@@ -286,18 +577,15 @@ public:
 	 */
 	void operator*=(T s)
 	{
-		Matrix_& a = *this;
-		for (int i = 0; i < a.rows(); i++)
-			for (int j = 0; j < a.cols(); j++)
-				a(i, j) *= s;
+		T* p = this->_a.ptr();
+		ops::scale(p, s, p, length());
 	}
 
 	void negate()
 	{
-		Matrix_& a = *this;
-		for (int i = 0; i < a.rows(); i++)
-			for (int j = 0; j < a.cols(); j++)
-				a(i, j) = -a(i, j);
+		T* p = this->_a.ptr();
+		for (int i = 0, n = length(); i < n; i++)
+			p[i] = -p[i];
 	}
 
 	/**
@@ -307,9 +595,10 @@ public:
 	{
 		const Matrix_& a = *this;
 		Matrix_ c(a.rows(), a.cols());
-		for (int i = 0; i < c.rows(); i++)
-			for (int j = 0; j < c.cols(); j++)
-				c(i, j) = -a(i, j);
+		const T* p = a._a.ptr();
+		T* r = c._a.ptr();
+		for (int i = 0, n = c.length(); i < n; i++)
+			r[i] = -p[i];
 		return c;
 	}
 
@@ -318,12 +607,8 @@ public:
 	*/
 	T normSq() const
 	{
-		T s = 0;
-		const Matrix_& a = *this;
-		for (int i = 0; i < a.rows(); i++)
-			for (int j = 0; j < a.cols(); j++)
-				s += sqr(a(i, j));
-		return s;
+		const T* p = this->_a.ptr();
+		return ops::dot(p, p, length());
 	}
 
 	/**
@@ -338,80 +623,546 @@ public:
 typedef Matrix_<double> Matrixd;
 typedef Matrix_<float> Matrix;
 
+/**
+ * LU decomposition with partial pivoting of a square matrix (P A = L U). The matrix is factored once, in O(n^3),
+ * and then systems can be solved for any number of right-hand sides in O(n^2) each, and the determinant is
+ * obtained without further work.
+ *
+ * ~~~
+ * LU<double> lu(A);
+ * Matrixd x1 = lu.solve(b1);
+ * Matrixd x2 = lu.solve(b2);
+ * double d = lu.det();
+ * ~~~
+ * \ingroup Math3D
+ */
+template<class T>
+class LU
+{
+public:
+	LU() : _sign(1), _singular(true) {}
+	/**
+	 * Computes the decomposition of matrix A
+	 */
+	ASL_EXPLICIT LU(const Matrix_<T>& A) { compute(A); }
+	/**
+	 * Computes the decomposition of matrix A, which must be square
+	 */
+	LU& compute(const Matrix_<T>& A);
+	/**
+	 * Returns true if the matrix is singular (or not square)
+	 */
+	bool singular() const { return _singular; }
+	/**
+	 * Solves A * x = b and returns x; if b has several columns each one is solved as a separate system
+	 */
+	Matrix_<T> solve(const Matrix_<T>& b) const;
+	/**
+	 * Returns the determinant of the matrix
+	 */
+	T det() const;
+	/**
+	 * Returns the inverse of the matrix
+	 */
+	Matrix_<T> inverse() const { return solve(Matrix_<T>::identity(_lu.rows())); }
+	/**
+	 * Returns the L and U factors packed in one matrix: U in the upper triangle and L below the diagonal
+	 * (its diagonal elements are all 1)
+	 */
+	const Matrix_<T>& factors() const { return _lu; }
+	/**
+	 * Returns the row permutation: row i of L * U corresponds to row `permutation()[i]` of A
+	 */
+	const Array<int>& permutation() const { return _perm; }
+private:
+	Matrix_<T> _lu;
+	Array<int> _perm;
+	int _sign;
+	bool _singular;
+};
+
+/**
+ * Cholesky decomposition of a symmetric positive definite matrix (A = L L<sup>T</sup>). It is about twice as fast as
+ * the LU decomposition and it is the method of choice for normal equations and covariance matrices.
+ * \ingroup Math3D
+ */
 template<class T>
-Matrix_<T> solve_(Matrix_<T>& A, Matrix_<T>& b);
+class Cholesky
+{
+public:
+	Cholesky() : _ok(false) {}
+	/**
+	 * Computes the decomposition of matrix A
+	 */
+	ASL_EXPLICIT Cholesky(const Matrix_<T>& A) { compute(A); }
+	/**
+	 * Computes the decomposition of matrix A, which must be symmetric (only its lower triangle is used)
+	 */
+	Cholesky& compute(const Matrix_<T>& A);
+	/**
+	 * Returns true if the decomposition succeeded (the matrix is positive definite)
+	 */
+	bool ok() const { return _ok; }
+	/**
+	 * Solves A * x = b and returns x; if b has several columns each one is solved as a separate system
+	 */
+	Matrix_<T> solve(const Matrix_<T>& b) const;
+	/**
+	 * Returns the determinant of the matrix
+	 */
+	T det() const;
+	/**
+	 * Returns the inverse of the matrix
+	 */
+	Matrix_<T> inverse() const { return solve(Matrix_<T>::identity(_l.rows())); }
+	/**
+	 * Returns the lower triangular factor L
+	 */
+	const Matrix_<T>& L() const { return _l; }
+private:
+	Matrix_<T> _l;
+	bool _ok;
+};
 
 /**
- * Solves the matrix equation A*x=b and returns x; if b is a matrix (not a column) then the equation is solved
- * for each of b's columns and solutions returned as the columns of the returned matrix.
+ * QR decomposition (A = Q R) of an m x n matrix with m >= n, computed with Householder reflections. It
+ * solves least-squares problems without forming A<sup>T</sup>A, so it keeps accuracy for ill-conditioned
+ * matrices, and gives the numerical rank of A.
+ *
+ * ~~~
+ * QR<double> qr(A);   // A has more rows than columns
+ * Matrixd x = qr.solve(b); // minimizes |A * x - b|
+ * ~~~
  * \ingroup Math3D
  */
 template<class T>
-Matrix_<T> solve(const Matrix_<T>& A, const Matrix_<T>& b)
+class QR
 {
-	Matrix_<T> A2 = A.clone();
-	Matrix_<T> b2 = b.clone();
-	return solve_(A2, b2);
-}
+public:
+	QR() {}
+	/**
+	 * Computes the decomposition of matrix A
+	 */
+	ASL_EXPLICIT QR(const Matrix_<T>& A) { compute(A); }
+	/**
+	 * Computes the decomposition of matrix A, which must not have more columns than rows
+	 */
+	QR& compute(const Matrix_<T>& A);
+	/**
+	 * Returns the numerical rank of A: the number of diagonal elements of R larger than `tol` relative to the
+	 * largest (by default a tolerance based on the type's precision is used)
+	 */
+	int rank(T tol = 0) const;
+	/**
+	 * Returns true if A has full column rank
+	 */
+	bool fullRank() const { return _qr.cols() > 0 && rank() == _qr.cols(); }
+	/**
+	 * Returns the least-squares solution of A * x = b (the exact solution if A is square); if b has several
+	 * columns each one is solved as a separate problem
+	 */
+	Matrix_<T> solve(const Matrix_<T>& b) const;
+	/**
+	 * Returns the upper triangular n x n factor R
+	 */
+	Matrix_<T> R() const;
+private:
+	Matrix_<T> _qr;
+	Array<T> _rdiag;
+};
 
 template<class T>
-Matrix_<T> Matrix_<T>::inverse() const
+LU<T>& LU<T>::compute(const Matrix_<T>& A)
 {
-	return solve(*this, Matrix_<T>::identity(this->rows()));
+	int n = A.rows();
+	_lu = A.clone();
+	_perm.resize(n);
+	_sign = 1;
+	_singular = A.rows() != A.cols();
+	if (_singular)
+		return *this;
+	for (int i = 0; i < n; i++)
+		_perm[i] = i;
+	T* a = _lu.data().ptr();
+	// factor panels of nb columns, then update the trailing submatrix with a matrix product
+	const int nb = n > 128 ? 32 : n;
+	Array<T> tmp;
+	for (int k0 = 0; k0 < n; k0 += nb)
+	{
+		int k1 = min(k0 + nb, n);
+		for (int k = k0; k < k1; k++)
+		{
+			int p = k;
+			T maxv = fabs(a[k * n + k]);
+			for (int i = k + 1; i < n; i++)
+			{
+				if (fabs(a[i * n + k]) > maxv) {
+					maxv = fabs(a[i * n + k]);
+					p = i;
+				}
+			}
+			if (maxv == T(0)) {
+				_singular = true;
+				continue;
+			}
+			if (p != k)
+			{
+				for (int j = 0; j < n; j++)
+					swap(a[p * n + j], a[k * n + j]);
+				swap(_perm[p], _perm[k]);
+				_sign = -_sign;
+			}
+			const T* ak = a + k * n;
+			for (int i = k + 1; i < n; i++)
+			{
+				T* ai = a + i * n;
+				T f = ai[k] /= ak[k];
+				if (f != T(0))
+					for (int j = k + 1; j < k1; j++)
+						ai[j] -= f * ak[j];
+			}
+		}
+		if (k1 == n)
+			break;
+		for (int k = k0; k < k1; k++)
+		{
+			const T* ak = a + k * n;
+			for (int i = k + 1; i < k1; i++)
+			{
+				T* ai = a + i * n;
+				T f = ai[k];
+				for (int j = k1; j < n; j++)
+					ai[j] -= f * ak[j];
+			}
+		}
+		int m = n - k1;
+		tmp.resize(m * m);
+		matmul(m, m, k1 - k0, a + k1 * n + k0, n, a + k0 * n + k1, n, tmp.ptr(), m);
+		for (int i = 0; i < m; i++)
+		{
+			T* ai = a + (k1 + i) * n + k1;
+			const T* ti = tmp.ptr() + i * m;
+			for (int j = 0; j < m; j++)
+				ai[j] -= ti[j];
+		}
+	}
+	return *this;
 }
 
+template<class T>
+Matrix_<T> LU<T>::solve(const Matrix_<T>& b) const
+{
+	int n = _lu.rows(), r = b.cols();
+	Matrix_<T> x(n, r);
+	if (b.rows() != n || _lu.rows() != _lu.cols())
+		return x.clear();
+	const T* a = _lu.data().ptr();
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < r; j++)
+			x(i, j) = b(_perm[i], j);
+	T* X = x.data().ptr();
+	for (int i = 1; i < n; i++)
+	{
+		T* xi = X + i * r;
+		for (int k = 0; k < i; k++)
+		{
+			T f = a[i * n + k];
+			const T* xk = X + k * r;
+			if (f != T(0))
+				for (int j = 0; j < r; j++)
+					xi[j] -= f * xk[j];
+		}
+	}
+	for (int i = n - 1; i >= 0; i--)
+	{
+		T* xi = X + i * r;
+		for (int k = i + 1; k < n; k++)
+		{
+			T f = a[i * n + k];
+			const T* xk = X + k * r;
+			if (f != T(0))
+				for (int j = 0; j < r; j++)
+					xi[j] -= f * xk[j];
+		}
+		T d = a[i * n + i];
+		for (int j = 0; j < r; j++)
+			xi[j] /= d;
+	}
+	return x;
+}
 
 template<class T>
-Matrix_<T> solve_(Matrix_<T>& A_, Matrix_<T>& b_)
+T LU<T>::det() const
 {
-	Matrix_<T> x(b_.rows(), b_.cols());
-	int n = A_.rows();
-	Array<int> _(n);
-	Matrix_<T> A = b_.cols() == 1 ? A_ : A_.clone();
-	Matrix_<T> b = b_;
+	if (_lu.rows() != _lu.cols())
+		return T(0);
+	T d = T(_sign);
+	for (int i = 0; i < _lu.rows(); i++)
+		d *= _lu(i, i);
+	return d;
+}
 
-	for (int j = 0; j < b_.cols(); j++)
+template<class T>
+Cholesky<T>& Cholesky<T>::compute(const Matrix_<T>& A)
+{
+	int n = A.rows();
+	_l = Matrix_<T>(n, n, T(0));
+	_ok = A.rows() == A.cols() && n > 0;
+	if (!_ok)
+		return *this;
+	T* l = _l.data().ptr();
+	for (int i = 0; i < n; i++)
 	{
-		if (j > 0)
-			A.copy(A_);
-		for (int i = 0; i < n; i++)
-			_[i] = i;
-		for (int k = 0; k < n - 1; k++)
+		T* li = l + i * n;
+		for (int j = 0; j <= i; j++)
 		{
-			T max = 0;
-			int ipivot = 0;
-			for (int i = k; i < n; i++)
+			const T* lj = l + j * n;
+			T s = A(i, j);
+			for (int k = 0; k < j; k++)
+				s -= li[k] * lj[k];
+			if (i != j)
+				li[j] = s / lj[j];
+			else if (s > T(0))
+				li[i] = sqrt(s);
+			else
 			{
-				if (max < fabs(A(_[i], k))) {
-					max = fabs(A(_[i], k));
-					ipivot = i;
-				}
+				_ok = false;
+				return *this;
 			}
+		}
+	}
+	return *this;
+}
 
-			swap(_[k], _[ipivot]);
+template<class T>
+Matrix_<T> Cholesky<T>::solve(const Matrix_<T>& b) const
+{
+	int n = _l.rows(), r = b.cols();
+	if (!_ok || b.rows() != n)
+		return Matrix_<T>();
+	Matrix_<T> x = b.clone();
+	const T* l = _l.data().ptr();
+	T* X = x.data().ptr();
+	for (int i = 0; i < n; i++)
+	{
+		T* xi = X + i * r;
+		for (int k = 0; k < i; k++)
+		{
+			T f = l[i * n + k];
+			const T* xk = X + k * r;
+			for (int j = 0; j < r; j++)
+				xi[j] -= f * xk[j];
+		}
+		T d = l[i * n + i];
+		for (int j = 0; j < r; j++)
+			xi[j] /= d;
+	}
+	for (int i = n - 1; i >= 0; i--)
+	{
+		T* xi = X + i * r;
+		T d = l[i * n + i];
+		for (int j = 0; j < r; j++)
+			xi[j] /= d;
+		for (int k = 0; k < i; k++)
+		{
+			T f = l[i * n + k];
+			T* xk = X + k * r;
+			for (int j = 0; j < r; j++)
+				xk[j] -= f * xi[j];
+		}
+	}
+	return x;
+}
 
-			for (int i = k + 1; i < n; i++)
+template<class T>
+T Cholesky<T>::det() const
+{
+	if (!_ok)
+		return T(0);
+	T d = T(1);
+	for (int i = 0; i < _l.rows(); i++)
+		d *= sqr(_l(i, i));
+	return d;
+}
+
+template<class T>
+QR<T>& QR<T>::compute(const Matrix_<T>& A)
+{
+	int m = A.rows(), n = A.cols();
+	_qr = A.clone();
+	_rdiag.resize(n);
+	if (m < n)
+	{
+		_qr.clear();
+		_rdiag.clear();
+		return *this;
+	}
+	T* a = _qr.data().ptr();
+	Array<T> w(n);
+	for (int k = 0; k < n; k++)
+	{
+		T nrm = 0;
+		for (int i = k; i < m; i++)
+			nrm += sqr(a[i * n + k]);
+		nrm = sqrt(nrm);
+		if (nrm != T(0))
+		{
+			if (a[k * n + k] < T(0))
+				nrm = -nrm;
+			for (int i = k; i < m; i++)
+				a[i * n + k] /= nrm;
+			a[k * n + k] += T(1);
+			// apply the reflection I - v v^T / v_k to the remaining columns, traversing them by rows
+			for (int j = k + 1; j < n; j++)
+				w[j] = 0;
+			for (int i = k; i < m; i++)
+			{
+				const T* ai = a + i * n;
+				T v = ai[k];
+				for (int j = k + 1; j < n; j++)
+					w[j] += v * ai[j];
+			}
+			T vk = a[k * n + k];
+			for (int j = k + 1; j < n; j++)
+				w[j] = -w[j] / vk;
+			for (int i = k; i < m; i++)
 			{
-				int ii = _[i], kk =_[k];
-				T f = -A(ii, k) / A(kk, k);
-				for (int jj = k; jj < n; jj++)
-					A(ii, jj) += A(kk, jj) * f;
-				b(ii, j) += b(kk, j) * f;
+				T* ai = a + i * n;
+				T v = ai[k];
+				for (int j = k + 1; j < n; j++)
+					ai[j] += w[j] * v;
 			}
 		}
+		_rdiag[k] = -nrm;
+	}
+	return *this;
+}
 
-		for (int k = n - 1; k >= 0; k--)
+template<class T>
+int QR<T>::rank(T tol) const
+{
+	int n = _rdiag.length();
+	T maxd = 0;
+	for (int i = 0; i < n; i++)
+		maxd = max(maxd, (T)fabs(_rdiag[i]));
+	if (tol == T(0))
+		tol = T(max(_qr.rows(), n)) * (sizeof(T) == sizeof(float) ? T(1.2e-7) : T(2.3e-16));
+	int r = 0;
+	for (int i = 0; i < n; i++)
+		if (fabs(_rdiag[i]) > tol * maxd)
+			r++;
+	return r;
+}
+
+template<class T>
+Matrix_<T> QR<T>::solve(const Matrix_<T>& b) const
+{
+	int m = _qr.rows(), n = _qr.cols(), r = b.cols();
+	if (b.rows() != m || n == 0)
+		return Matrix_<T>();
+	Matrix_<T> y = b.clone();
+	const T* a = _qr.data().ptr();
+	T* Y = y.data().ptr();
+	Array<T> s(r);
+	// y = Q^T b
+	for (int k = 0; k < n; k++)
+	{
+		T vk = a[k * n + k];
+		if (vk == T(0))
+			continue;
+		for (int j = 0; j < r; j++)
+			s[j] = 0;
+		for (int i = k; i < m; i++)
 		{
-			T sum = 0;
-			int kk = _[k];
-			for (int i = k + 1; i < n; i++)
-				sum += A(kk, i) * x(i, j);
-			x(k, j) = (b(kk, j) - sum) / A(kk, k);
+			T v = a[i * n + k];
+			const T* yi = Y + i * r;
+			for (int j = 0; j < r; j++)
+				s[j] += v * yi[j];
+		}
+		for (int j = 0; j < r; j++)
+			s[j] = -s[j] / vk;
+		for (int i = k; i < m; i++)
+		{
+			T v = a[i * n + k];
+			T* yi = Y + i * r;
+			for (int j = 0; j < r; j++)
+				yi[j] += s[j] * v;
+		}
+	}
+	// solve R x = y
+	Matrix_<T> x(n, r);
+	T* X = x.data().ptr();
+	for (int k = n - 1; k >= 0; k--)
+	{
+		T* xk = X + k * r;
+		const T* yk = Y + k * r;
+		for (int j = 0; j < r; j++)
+			xk[j] = yk[j] / _rdiag[k];
+		for (int i = 0; i < k; i++)
+		{
+			T f = a[i * n + k];
+			T* yi = Y + i * r;
+			for (int j = 0; j < r; j++)
+				yi[j] -= f * xk[j];
 		}
 	}
 	return x;
 }
 
+template<class T>
+Matrix_<T> QR<T>::R() const
+{
+	int n = _qr.cols();
+	Matrix_<T> r(n, n, T(0));
+	for (int i = 0; i < n; i++)
+	{
+		r(i, i) = _rdiag[i];
+		for (int j = i + 1; j < n; j++)
+			r(i, j) = _qr(i, j);
+	}
+	return r;
+}
+
+/**
+ * Solves the matrix equation A*x=b and returns x; if b is a matrix (not a column) then the equation is solved
+ * for each of b's columns and solutions returned as the columns of the returned matrix. If A has more rows than
+ * columns the least-squares solution is returned.
+ * \ingroup Math3D
+ */
+template<class T>
+Matrix_<T> solve(const Matrix_<T>& A, const Matrix_<T>& b)
+{
+	if (A.rows() == A.cols())
+		return LU<T>(A).solve(b);
+	return QR<T>(A).solve(b);
+}
+
+template<class T>
+Matrix_<T> solve_(Matrix_<T>& A, Matrix_<T>& b)
+{
+	return solve(A, b);
+}
+
+template<class T>
+Matrix_<T> Matrix_<T>::inverse() const
+{
+	return LU<T>(*this).inverse();
+}
+
+template<class T>
+Matrix_<T> Matrix_<T>::pseudoinverse() const
+{
+	if (this->rows() >= this->cols())
+		return QR<T>(*this).solve(Matrix_<T>::identity(this->rows()));
+	return QR<T>(transposed()).solve(Matrix_<T>::identity(this->cols())).transposed();
+}
+
+template<class T>
+T Matrix_<T>::det() const
+{
+	return LU<T>(*this).det();
+}
+
 /**
 * Solves a system of equations F(x)=[0], given by functor f, which returns a vector of function values for an input vector x;
 * and using x0 as initial guess. If there are more equations than unknowns (f larger than x0) then a least-squares solution is
@@ -431,6 +1182,8 @@ Matrix_<T> solve_(Matrix_<T>& A_, Matrix_<T>& b_)
 * 	};
 * }, { 0.0, 0.0 });  // initial estimation
 * ~~~
+* 
+* For larger or badly conditioned problems see the LevenbergMarquardt solver.
 * \ingroup Math3D
 */
 template <class T, class F>
@@ -457,7 +1210,7 @@ Matrix_<T> solveZero(F f, const Matrix_<T>& x0)
 				J(i, j) = (f2[i] - f1[i]) / dx;
 		}
 		f1.negate();
-		Matrix_<T> h = ls ? J.pseudoinverse() * f1 : solve_(J, f1);
+		Matrix_<T> h = ls ? QR<T>(J).solve(f1) : LU<T>(J).solve(f1);
 		if (h.norm() < 0.0001f)
 			break;
 
@@ -13,6 +13,20 @@ template<class T> class Matrix4_;
 template<class T> class Quaternion_;
 class String;
 
+/**
+Transforms n points stored as consecutive xyz triplets by the row-major 4x4 matrix m (low-level function used by
+Matrix4_::transform() and PointCloud_). `out` can be the same as `in`.
+*/
+ASL_API void transformPoints(const float* m, const float* in, float* out, int n, int nthreads = 1);
+ASL_API void transformPoints(const double* m, const double* in, double* out, int n, int nthreads = 1);
+
+/**
+Transforms n points stored as separate x, y, z arrays by the row-major 4x4 matrix m (low-level function used by
+PointCloud_). The output arrays can be the same as the input arrays.
+*/
+ASL_API void transformPoints(const float* m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, int n, int nthreads = 1);
+ASL_API void transformPoints(const double* m, const double* x, const double* y, const double* z, double* ox, double* oy, double* oz, int n, int nthreads = 1);
+
 /**
 A Matrix4 is a 4x4 matrix useful for representing affine transformations in 3D space.
 
@@ -191,6 +205,27 @@ public:
 	*/
 	Vec3_<T> operator%(const Vec3_<T>& p) const;
 	/**
+	Transforms the n points `in` by this matrix, storing them in `out` (which can be the same as `in`), with
+	SIMD instructions and optionally using several threads. For affine matrices the result is the same as
+	with `operator*`; otherwise the results are divided by the homogeneous coordinate (a projection).
+	*/
+	void transform(const Vec3_<T>* in, Vec3_<T>* out, int n, int nthreads = 1) const
+	{
+		transformPoints(&a[0][0], (const T*)in, (T*)out, n, nthreads);
+	}
+	/**
+	Transforms n points given as separate coordinate arrays x, y, z, storing them in ox, oy, oz (which can be the
+	same as the input arrays), like the above function
+	*/
+	void transform(const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, int n, int nthreads = 1) const
+	{
+		transformPoints(&a[0][0], x, y, z, ox, oy, oz, n, nthreads);
+	}
+	/**
+	Returns true if this matrix is an affine transform (its last row is [0 0 0 1])
+	*/
+	bool isAffine() const { return a[3][0] == 0 && a[3][1] == 0 && a[3][2] == 0 && a[3][3] == 1; }
+	/**
 	Returns a translation matrix for the given vector.
 	*/
 	static Matrix4_ translate(const Vec3_<T>&);
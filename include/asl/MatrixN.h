@@ -0,0 +1,410 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_MATRIXN_H
+#define ASL_MATRIXN_H
+
+#include <asl/Matrix.h>
+
+namespace asl {
+
+/**
+A matrix of R rows and C columns whose size is known at compile time. Elements are stored inline (row-major), so
+creating, copying and returning these matrices does not allocate memory, and all loops have constant bounds that
+the compiler can unroll. It is meant for small matrices (up to about 8x8) used in many operations, such as
+Kalman filter states and covariances or Jacobian blocks, where a `Matrix_` would spend most of its time in the heap.
+
+Sizes are checked by the type system: multiplying a 3x6 by a 6x6 matrix gives a 3x6 matrix, and mismatched
+operands do not compile.
+
+~~~
+MatrixN_<double, 6> P = MatrixN_<double, 6>::identity();
+MatrixN_<double, 3, 6> H;
+MatrixN_<double, 6, 3> K = P * H.transposed() * (H * P * H.transposed() + R).inverse();
+MatrixN_<double, 3, 1> y = solve(S, z);
+Matrixd m = P.matrix();         // to a dynamic matrix
+MatrixN_<double, 6> Q(m);       // and back
+~~~
+\ingroup Math3D
+*/
+template<class T, int R, int C = R>
+class MatrixN_
+{
+public:
+	enum { ROWS = R, COLS = C };
+
+	/**
+	Creates a matrix with uninitialized elements
+	*/
+	MatrixN_() {}
+
+	/**
+	Creates a matrix with all elements equal to value
+	*/
+	ASL_EXPLICIT MatrixN_(const T& value)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] = value;
+	}
+
+	/**
+	Creates a matrix with the R x C elements pointed by p (row-wise)
+	*/
+	ASL_EXPLICIT MatrixN_(const T* p)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] = p[i];
+	}
+
+	/**
+	Creates a matrix from a dynamic matrix, which should have R rows and C columns (otherwise the result is all zeros)
+	*/
+	ASL_EXPLICIT MatrixN_(const Matrix_<T>& m)
+	{
+		bool same = m.rows() == R && m.cols() == C;
+		for (int i = 0; i < R * C; i++)
+			_a[i] = same ? m[i] : T(0);
+	}
+
+	template<class K>
+	MatrixN_(const MatrixN_<K, R, C>& b)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] = (T)b[i];
+	}
+
+#ifdef ASL_HAVE_INITLIST
+	/**
+	Creates a matrix with the given elements (row-wise)
+	*/
+	MatrixN_(std::initializer_list<T> a)
+	{
+		const T* p = a.begin();
+		int n = min((int)a.size(), R * C);
+		for (int i = 0; i < n; i++)
+			_a[i] = p[i];
+		for (int i = n; i < R * C; i++)
+			_a[i] = T(0);
+	}
+#endif
+
+	/**
+	Returns a dynamic matrix with the same elements
+	*/
+	Matrix_<T> matrix() const { return Matrix_<T>(R, C, _a); }
+
+	operator Matrix_<T>() const { return matrix(); }
+
+	/**
+	Returns the number of rows (R)
+	*/
+	int rows() const { return R; }
+	/**
+	Returns the number of columns (C)
+	*/
+	int cols() const { return C; }
+	/**
+	Returns the number of elements (R * C)
+	*/
+	int length() const { return R * C; }
+
+	T& operator()(int i, int j) { return _a[i * C + j]; }
+	const T& operator()(int i, int j) const { return _a[i * C + j]; }
+
+	T& operator[](int i) { return _a[i]; }
+	const T& operator[](int i) const { return _a[i]; }
+
+	/**
+	Returns a pointer to the elements (row-major)
+	*/
+	T* data() { return _a; }
+	const T* data() const { return _a; }
+
+	/**
+	Returns a matrix with all elements zero
+	*/
+	static MatrixN_ zeros() { return MatrixN_(T(0)); }
+
+	/**
+	Returns an identity matrix (ones in the diagonal, zeros elsewhere)
+	*/
+	static MatrixN_ identity()
+	{
+		MatrixN_ I(T(0));
+		for (int i = 0; i < min(R, C); i++)
+			I(i, i) = T(1);
+		return I;
+	}
+
+	/**
+	Returns a copy of this matrix with elements converted to type K
+	*/
+	template<class K>
+	MatrixN_<K, R, C> with() const { return MatrixN_<K, R, C>(*this); }
+
+	/**
+	Returns the trace of this matrix
+	*/
+	T trace() const
+	{
+		T t = 0;
+		for (int i = 0; i < min(R, C); i++)
+			t += (*this)(i, i);
+		return t;
+	}
+
+	/**
+	Returns the sub-matrix of size R2 x C2 whose top-left element is at (i, j)
+	*/
+	template<int R2, int C2>
+	MatrixN_<T, R2, C2> slice(int i, int j) const
+	{
+		MatrixN_<T, R2, C2> b;
+		for (int k = 0; k < R2; k++)
+			for (int l = 0; l < C2; l++)
+				b(k, l) = (*this)(i + k, j + l);
+		return b;
+	}
+
+	/**
+	Returns the i-th row
+	*/
+	MatrixN_<T, 1, C> row(int i) const { return slice<1, C>(i, 0); }
+
+	/**
+	Returns the j-th column
+	*/
+	MatrixN_<T, R, 1> col(int j) const { return slice<R, 1>(0, j); }
+
+	/**
+	Returns this matrix transposed
+	*/
+	MatrixN_<T, C, R> transposed() const
+	{
+		MatrixN_<T, C, R> b;
+		for (int i = 0; i < C; i++)
+			for (int j = 0; j < R; j++)
+				b(i, j) = (*this)(j, i);
+		return b;
+	}
+
+	/**
+	Computes the product of this matrix and b
+	*/
+	template<int K>
+	MatrixN_<T, R, K> operator*(const MatrixN_<T, C, K>& b) const
+	{
+		MatrixN_<T, R, K> c(T(0));
+		for (int i = 0; i < R; i++)
+			for (int k = 0; k < C; k++)
+			{
+				T aik = (*this)(i, k);
+				for (int j = 0; j < K; j++)
+					c(i, j) += aik * b(k, j);
+			}
+		return c;
+	}
+
+	MatrixN_ operator+(const MatrixN_& b) const
+	{
+		MatrixN_ c;
+		for (int i = 0; i < R * C; i++)
+			c._a[i] = _a[i] + b._a[i];
+		return c;
+	}
+
+	MatrixN_ operator-(const MatrixN_& b) const
+	{
+		MatrixN_ c;
+		for (int i = 0; i < R * C; i++)
+			c._a[i] = _a[i] - b._a[i];
+		return c;
+	}
+
+	MatrixN_ operator*(T s) const
+	{
+		MatrixN_ c;
+		for (int i = 0; i < R * C; i++)
+			c._a[i] = _a[i] * s;
+		return c;
+	}
+
+	MatrixN_ operator-() const
+	{
+		MatrixN_ c;
+		for (int i = 0; i < R * C; i++)
+			c._a[i] = -_a[i];
+		return c;
+	}
+
+	MatrixN_& operator+=(const MatrixN_& b)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] += b._a[i];
+		return *this;
+	}
+
+	MatrixN_& operator-=(const MatrixN_& b)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] -= b._a[i];
+		return *this;
+	}
+
+	MatrixN_& operator*=(T s)
+	{
+		for (int i = 0; i < R * C; i++)
+			_a[i] *= s;
+		return *this;
+	}
+
+	bool operator==(const MatrixN_& b) const
+	{
+		for (int i = 0; i < R * C; i++)
+			if (_a[i] != b._a[i])
+				return false;
+		return true;
+	}
+
+	bool operator!=(const MatrixN_& b) const { return !(*this == b); }
+
+	/**
+	Returns the Frobenius norm squared
+	*/
+	T normSq() const
+	{
+		T s = 0;
+		for (int i = 0; i < R * C; i++)
+			s += sqr(_a[i]);
+		return s;
+	}
+
+	/**
+	Returns the Frobenius norm
+	*/
+	T norm() const { return sqrt(normSq()); }
+
+	/**
+	Returns the determinant of this matrix, which must be square
+	*/
+	T det() const;
+
+	/**
+	Computes the inverse of this matrix, which must be square
+	*/
+	MatrixN_ inverse() const;
+
+	friend MatrixN_ operator*(T s, const MatrixN_& b) { return b * s; }
+
+protected:
+	T _a[R * C];
+};
+
+/**
+LU decomposition with partial pivoting of a fixed-size square matrix, done in place on the stack.
+Returns the sign of the row permutation, or 0 if the matrix is singular.
+*/
+template<class T, int N>
+int luFactor(MatrixN_<T, N, N>& a, int* perm)
+{
+	int sign = 1;
+	for (int i = 0; i < N; i++)
+		perm[i] = i;
+	for (int k = 0; k < N; k++)
+	{
+		int p = k;
+		T maxv = fabs(a(k, k));
+		for (int i = k + 1; i < N; i++)
+		{
+			if (fabs(a(i, k)) > maxv) {
+				maxv = fabs(a(i, k));
+				p = i;
+			}
+		}
+		if (maxv == T(0))
+			return 0;
+		if (p != k)
+		{
+			for (int j = 0; j < N; j++)
+				swap(a(p, j), a(k, j));
+			swap(perm[p], perm[k]);
+			sign = -sign;
+		}
+		for (int i = k + 1; i < N; i++)
+		{
+			T f = a(i, k) /= a(k, k);
+			for (int j = k + 1; j < N; j++)
+				a(i, j) -= f * a(k, j);
+		}
+	}
+	return sign;
+}
+
+template<class T, int N, int M>
+MatrixN_<T, N, M> luSolve(const MatrixN_<T, N, N>& a, const int* perm, const MatrixN_<T, N, M>& b)
+{
+	MatrixN_<T, N, M> x;
+	for (int i = 0; i < N; i++)
+		for (int j = 0; j < M; j++)
+			x(i, j) = b(perm[i], j);
+	for (int i = 1; i < N; i++)
+		for (int k = 0; k < i; k++)
+		{
+			T f = a(i, k);
+			for (int j = 0; j < M; j++)
+				x(i, j) -= f * x(k, j);
+		}
+	for (int i = N - 1; i >= 0; i--)
+	{
+		for (int k = i + 1; k < N; k++)
+		{
+			T f = a(i, k);
+			for (int j = 0; j < M; j++)
+				x(i, j) -= f * x(k, j);
+		}
+		T d = T(1) / a(i, i);
+		for (int j = 0; j < M; j++)
+			x(i, j) *= d;
+	}
+	return x;
+}
+
+/**
+Solves the linear system A * x = b for fixed-size matrices (A must be square; b can have several columns)
+\ingroup Math3D
+*/
+template<class T, int N, int M>
+MatrixN_<T, N, M> solve(const MatrixN_<T, N, N>& A, const MatrixN_<T, N, M>& b)
+{
+	MatrixN_<T, N, N> lu = A;
+	int perm[N];
+	luFactor(lu, perm);
+	return luSolve(lu, perm, b);
+}
+
+template<class T, int R, int C>
+T MatrixN_<T, R, C>::det() const
+{
+	if (R != C)
+		return T(0);
+	MatrixN_<T, R, R> lu(_a);
+	int perm[R];
+	T d = T(luFactor(lu, perm));
+	for (int i = 0; i < R; i++)
+		d *= lu(i, i);
+	return d;
+}
+
+template<class T, int R, int C>
+MatrixN_<T, R, C> MatrixN_<T, R, C>::inverse() const
+{
+	if (R != C)
+		return MatrixN_(T(0));
+	MatrixN_<T, R, R> lu(_a);
+	int perm[R];
+	luFactor(lu, perm);
+	return MatrixN_(luSolve(lu, perm, MatrixN_<T, R, R>::identity()).data());
+}
+
+}
+#endif
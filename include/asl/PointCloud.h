@@ -0,0 +1,148 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_POINTCLOUD_H
+#define ASL_POINTCLOUD_H
+
+#include <asl/Pose.h>
+#include <asl/Array.h>
+
+namespace asl {
+
+/**
+A set of 3D points stored as a *structure of arrays* (separate arrays of x, y and z coordinates), which lets
+transformations process several points per instruction. Use it instead of an `Array<Vec3>` for large point sets
+that are transformed often.
+
+~~~
+PointCloud cloud(points);            // from an Array<Vec3>
+cloud.transform(cameraPose.matrix()); // in place, with SIMD
+Vec3 p = cloud[10];
+~~~
+\ingroup Math3D
+*/
+template<class T>
+class PointCloud_
+{
+public:
+	/**
+	Creates an empty point cloud
+	*/
+	PointCloud_() {}
+	/**
+	Creates a point cloud of n (uninitialized) points
+	*/
+	ASL_EXPLICIT PointCloud_(int n) : _x(n), _y(n), _z(n) {}
+	/**
+	Creates a point cloud with the given points
+	*/
+	PointCloud_(const Array<Vec3_<T> >& points) : _x(points.length()), _y(points.length()), _z(points.length())
+	{
+		for (int i = 0; i < points.length(); i++)
+			set(i, points[i]);
+	}
+	/**
+	Returns the number of points
+	*/
+	int length() const { return _x.length(); }
+	/**
+	Resizes the cloud to n points
+	*/
+	PointCloud_& resize(int n)
+	{
+		_x.resize(n);
+		_y.resize(n);
+		_z.resize(n);
+		return *this;
+	}
+	/**
+	Adds a point at the end
+	*/
+	PointCloud_& operator<<(const Vec3_<T>& p)
+	{
+		_x << p.x;
+		_y << p.y;
+		_z << p.z;
+		return *this;
+	}
+	/**
+	Returns the i-th point
+	*/
+	Vec3_<T> operator[](int i) const { return Vec3_<T>(_x[i], _y[i], _z[i]); }
+	/**
+	Sets the i-th point
+	*/
+	void set(int i, const Vec3_<T>& p)
+	{
+		_x[i] = p.x;
+		_y[i] = p.y;
+		_z[i] = p.z;
+	}
+	/**
+	Returns the array of x coordinates
+	*/
+	const Array<T>& x() const { return _x; }
+	/**
+	Returns the array of y coordinates
+	*/
+	const Array<T>& y() const { return _y; }
+	/**
+	Returns the array of z coordinates
+	*/
+	const Array<T>& z() const { return _z; }
+	Array<T>& x() { return _x; }
+	Array<T>& y() { return _y; }
+	Array<T>& z() { return _z; }
+	/**
+	Returns the points as an array of vectors
+	*/
+	Array<Vec3_<T> > points() const
+	{
+		Array<Vec3_<T> > a(length());
+		for (int i = 0; i < a.length(); i++)
+			a[i] = (*this)[i];
+		return a;
+	}
+	/**
+	Returns an independent copy of this point cloud
+	*/
+	PointCloud_ clone() const
+	{
+		PointCloud_ c;
+		c._x = _x.clone();
+		c._y = _y.clone();
+		c._z = _z.clone();
+		return c;
+	}
+	/**
+	Transforms all points by matrix m (in place), optionally using several threads
+	*/
+	PointCloud_& transform(const Matrix4_<T>& m, int nthreads = 1)
+	{
+		if (length() > 0)
+			m.transform(_x.ptr(), _y.ptr(), _z.ptr(), _x.ptr(), _y.ptr(), _z.ptr(), length(), nthreads);
+		return *this;
+	}
+	/**
+	Transforms all points by a pose (in place), optionally using several threads
+	*/
+	PointCloud_& transform(const Pose_<T>& pose, int nthreads = 1) { return transform(pose.matrix(), nthreads); }
+	/**
+	Returns a copy of this point cloud transformed by matrix m
+	*/
+	PointCloud_ transformed(const Matrix4_<T>& m, int nthreads = 1) const
+	{
+		PointCloud_ c(length());
+		if (length() > 0)
+			m.transform(_x.ptr(), _y.ptr(), _z.ptr(), c._x.ptr(), c._y.ptr(), c._z.ptr(), length(), nthreads);
+		return c;
+	}
+private:
+	Array<T> _x, _y, _z;
+};
+
+typedef PointCloud_<float> PointCloud;
+typedef PointCloud_<double> PointCloudd;
+
+}
+#endif
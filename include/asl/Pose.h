@@ -8,6 +8,18 @@
 
 namespace asl {
 
+/**
+Batch operations on n poses stored as 7 consecutive values each: position (x, y, z) and orientation quaternion
+(w, x, y, z), which is the layout of Pose_ (low-level functions used by Pose_::compose(), Pose_::invert() and
+Pose_::interpolate()). Outputs can be the same as inputs.
+*/
+ASL_API void composePoses(const float* a, const float* b, float* out, int n, int nthreads = 1);
+ASL_API void composePoses(const double* a, const double* b, double* out, int n, int nthreads = 1);
+ASL_API void invertPoses(const float* a, float* out, int n, int nthreads = 1);
+ASL_API void invertPoses(const double* a, double* out, int n, int nthreads = 1);
+ASL_API void interpolatePoses(const float* a, const float* b, const float* t, float* out, int n, int nthreads = 1);
+ASL_API void interpolatePoses(const double* a, const double* b, const double* t, double* out, int n, int nthreads = 1);
+
 /**
 A Pose is a combination of a position and an orientation in 3D space.
 */
@@ -46,11 +58,54 @@ public:
 	*/
 	const Quaternion_<T>& orientation() const { return q; }
 	/**
+	Transforms the n points `in` by this pose (rotation followed by translation), storing them in `out` (which can
+	be the same as `in`), optionally using several threads
+	*/
+	void transform(const Vec3_<T>* in, Vec3_<T>* out, int n, int nthreads = 1) const
+	{
+		matrix().transform(in, out, n, nthreads);
+	}
+	/**
+	Returns the composition of this pose and `b` (the transform `b` followed by this one), equivalent to the
+	product of their matrices
+	*/
+	Pose_ operator*(const Pose_& b) const { return Pose_(p + q * b.p, q ^ b.q); }
+	/**
+	Returns the inverse of this pose (its orientation must be a unit quaternion)
+	*/
+	Pose_ inverse() const
+	{
+		Quaternion_<T> qi = q.conj();
+		return Pose_(-(qi * p), qi);
+	}
+	/**
 	Returns the interpolated pose between this and 'pose' with t as interpolation factor [0,1]
 	*/
-	Pose_ interpolate(const Pose_& pose, T t)
+	Pose_ interpolate(const Pose_& pose, T t) const
+	{
+		return Pose_((1 - t)*p + t*pose.p, q.slerp(pose.q, t));
+	}
+	/**
+	Composes n pairs of poses, `out[i] = a[i] * b[i]`, using SIMD and up to `nthreads` threads for large arrays
+	*/
+	static void compose(const Pose_* a, const Pose_* b, Pose_* out, int n, int nthreads = 1)
+	{
+		composePoses(&a->p.x, &b->p.x, &out->p.x, n, nthreads);
+	}
+	/**
+	Inverts n poses, `out[i] = a[i].inverse()`, using SIMD and up to `nthreads` threads for large arrays
+	*/
+	static void invert(const Pose_* a, Pose_* out, int n, int nthreads = 1)
+	{
+		invertPoses(&a->p.x, &out->p.x, n, nthreads);
+	}
+	/**
+	Interpolates n pairs of poses, `out[i] = a[i].interpolate(b[i], t[i])`, using SIMD and polynomial
+	approximations (see Quaternion_::slerp()), and up to `nthreads` threads for large arrays
+	*/
+	static void interpolate(const Pose_* a, const Pose_* b, const T* t, Pose_* out, int n, int nthreads = 1)
 	{
-		return Pose((1 - t)*p + t*pose.p, q.slerp(pose.q, t));
+		interpolatePoses(&a->p.x, &b->p.x, t, &out->p.x, n, nthreads);
 	}
 };
 
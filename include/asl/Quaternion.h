@@ -10,6 +10,13 @@
 
 namespace asl {
 
+/**
+Interpolates n pairs of quaternions stored as consecutive (w, x, y, z) quadruples, writing `slerp(a[i], b[i], t[i])`
+to `out` (low-level function used by Quaternion_::slerp()). `out` can be the same as `a` or `b`.
+*/
+ASL_API void slerpQuaternions(const float* a, const float* b, const float* t, float* out, int n, int nthreads = 1);
+ASL_API void slerpQuaternions(const double* a, const double* b, const double* t, double* out, int n, int nthreads = 1);
+
 /**
 A Quaternion representing an orientation or rotation in 3D space
 \ingroup Math3D
@@ -146,11 +153,20 @@ public:
 		Quaternion_ a = *this;
 		if (a*q < 0.0)
 			a = -a;
-		T theta = (T)acos(a*q);
+		T theta = 2 * (T)atan2((a + -q).length(), (a + q).length()); // more accurate than acos(a*q) for small angles
 		if (theta == 0)
 			return a;
 		return a*(sin(theta - t * theta) / sin(theta)) + q*(sin(t * theta) / sin(theta));
 	}
+	/**
+	Interpolates n pairs of unit quaternions: `out[i] = a[i].slerp(b[i], t[i])`, with `t[i]` in [0..1]. This is
+	much faster than calling slerp() in a loop: it uses SIMD and polynomial approximations accurate to the
+	precision of T, and splits the work among up to `nthreads` threads for large arrays. `out` can be `a` or `b`.
+	*/
+	static void slerp(const Quaternion_* a, const Quaternion_* b, const T* t, Quaternion_* out, int n, int nthreads = 1)
+	{
+		slerpQuaternions(&a->w, &b->w, t, &out->w, n, nthreads);
+	}
 };
 
 typedef Quaternion_<float> Quaternion;
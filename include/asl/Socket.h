@@ -127,6 +127,7 @@ ASL_SMART_CLASS(Socket, SmartObject)
 	virtual int available();
 	virtual int read(void* data, int size);
 	virtual int write(const void* data, int n);
+	virtual Long writeBlocks(const StringView* blocks, int n);
 	Array<byte> read(int n = -1);
 	void skip(int n);
 	virtual bool waitInput(double timeout = 60);
@@ -230,6 +231,11 @@ public:
 	*/
 	int write(const void* data, int n) { return _()->write(data, n); }
 	/**
+	Writes `n` blocks of bytes one after the other with a single gather send where available, returning the total
+	number of bytes written.
+	*/
+	Long writeBlocks(const StringView* blocks, int n) { return _()->writeBlocks(blocks, n); }
+	/**
 	Reads n bytes and returns them as an array of bytes, or reads all available bytes if no argument is given.
 	*/
 	Array<byte> read(int n = -1) { return _()->read(n); }
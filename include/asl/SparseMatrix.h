@@ -0,0 +1,572 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_SPARSEMATRIX_H
+#define ASL_SPARSEMATRIX_H
+
+#include <asl/Matrix.h>
+#include <asl/Thread.h>
+
+namespace asl {
+
+/**
+ * A sparse matrix in compressed sparse row (CSR) format, storing only its non-zero elements. It is meant for large
+ * systems with few non-zeros per row (meshes, graphs, finite differences) that a dense Matrix_ could not hold.
+ *
+ * Sparse matrices are usually constructed with a Builder from (row, column, value) triplets, in any order;
+ * repeated positions are added together:
+ *
+ * ~~~
+ * SparseMatrix<double>::Builder builder(n, n);
+ * for (int i = 0; i < n; i++)
+ * {
+ *     builder.add(i, i, 2);
+ *     if (i > 0)
+ *         builder.add(i, i - 1, -1);
+ *     if (i < n - 1)
+ *         builder.add(i, i + 1, -1);
+ * }
+ * SparseMatrix<double> A = builder.build();
+ * Matrixd y = A * x;  // x is a column Matrixd
+ * ~~~
+ *
+ * Products with column matrices (or matrices of several columns) give dense `Matrix_` results, so existing
+ * code can use them directly. Linear systems are solved with an IterativeSolver.
+ * \ingroup Math3D
+ */
+template<class T>
+class SparseMatrix
+{
+public:
+	/**
+	 * Collects matrix elements as (row, column, value) triplets and builds a SparseMatrix from them
+	 */
+	class Builder
+	{
+	public:
+		/**
+		 * Creates a builder for a matrix of the given size
+		 */
+		Builder(int rows, int cols) : _rows(rows), _cols(cols) {}
+		/**
+		 * Adds value `v` at row i, column j (values added at the same position are summed)
+		 */
+		Builder& add(int i, int j, T v)
+		{
+			_i << i;
+			_j << j;
+			_v << v;
+			return *this;
+		}
+		/**
+		 * Reserves space for n triplets
+		 */
+		void reserve(int n)
+		{
+			_i.reserve(n);
+			_j.reserve(n);
+			_v.reserve(n);
+		}
+		/**
+		 * Returns the number of triplets added
+		 */
+		int length() const { return _v.length(); }
+		/**
+		 * Builds the sparse matrix
+		 */
+		SparseMatrix build() const
+		{
+			return SparseMatrix::compress(_rows, _cols, _v.length(), _i.ptr(), _j.ptr(), _v.ptr());
+		}
+	private:
+		int _rows, _cols;
+		Array<int> _i, _j;
+		Array<T> _v;
+	};
+
+	/**
+	 * Creates an empty matrix
+	 */
+	SparseMatrix() : _rows(0), _cols(0), _starts(1, 0) {}
+	/**
+	 * Creates a matrix of size rows x cols with all elements zero
+	 */
+	SparseMatrix(int rows, int cols) : _rows(rows), _cols(cols), _starts(rows + 1, 0) {}
+	/**
+	 * Creates a sparse matrix with the non-zero elements of a dense matrix
+	 */
+	ASL_EXPLICIT SparseMatrix(const Matrix_<T>& a) : _rows(a.rows()), _cols(a.cols()), _starts(a.rows() + 1, 0)
+	{
+		for (int i = 0; i < _rows; i++)
+		{
+			for (int j = 0; j < _cols; j++)
+				if (a(i, j) != T(0))
+				{
+					_index << j;
+					_values << a(i, j);
+				}
+			_starts[i + 1] = _index.length();
+		}
+	}
+	/**
+	 * Creates a matrix from CSR arrays: the elements of row i are at positions [starts[i], starts[i+1]) of
+	 * `columns` and `values`, with columns in increasing order
+	 */
+	SparseMatrix(int rows, int cols, const Array<int>& starts, const Array<int>& columns, const Array<T>& values) :
+		_rows(rows), _cols(cols), _starts(starts), _index(columns), _values(values)
+	{}
+
+	/**
+	 * Returns the number of rows
+	 */
+	int rows() const { return _rows; }
+	/**
+	 * Returns the number of columns
+	 */
+	int cols() const { return _cols; }
+	/**
+	 * Returns the number of stored (non-zero) elements
+	 */
+	int nonzeros() const { return _values.length(); }
+	/**
+	 * Returns the element at row i, column j (zero if not stored)
+	 */
+	T operator()(int i, int j) const
+	{
+		int a = _starts[i], b = _starts[i + 1];
+		while (a < b)
+		{
+			int m = (a + b) / 2;
+			if (_index[m] < j)
+				a = m + 1;
+			else
+				b = m;
+		}
+		return (a < _starts[i + 1] && _index[a] == j) ? _values[a] : T(0);
+	}
+	/**
+	 * Returns the row start offsets (rows() + 1 elements)
+	 */
+	const Array<int>& rowStarts() const { return _starts; }
+	/**
+	 * Returns the column index of each stored element
+	 */
+	const Array<int>& columns() const { return _index; }
+	/**
+	 * Returns the stored element values
+	 */
+	const Array<T>& values() const { return _values; }
+
+	/**
+	 * Computes the product of this matrix and dense matrix x (usually a column)
+	 */
+	Matrix_<T> operator*(const Matrix_<T>& x) const { return multiply(x); }
+	/**
+	 * Computes the product of this matrix and dense matrix x splitting the rows among up to `nthreads` threads
+	 */
+	Matrix_<T> multiply(const Matrix_<T>& x, int nthreads = 1) const
+	{
+		Matrix_<T> y(_rows, x.cols());
+		if (x.rows() != _cols)
+			return y.clear();
+		if (y.length() > 0)
+			multiply(x.data().ptr(), y.data().ptr(), x.cols(), nthreads);
+		return y;
+	}
+	/**
+	 * Computes y = A * x for r-column row-major arrays x (cols() x r) and y (rows() x r)
+	 */
+	void multiply(const T* x, T* y, int r = 1, int nthreads = 1) const
+	{
+		if (nthreads > 1 && nonzeros() * r >= 100000)
+			nthreads = min(nthreads, Thread::numProcessors());
+		if (nthreads <= 1 || nonzeros() * r < 100000)
+		{
+			multiplyRows(0, _rows, x, y, r);
+			return;
+		}
+#ifdef ASL_EXP_THREADING
+		int n = _rows;
+		Thread::parallel_for(0, nthreads, [=](int t) {
+			multiplyRows(int((Long)n * t / nthreads), int((Long)n * (t + 1) / nthreads), x, y, r);
+		}, nthreads);
+#else
+		multiplyRows(0, _rows, x, y, r);
+#endif
+	}
+	/**
+	 * Computes the product of the transpose of this matrix and dense matrix x, without forming the transpose
+	 */
+	Matrix_<T> transposeMultiply(const Matrix_<T>& x) const
+	{
+		int r = x.cols();
+		Matrix_<T> y(_cols, r, T(0));
+		if (x.rows() != _rows)
+			return y.clear();
+		const T* X = x.data().ptr();
+		T* Y = y.data().ptr();
+		for (int i = 0; i < _rows; i++)
+		{
+			const T* xi = X + i * r;
+			for (int k = _starts[i]; k < _starts[i + 1]; k++)
+			{
+				T a = _values[k];
+				T* yj = Y + _index[k] * r;
+				for (int c = 0; c < r; c++)
+					yj[c] += a * xi[c];
+			}
+		}
+		return y;
+	}
+	/**
+	 * Returns this matrix transposed (which is also its compressed sparse column form)
+	 */
+	SparseMatrix transposed() const
+	{
+		Array<int> ri(nonzeros());
+		for (int i = 0; i < _rows; i++)
+			for (int k = _starts[i]; k < _starts[i + 1]; k++)
+				ri[k] = i;
+		return compress(_cols, _rows, nonzeros(), _index.ptr(), ri.ptr(), _values.ptr());
+	}
+	/**
+	 * Returns the diagonal elements as a column matrix
+	 */
+	Matrix_<T> diagonal() const
+	{
+		Matrix_<T> d(min(_rows, _cols), 1);
+		for (int i = 0; i < d.rows(); i++)
+			d[i] = (*this)(i, i);
+		return d;
+	}
+	/**
+	 * Returns this matrix as a dense matrix
+	 */
+	Matrix_<T> dense() const
+	{
+		Matrix_<T> a(_rows, _cols, T(0));
+		for (int i = 0; i < _rows; i++)
+			for (int k = _starts[i]; k < _starts[i + 1]; k++)
+				a(i, _index[k]) = _values[k];
+		return a;
+	}
+
+protected:
+	void multiplyRows(int i0, int i1, const T* x, T* y, int r) const
+	{
+		const int* starts = _starts.ptr();
+		const int* index = _index.ptr();
+		const T* values = _values.ptr();
+		if (r == 1)
+		{
+			for (int i = i0; i < i1; i++)
+			{
+				T s = 0;
+				for (int k = starts[i]; k < starts[i + 1]; k++)
+					s += values[k] * x[index[k]];
+				y[i] = s;
+			}
+			return;
+		}
+		for (int i = i0; i < i1; i++)
+		{
+			T* yi = y + i * r;
+			for (int c = 0; c < r; c++)
+				yi[c] = 0;
+			for (int k = starts[i]; k < starts[i + 1]; k++)
+			{
+				T a = values[k];
+				const T* xj = x + index[k] * r;
+				for (int c = 0; c < r; c++)
+					yi[c] += a * xj[c];
+			}
+		}
+	}
+
+	// Builds a CSR matrix from triplets: bucketing them by column first makes each row come out sorted,
+	// and then repeated positions are adjacent and can be merged
+
+	static SparseMatrix compress(int rows, int cols, int n, const int* ri, const int* ci, const T* v)
+	{
+		Array<int> cstart(cols + 1, 0), crow(n);
+		Array<T> cval(n);
+		for (int k = 0; k < n; k++)
+			cstart[ci[k] + 1]++;
+		for (int j = 0; j < cols; j++)
+			cstart[j + 1] += cstart[j];
+		Array<int> next = cstart.clone();
+		for (int k = 0; k < n; k++)
+		{
+			int p = next[ci[k]]++;
+			crow[p] = ri[k];
+			cval[p] = v[k];
+		}
+		SparseMatrix a(rows, cols);
+		a._index.resize(n);
+		a._values.resize(n);
+		for (int k = 0; k < n; k++)
+			a._starts[ri[k] + 1]++;
+		for (int i = 0; i < rows; i++)
+			a._starts[i + 1] += a._starts[i];
+		next = a._starts.clone();
+		for (int j = 0; j < cols; j++)
+			for (int p = cstart[j]; p < cstart[j + 1]; p++)
+			{
+				int q = next[crow[p]]++;
+				a._index[q] = j;
+				a._values[q] = cval[p];
+			}
+		int m = 0;
+		for (int i = 0; i < rows; i++)
+		{
+			int k0 = a._starts[i], k1 = a._starts[i + 1];
+			a._starts[i] = m;
+			for (int k = k0; k < k1; k++)
+			{
+				if (m > a._starts[i] && a._index[m - 1] == a._index[k])
+					a._values[m - 1] += a._values[k];
+				else
+				{
+					a._index[m] = a._index[k];
+					a._values[m++] = a._values[k];
+				}
+			}
+		}
+		a._starts[rows] = m;
+		a._index.resize(m);
+		a._values.resize(m);
+		return a;
+	}
+
+	int _rows, _cols;
+	Array<int> _starts;
+	Array<int> _index;
+	Array<T> _values;
+};
+
+/**
+ * An iterative solver for sparse linear systems A * x = b, using the conjugate gradient method (for symmetric
+ * positive definite matrices) or BiCGSTAB (for general square matrices), both with an optional Jacobi (diagonal)
+ * preconditioner.
+ *
+ * ~~~
+ * IterativeSolver<double> solver(IterativeSolver<double>::CG);
+ * solver.tolerance(1e-8).threads(4);
+ * Matrixd x = solver.solve(A, b);
+ * if (!solver.converged())
+ *     printf("error %g after %i iterations\n", solver.error(), solver.iterations());
+ * ~~~
+ * \ingroup Math3D
+ */
+template<class T>
+class IterativeSolver
+{
+public:
+	enum Method { CG, BICGSTAB };
+
+	/**
+	 * Creates a solver using the given method
+	 */
+	IterativeSolver(Method m = CG) :
+		_method(m), _maxIterations(1000), _tol(sizeof(T) == sizeof(float) ? T(1e-5) : T(1e-10)), _jacobi(true),
+		_threads(1), _iterations(0), _error(0), _converged(false)
+	{}
+	/**
+	 * Sets the solution method
+	 */
+	IterativeSolver& method(Method m) { _method = m; return *this; }
+	/**
+	 * Sets the maximum number of iterations
+	 */
+	IterativeSolver& maxIterations(int n) { _maxIterations = n; return *this; }
+	/**
+	 * Sets the tolerance: the iteration stops when |b - A * x| <= tol * |b|
+	 */
+	IterativeSolver& tolerance(T tol) { _tol = tol; return *this; }
+	/**
+	 * Enables or disables the Jacobi preconditioner (enabled by default)
+	 */
+	IterativeSolver& jacobi(bool on) { _jacobi = on; return *this; }
+	/**
+	 * Sets the number of threads used for the matrix-vector products
+	 */
+	IterativeSolver& threads(int n) { _threads = n; return *this; }
+
+	/**
+	 * Solves A * x = b, for a column b, starting from x = 0
+	 */
+	Matrix_<T> solve(const SparseMatrix<T>& A, const Matrix_<T>& b)
+	{
+		return solve(A, b, Matrix_<T>(b.rows(), 1, T(0)));
+	}
+	/**
+	 * Solves A * x = b, for a column b, starting from the estimate x0
+	 */
+	Matrix_<T> solve(const SparseMatrix<T>& A, const Matrix_<T>& b, const Matrix_<T>& x0);
+
+	/**
+	 * Returns the number of iterations done in the last solve
+	 */
+	int iterations() const { return _iterations; }
+	/**
+	 * Returns the relative residual |b - A * x| / |b| of the last solution
+	 */
+	T error() const { return _error; }
+	/**
+	 * Returns true if the last solve reached the tolerance
+	 */
+	bool converged() const { return _converged; }
+
+protected:
+	static double dot(const Array<T>& a, const Array<T>& b)
+	{
+		double s = 0;
+		for (int i = 0; i < a.length(); i++)
+			s += (double)a[i] * b[i];
+		return s;
+	}
+	void precondition(const Array<T>& r, Array<T>& z) const
+	{
+		for (int i = 0; i < r.length(); i++)
+			z[i] = r[i] * _diag[i];
+	}
+	void solveCG(const SparseMatrix<T>& A, Array<T>& x, Array<T>& r, double bnorm);
+	void solveBiCGSTAB(const SparseMatrix<T>& A, Array<T>& x, Array<T>& r, double bnorm);
+
+	Method _method;
+	int _maxIterations;
+	T _tol;
+	bool _jacobi;
+	int _threads;
+	int _iterations;
+	T _error;
+	bool _converged;
+	Array<T> _diag;
+};
+
+template<class T>
+Matrix_<T> IterativeSolver<T>::solve(const SparseMatrix<T>& A, const Matrix_<T>& b, const Matrix_<T>& x0)
+{
+	int n = A.rows();
+	_iterations = 0;
+	_converged = false;
+	_error = 0;
+	if (A.cols() != n || b.rows() != n || b.cols() != 1 || x0.rows() != n || x0.cols() != 1)
+		return Matrix_<T>();
+	_diag.resize(n);
+	for (int i = 0; i < n; i++)
+	{
+		T d = _jacobi ? A(i, i) : T(0);
+		_diag[i] = d != T(0) ? T(1) / d : T(1);
+	}
+	Array<T> x = x0.data().clone(), r(n);
+	A.multiply(x.ptr(), r.ptr(), 1, _threads);
+	for (int i = 0; i < n; i++)
+		r[i] = b[i] - r[i];
+	double bnorm = sqrt(dot(b.data(), b.data()));
+	if (bnorm == 0)
+	{
+		_converged = true;
+		return Matrix_<T>(n, 1, T(0));
+	}
+	_error = T(sqrt(dot(r, r)) / bnorm);
+	if (_error <= _tol)
+		_converged = true;
+	else if (_method == CG)
+		solveCG(A, x, r, bnorm);
+	else
+		solveBiCGSTAB(A, x, r, bnorm);
+	return Matrix_<T>(n, 1, x);
+}
+
+template<class T>
+void IterativeSolver<T>::solveCG(const SparseMatrix<T>& A, Array<T>& x, Array<T>& r, double bnorm)
+{
+	int n = x.length();
+	Array<T> z(n), p(n), q(n);
+	precondition(r, z);
+	p = z.clone();
+	double rz = dot(r, z);
+	while (_iterations < _maxIterations)
+	{
+		_iterations++;
+		A.multiply(p.ptr(), q.ptr(), 1, _threads);
+		double pq = dot(p, q);
+		if (pq == 0)
+			break;
+		T alpha = T(rz / pq);
+		for (int i = 0; i < n; i++)
+		{
+			x[i] += alpha * p[i];
+			r[i] -= alpha * q[i];
+		}
+		_error = T(sqrt(dot(r, r)) / bnorm);
+		if (_error <= _tol)
+		{
+			_converged = true;
+			break;
+		}
+		precondition(r, z);
+		double rz2 = dot(r, z);
+		T beta = T(rz2 / rz);
+		rz = rz2;
+		for (int i = 0; i < n; i++)
+			p[i] = z[i] + beta * p[i];
+	}
+}
+
+template<class T>
+void IterativeSolver<T>::solveBiCGSTAB(const SparseMatrix<T>& A, Array<T>& x, Array<T>& r, double bnorm)
+{
+	int n = x.length();
+	Array<T> r0 = r.clone(), p(n, T(0)), v(n, T(0)), ph(n), s(n), sh(n), t(n);
+	double rho = 1, alpha = 1, omega = 1;
+	while (_iterations < _maxIterations)
+	{
+		_iterations++;
+		double rho2 = dot(r0, r);
+		if (rho2 == 0)
+			break;
+		T beta = T((rho2 / rho) * (alpha / omega));
+		rho = rho2;
+		for (int i = 0; i < n; i++)
+			p[i] = r[i] + beta * (p[i] - T(omega) * v[i]);
+		precondition(p, ph);
+		A.multiply(ph.ptr(), v.ptr(), 1, _threads);
+		double r0v = dot(r0, v);
+		if (r0v == 0)
+			break;
+		alpha = rho / r0v;
+		for (int i = 0; i < n; i++)
+			s[i] = r[i] - T(alpha) * v[i];
+		double snorm = sqrt(dot(s, s)) / bnorm;
+		if (snorm <= _tol)
+		{
+			for (int i = 0; i < n; i++)
+				x[i] += T(alpha) * ph[i];
+			_error = T(snorm);
+			_converged = true;
+			break;
+		}
+		precondition(s, sh);
+		A.multiply(sh.ptr(), t.ptr(), 1, _threads);
+		double tt = dot(t, t);
+		omega = tt != 0 ? dot(t, s) / tt : 0;
+		for (int i = 0; i < n; i++)
+		{
+			x[i] += T(alpha) * ph[i] + T(omega) * sh[i];
+			r[i] = s[i] - T(omega) * t[i];
+		}
+		_error = T(sqrt(dot(r, r)) / bnorm);
+		if (_error <= _tol)
+		{
+			_converged = true;
+			break;
+		}
+		if (omega == 0)
+			break;
+	}
+}
+
+}
+#endif
@@ -109,6 +109,137 @@ String items = array(1, 2, 3); // -> "[1,2,3]"     array of ints to string
 ~~~
 */
 
+/**
+A non-owning view of a sequence of characters given by a pointer and a length. The characters are not
+necessarily null-terminated and must remain valid while the view is used. A String can be constructed
+from a view when an owned copy is needed.
+
+Views have the search and compare functions of String, and their substrings, trimmed versions and split
+parts are also views, so text can be parsed without allocating memory:
+
+~~~
+Array<StringView> fields;
+line.splitViews(",", fields);        // reuses the array's memory
+StringView name = fields[0].trimmed();
+double value = fields[1].toDouble();
+String owned = name;                 // copy only what must outlive the line
+~~~
+*/
+class ASL_API StringView
+{
+	const char* _s;
+	int _n;
+public:
+	StringView() : _s(""), _n(0) {}
+	StringView(const char* s, int n) : _s(s), _n(n) {}
+	StringView(const char* s) : _s(s), _n((int)strlen(s)) {}
+	inline StringView(const String& s);
+	/**
+	Returns a pointer to the first character
+	*/
+	const char* data() const { return _s; }
+	/**
+	Returns the number of characters
+	*/
+	int length() const { return _n; }
+	/**
+	Returns true if the view is not empty
+	*/
+	bool ok() const { return _n > 0; }
+	const char* begin() const { return _s; }
+	const char* end() const { return _s + _n; }
+	char operator[](int i) const { return _s[i]; }
+	bool operator==(const StringView& v) const { return _n == v._n && memcmp(_s, v._s, _n) == 0; }
+	bool operator!=(const StringView& v) const { return !(*this == v); }
+	bool operator<(const StringView& v) const
+	{
+		int c = memcmp(_s, v._s, _n < v._n ? _n : v._n);
+		return c < 0 || (c == 0 && _n < v._n);
+	}
+	/**
+	Tests if this view is equal to `s` ignoring case (ASCII letters only)
+	*/
+	bool equalsNocase(const StringView& s) const;
+	/**
+	Returns the first index of character `c` starting at position `i0`, or -1 if not found
+	*/
+	int indexOf(char c, int i0 = 0) const
+	{
+		const void* p = (i0 < _n) ? memchr(_s + i0, c, _n - i0) : 0;
+		return p ? int((const char*)p - _s) : -1;
+	}
+	/**
+	Returns the first index where `s` appears in this view starting at position `i0`, or -1 if not found
+	*/
+	int indexOf(const StringView& s, int i0 = 0) const;
+	/**
+	Returns the last index of character `c`, or -1 if not found
+	*/
+	int lastIndexOf(char c) const;
+	/**
+	Returns the last index where `s` appears in this view, or -1 if not found
+	*/
+	int lastIndexOf(const StringView& s) const;
+	/**
+	Tests if this view contains character `c`
+	*/
+	bool contains(char c) const { return indexOf(c) >= 0; }
+	/**
+	Tests if this view contains `s`
+	*/
+	bool contains(const StringView& s) const { return indexOf(s) >= 0; }
+	/**
+	Tests if this view starts with `s`
+	*/
+	bool startsWith(const StringView& s) const { return _n >= s._n && memcmp(_s, s._s, s._n) == 0; }
+	bool startsWith(char c) const { return _n > 0 && _s[0] == c; }
+	/**
+	Tests if this view ends with `s`
+	*/
+	bool endsWith(const StringView& s) const { return _n >= s._n && memcmp(_s + _n - s._n, s._s, s._n) == 0; }
+	bool endsWith(char c) const { return _n > 0 && _s[_n - 1] == c; }
+	/**
+	Returns a view of the characters from position `i` up to but not including position `j`
+	*/
+	StringView substring(int i, int j) const { return StringView(_s + i, j - i); }
+	/**
+	Returns a view of the characters from position `i` to the end
+	*/
+	StringView substring(int i) const { return StringView(_s + i, _n - i); }
+	/**
+	Returns this view without whitespace at the beginning and end
+	*/
+	StringView trimmed() const
+	{
+		int i = 0, j = _n;
+		while (i < j && myisspace(_s[i]))
+			i++;
+		while (j > i && myisspace(_s[j - 1]))
+			j--;
+		return StringView(_s + i, j - i);
+	}
+	/**
+	Splits this view into the parts separated by `sep`, stored in `out` (whose memory is reused)
+	*/
+	void split(const StringView& sep, Array<StringView>& out) const;
+	/**
+	Returns the parts of this view separated by `sep`
+	*/
+	Array<StringView> split(const StringView& sep) const;
+	/**
+	Returns the parts of this view separated by whitespace
+	*/
+	Array<StringView> split() const;
+	/**
+	Parses the view as an integer
+	*/
+	int toInt() const;
+	/**
+	Parses the view as a floating point number
+	*/
+	double toDouble() const;
+};
+
 class ASL_API String
 {
 protected:
@@ -121,6 +252,7 @@ protected:
 	void free();
 	void init(int n) {alloc(n); _len=n;}
 	char* str() const {return (_size==0)? (char*)_space : (char*)_str;}
+	bool overlaps(const StringView& v) const { return v.data() >= str() && v.data() <= str() + _len; }
 	String(void*) {} // avoid accidental construction from arbitrary pointers
 public:
 	/**
@@ -166,6 +298,15 @@ public:
 		str()[n] = '\0';
 	}
 	/**
+	Constructs a string from the characters referenced by a StringView
+	*/
+	String(const StringView& v)
+	{
+		init(v.length());
+		memcpy(str(), v.data(), v.length());
+		str()[_len] = '\0';
+	}
+	/**
 	Constructs a string from a byte array`
 	*/
 	String(const Array<char>& txt)
@@ -308,11 +449,11 @@ public:
 	/**
 	Converts this string to a 32-bit floating-point number
 	*/
-	operator float() const {return (float)myatof(str());}
+	operator float() const {return (float)myatof(str(), str() + _len);}
 	/**
 	Converts this string to a 64-bit floating-point number
 	*/
-	operator double() const {return atof(str());}
+	operator double() const {return myatof(str(), str() + _len);}
 	/**
 	Converts this string to a 64-bit integer number
 	*/
@@ -353,8 +494,8 @@ public:
 	*/
 	const char* operator*() const {return str();}
 	int toInt() const {return atoi(str());}
-	double toDouble() const { return atof(str()); }
-	float toFloat() const {return (float)atof(str());}
+	double toDouble() const { return myatof(str(), str() + _len); }
+	float toFloat() const {return (float)myatof(str(), str() + _len);}
 	/**
 	Returns true if this string represents a non-false value (e.g. none of: "", "0", "N", "false", "no")
 	*/
@@ -393,6 +534,7 @@ public:
 	void operator=(int n) {(*this)=(String)n;}
 	void operator=(double n) {(*this)=(String)n;}
 	void operator=(bool n) {(*this)=(String)n;}
+	void operator=(const StringView& v) { if (overlaps(v)) *this = String(v); else assign(v.data(), v.length()); }
 	template <class T>
 	void operator=(const T& x) { String s=x; *this = s; }
 	String operator+(const String& b) const {return concat(b.str(), b._len);}
@@ -400,6 +542,7 @@ public:
 	String operator+(char b) const {return concat(&b, 1);}
 	void operator+=(const String& b) {append(b.str(), b._len);}
 	void operator+=(const char* b) {append(b, (int)strlen(b));}
+	void operator+=(const StringView& v) { if (overlaps(v)) *this += String(v); else append(v.data(), v.length()); }
 	void operator+=(char b) {int n=_len+1; if(n>=_size) resize(n); char*s = str(); s[n-1] = b; s[n] = '\0'; _len=n;}
 
 	template<class T>
@@ -412,10 +555,14 @@ public:
 
 	String& operator<<(const char* x) {*this += x; return *this;}
 
+	String& operator<<(const StringView& x) {*this += x; return *this;}
+
 	bool operator==(const String& s) const
 	{return (_len!=s._len)?false:!memcmp(str(), s.str(), _len);}
 	bool operator==(const char* s) const {return !strcmp(str(),s);}
 	bool operator==(char c) const {return _len==1 && str()[0]==c;}
+	bool operator==(const StringView& v) const { return _len == v.length() && memcmp(str(), v.data(), _len) == 0; }
+	bool operator!=(const StringView& v) const { return !(*this == v); }
 	bool operator!=(const String& s) const
 	{return (_len!=s._len)?true:memcmp(str(),s.str(),_len)!=0;}
 	bool operator!=(const char* s) const {return strcmp(str(),s)!=0;}
@@ -456,15 +603,16 @@ public:
 	Returns the first index where substring `s` appears in this string, optionally starting search at position
 	`i0`, or -1 if it is not found.
 	*/
-	int indexOf(const String& s, int i0=0) const {return indexOf((const char*)s, i0);}
+	int indexOf(const String& s, int i0=0) const;
 	/**
 	Returns the last index where character `c` appears in this string, or -1 if it is not found.
 	*/
-	int lastIndexOf(char c) const {char* p=strrchr(str(), c); return p?int(p-str()):-1;}
+	int lastIndexOf(char c) const;
 	/**
 	Returns the last index where string `s` appears in this string, or -1 if it is not found.
 	*/
 	int lastIndexOf(const char* s) const;
+	int lastIndexOf(const String& s) const {return view().lastIndexOf(s.view());}
 	/**
 	Returns the length of this string in bytes
 	*/
@@ -495,6 +643,19 @@ public:
 	*/
 	String& trim();
 	/**
+	Returns a view of the characters from position `i` up to but not including position `j`, without copying them
+	(the view is valid while this string is not modified or destroyed)
+	*/
+	StringView view(int i, int j) const { return StringView(str() + i, j - i); }
+	/**
+	Returns a view of the characters from position `i` to the end, without copying them
+	*/
+	StringView view(int i = 0) const { return StringView(str() + i, _len - i); }
+	/**
+	Returns a view of this string without space at the beginning or end
+	*/
+	StringView trimmedView() const { return view().trimmed(); }
+	/**
 	Tests if this string starts with the given substring
 	*/
 	bool startsWith(const String& s) const { return _len >= s.length() && strncmp(str(), s, s.length()) == 0; }
@@ -581,6 +742,19 @@ public:
 	~~~
 	*/
 	Dic<String> split(const String& sep1, const String& sep2) const;
+	/**
+	Returns views of the parts of this string separated by `sep`, like split() but without copying the parts
+	*/
+	Array<StringView> splitViews(const StringView& sep) const { return view().split(sep); }
+	/**
+	Stores in `out` views of the parts of this string separated by `sep`; reusing `out` for many strings avoids
+	all memory allocations
+	*/
+	void splitViews(const StringView& sep, Array<StringView>& out) const { view().split(sep, out); }
+	/**
+	Returns views of the parts of this string separated by whitespace
+	*/
+	Array<StringView> splitViews() const { return view().split(); }
 
 	/**
 	Returns a string like this one but in which occurences of substring `a` are replaced by `b`
@@ -606,6 +780,8 @@ public:
 	Enumerator all() const {return Enumerator(*this);}
 };
 
+inline StringView::StringView(const String& s) : _s(*s), _n(s.length()) {}
+
 inline String operator+(const char* a, const String& b)
 {
 	String s(a);
@@ -0,0 +1,157 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+#ifndef ASL_STRINGBUILDER_H
+#define ASL_STRINGBUILDER_H
+
+#include <asl/String.h>
+
+namespace asl {
+
+class File;
+class Socket;
+
+/**
+A StringBuilder accumulates large text output incrementally in a list of fixed-size blocks. Unlike appending to a
+String, growing never reallocates or copies what was already written, so building a document of N bytes needs about
+N bytes of memory. The content can be written to a File or a Socket directly from the blocks with a single gather
+write, or joined into one String if needed.
+
+~~~
+StringBuilder out;
+out << "x = " << 3.5 << '\n';
+Xdl::encode(data, out);       // encoders can append into a builder
+out.writeTo(file);            // write all blocks to an open File
+String s = out.string();      // or join them
+~~~
+
+A builder can also be attached to a File or Socket as a sink. Then it keeps a single block that is written out each
+time it fills up (and on `flush()` or destruction), so encoding a large document uses constant memory and overlaps
+with the I/O:
+
+~~~
+File file("data.json", File::WRITE);
+StringBuilder out(file);
+Json::encode(data, out);
+~~~
+*/
+class ASL_API StringBuilder
+{
+public:
+	/**
+	Constructs an empty builder that allocates blocks of `blockSize` bytes
+	*/
+	ASL_EXPLICIT StringBuilder(int blockSize = 65536);
+	/**
+	Constructs a builder that writes its content to an open file every `flushSize` bytes
+	*/
+	ASL_EXPLICIT StringBuilder(File& file, int flushSize = 65536);
+	/**
+	Constructs a builder that sends its content through a connected socket every `flushSize` bytes
+	*/
+	ASL_EXPLICIT StringBuilder(Socket& socket, int flushSize = 65536);
+	~StringBuilder();
+	/**
+	Returns the number of characters written (including those already flushed to the sink)
+	*/
+	Long length() const { return _full + (_p - _block); }
+	/**
+	Returns true if nothing has been written
+	*/
+	bool isEmpty() const { return length() == 0; }
+	/**
+	Discards all content and releases the blocks
+	*/
+	void clear();
+	/**
+	Writes the pending content to the sink, if there is one
+	*/
+	void flush();
+	/**
+	Returns true if writing to the sink failed
+	*/
+	bool error() const { return _error; }
+	/**
+	Appends `n` characters from `s`
+	*/
+	void append(const char* s, int n)
+	{
+		if (n == 0)
+			return;
+		if (_end - _p >= n)
+		{
+			memcpy(_p, s, n);
+			_p += n;
+		}
+		else
+			appendLong(s, n);
+	}
+	/**
+	Returns a pointer where at least `n` contiguous characters can be written, to be followed by `commit()` with the
+	number of characters actually written
+	*/
+	char* reserve(int n)
+	{
+		if (_end - _p < n)
+			newBlock(n);
+		return _p;
+	}
+	/**
+	Marks as written `n` characters at the pointer returned by `reserve()`
+	*/
+	void commit(int n) { _p += n; }
+
+	StringBuilder& operator<<(char c)
+	{
+		if (_p == _end)
+			newBlock(1);
+		*_p++ = c;
+		return *this;
+	}
+	StringBuilder& operator<<(const char* s) { append(s, (int)strlen(s)); return *this; }
+	StringBuilder& operator<<(const String& s) { append(*s, s.length()); return *this; }
+	StringBuilder& operator<<(const StringView& s) { append(s.data(), s.length()); return *this; }
+	StringBuilder& operator<<(int x) { commit(myitoa(x, reserve(12))); return *this; }
+	StringBuilder& operator<<(Long x) { commit(myltoa(x, reserve(21))); return *this; }
+	StringBuilder& operator<<(float x) { commit(myftoa(x, reserve(16))); return *this; }
+	StringBuilder& operator<<(double x) { commit(myftoa(x, reserve(26))); return *this; }
+	/**
+	Returns the number of blocks holding content
+	*/
+	int numBlocks() const { return _blocks.length() + (_p > _block ? 1 : 0); }
+	/**
+	Returns the content of block `i`
+	*/
+	StringView block(int i) const { return i < _blocks.length() ? _blocks[i] : StringView(_block, int(_p - _block)); }
+	/**
+	Returns the whole content (not yet flushed) joined in a single String
+	*/
+	String string() const;
+	/**
+	Writes the whole content to an open file and returns the number of bytes written
+	*/
+	Long writeTo(File& file) const;
+	/**
+	Writes the whole content to a connected socket and returns the number of bytes written
+	*/
+	Long writeTo(Socket& socket) const;
+private:
+	StringBuilder(const StringBuilder&);
+	void operator=(const StringBuilder&);
+	void init(int blockSize);
+	void newBlock(int n);
+	void appendLong(const char* s, int n);
+	Array<StringView> blockList() const;
+	Array<StringView> _blocks;
+	char* _block;
+	char* _p;
+	char* _end;
+	Long _full;
+	int _blockSize;
+	File* _file;
+	Socket* _socket;
+	bool _error;
+};
+
+}
+#endif
@@ -8,9 +8,30 @@
 #include <asl/Array.h>
 #include <asl/String.h>
 #include <asl/Var.h>
+#include <asl/Thread.h>
+#include <asl/Pointer.h>
 
 namespace asl {
 
+/**
+A column of a tabular data file read with `TabularDataFile::readColumns()`. Values are stored in the array
+matching the column type: `numbers` for type 'n', `ints` for types 'i' and 'h' and `strings` for type 's'.
+Empty or non-numeric fields in number columns read as 0, as they do with `nextRow()`.
+*/
+struct TabularDataColumn
+{
+	String name;
+	char type;
+	Array<double> numbers;
+	Array<int> ints;
+	Array<String> strings;
+	TabularDataColumn() : type('n') {}
+	/**
+	Returns the number of values in this column
+	*/
+	int length() const { return type == 's' ? strings.length() : (type == 'n') ? numbers.length() : ints.length(); }
+};
+
 /**
 This class allows reading/writing CSV files and writing ARFF files.
 Files have an optional header with column names, and data rows that can contain
@@ -54,6 +75,28 @@ TabularDataFile file("data.csv");
 Array<Array<Var>> dataset = file.data();
 ~~~
 
+For large files it is much faster to read all data at once by columns, each in a typed array. Numbers are parsed
+directly from a large read buffer and quoted values can contain separators. Optionally, the file can be parsed by
+several threads:
+
+~~~{.cpp}
+TabularDataFile file("data.csv");
+Array<TabularDataColumn> columns = file.readColumns(4);
+Array<double>& x = columns[1].numbers;
+~~~
+
+When logging many rows, it is faster to write typed rows with `appendRow()` or `append()`, which format values
+directly into a buffer, and to let that buffer be written only when it reaches some size. With the `background`
+option, disk writes happen in a separate thread so the caller never waits for the disk:
+
+~~~{.cpp}
+TabularDataFile file("log.csv");
+file.columns("t,x,y,state");
+file.useBuffer(1 << 20, true);
+...
+file.appendRow(t, x, y, "moving");
+~~~
+
 If a file uses a specific format that autodetection can't handle, use `readAs()` to sepecify column types.
 That includes the ability to read numbers as hexadecimal. For example:
 
@@ -85,6 +128,7 @@ public:
 	Creates a data file with name `filename` for writing with the given column names
 	*/
 	TabularDataFile(const String& filename, const Array<String>& cols);
+	~TabularDataFile();
 
 	/**
 	Defines the columns for the data with a comma separated list of column names
@@ -144,6 +188,16 @@ public:
 		_flushEvery = nrows;
 	}
 	/**
+	Makes written rows accumulate in a buffer that is written to the file when it exceeds `size` bytes or
+	on `flush()`. If `background` is true, the file is written in a separate thread.
+	*/
+	void useBuffer(int size, bool background = false);
+	/**
+	Writes pending buffered rows to the file and flushes it (with a background writer, waits until it has
+	written everything queued)
+	*/
+	void flush();
+	/**
 	Sets the types to read for each column as a string with chars:
 	i:int, n:number, h:hex, s:string
 	*/
@@ -153,12 +207,56 @@ public:
 	number of columns defined.
 	*/
 	TabularDataFile& operator<<(const Var& x);
+	/**
+	Writes a row made of the `n` numbers pointed by `x`
+	*/
+	TabularDataFile& append(const double* x, int n);
+	/**
+	Writes a row made of the given numbers
+	*/
+	TabularDataFile& append(const Array<double>& x) { return append(x.ptr(), x.length()); }
+	/**
+	Writes a row with the given values, which can be numbers or strings, without creating intermediate `Var`s
+	*/
+	template<class A>
+	TabularDataFile& appendRow(const A& a) { put(a); return endRow(); }
+	template<class A, class B>
+	TabularDataFile& appendRow(const A& a, const B& b) { put(a); put(b); return endRow(); }
+	template<class A, class B, class C>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c) { put(a); put(b); put(c); return endRow(); }
+	template<class A, class B, class C, class D>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c, const D& d) { put(a); put(b); put(c); put(d); return endRow(); }
+	template<class A, class B, class C, class D, class E>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c, const D& d, const E& e)
+	{
+		put(a); put(b); put(c); put(d); put(e); return endRow();
+	}
+	template<class A, class B, class C, class D, class E, class F>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c, const D& d, const E& e, const F& f)
+	{
+		put(a); put(b); put(c); put(d); put(e); put(f); return endRow();
+	}
+	template<class A, class B, class C, class D, class E, class F, class G>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c, const D& d, const E& e, const F& f, const G& g)
+	{
+		put(a); put(b); put(c); put(d); put(e); put(f); put(g); return endRow();
+	}
+	template<class A, class B, class C, class D, class E, class F, class G, class H>
+	TabularDataFile& appendRow(const A& a, const B& b, const C& c, const D& d, const E& e, const F& f, const G& g, const H& h)
+	{
+		put(a); put(b); put(c); put(d); put(e); put(f); put(g); put(h); return endRow();
+	}
 
 	/**
 	Returns the whole file contents as a matrix (array of arrays)
 	*/
 	Array<Array<Var> > data();
 	/**
+	Reads the whole file contents as an array of typed columns, using `nthreads` threads for parsing.
+	Column types are those given with `readAs()` or otherwise inferred from the first data row (numbers or strings).
+	*/
+	Array<TabularDataColumn> readColumns(int nthreads = 1);
+	/**
 	Reads the next row and returns true if it succeded
 	*/
 	bool nextRow();
@@ -178,11 +276,22 @@ public:
 	}
 protected:
 	void init();
+	void put(double x);
+	void put(float x) { put((double)x); }
+	void put(int x);
+	void put(const String& x) { put(*x, x.length()); }
+	void put(const char* x) { put(x, (int)strlen(x)); }
+	void put(const char* x, int n);
+	void write(const char* p, int n);
+	TabularDataFile& endRow();
+	void writePending();
+	TabularDataFile(const TabularDataFile&);
+	void operator=(const TabularDataFile&);
 	mutable TextFile _file;
 	Array<String> _columnNames;
 	Array<Var> _row;
 	String _currentLine;
-	Array<String> _currentRowParts;
+	Array<StringView> _currentRowParts;
 	String _name;
 	String _types;
 	char _separator, _decimal, _quote;
@@ -190,6 +299,9 @@ protected:
 	bool _dataStarted;
 	int _numCols, _currCol;
 	int _flushEvery, _rowIndex;
+	Array<char> _buffer;
+	int _bufferUsed, _bufferSize;
+	Shared<Thread> _writer;
 };
 
 }
@@ -5,6 +5,7 @@
 #define ASL_TEXTFILE_H
 
 #include <asl/File.h>
+#include <asl/Pointer.h>
 
 namespace asl {
 
@@ -42,6 +43,17 @@ while(!log.end())
 }
 ~~~
 
+Large files can be scanned line by line much faster with `lineViews()`, which reads big blocks and gives
+each line as a StringView into that block (valid only until the next line is read):
+
+~~~
+for (StringView line : TextFile("big.log").lineViews())
+{
+	if (line.length() > 0 && line[0] == '#')
+		comments++;
+}
+~~~
+
 */
 
 class ASL_API TextFile : public File
@@ -101,8 +113,53 @@ public:
 	TextFile& operator<<(const String& x);
 	TextFile& operator<<(char* x) { *this << String(x); return *this; }
 	TextFile& operator<<(const char* x) { *this << String(x); return *this; }
+
+	/**
+	An enumerator of the lines of a file as StringViews, returned by `lineViews()`. Copies share the read position.
+	*/
+	struct ASL_API LineEnumerator
+	{
+		struct State
+		{
+			File file;
+			FILE* f;
+			Array<char> buffer;
+			int begin, end;
+			bool eof;
+		};
+		Shared<State> _s;
+		StringView _line;
+		bool _more;
+		LineEnumerator(FILE* f, const String& path);
+		void operator++();
+		operator bool() const { return _more; }
+		bool operator!=(const LineEnumerator& e) const { return _more; }
+		const StringView& operator*() const { return _line; }
+		LineEnumerator all() const { return *this; }
+	};
+
+	/**
+	Returns an enumerator of the lines of the file (without line terminators) as StringViews pointing into an
+	internal buffer. Each view is valid until the next line is read. This avoids allocating a String per line.
+	The file does not need to be opened; if it was, reading continues from the current position.
+	*/
+	LineEnumerator lineViews();
 };
 
+#ifdef ASL_HAVE_RANGEFOR
+
+inline TextFile::LineEnumerator begin(const TextFile::LineEnumerator& e)
+{
+	return e.all();
+}
+
+inline TextFile::LineEnumerator end(const TextFile::LineEnumerator& e)
+{
+	return e.all();
+}
+
+#endif
+
 }
 #endif
 
@@ -29,6 +29,7 @@ ASL_SMART_CLASS(TlsSocket, Socket)
 	int available();
 	int read(void* data, int size);
 	int write(const void* data, int n);
+	Long writeBlocks(const StringView* blocks, int n);
 	bool waitInput(double timeout = 60);
 	String errorMsg() const;
 	bool useCert(const String& cert);
@@ -19,19 +19,26 @@ namespace asl {
 #ifndef ASL_VAR_STATIC
 #define NEW_ARRAY(a) (a) = new Array<Var>
 #define NEW_ARRAYC(a, x) (a) = new Array<Var>(x)
+#define NEW_ARRAYA(a, arena) (a) = new Array<Var>(arena)
 #define DEL_ARRAY(a) delete (a)
 #define NEW_DIC(d) (d) = new HDic<Var>
 #define NEW_DICC(d, x) (d) = new HDic<Var>(x)
 #define DEL_DIC(d) delete (d)
+#define NEW_STRING(s) (s) = new asl::Array<char>
+#define NEW_STRINGC(s, n) (s) = new asl::Array<char>(n)
+#define NEW_STRINGA(s, arena, n) (s) = new asl::Array<char>(arena, n)
+#define DEL_STRING(s) delete (s)
 #else
 #define NEW_ARRAY(a) (a).construct()
 #define NEW_ARRAYC(a, x) (a).construct(x)
+#define NEW_ARRAYA(a, arena) (a).construct(asl::Array<Var>(arena))
 #define DEL_ARRAY(a) (a).destroy()
 #define NEW_DIC(d) (d).construct()
 #define NEW_DICC(d, x) (d).construct(x)
 #define DEL_DIC(d) (d).destroy()
 #define NEW_STRING(s) (s).construct()
 #define NEW_STRINGC(s, n) (s).construct(asl::Array<char>(n))
+#define NEW_STRINGA(s, arena, n) (s).construct(asl::Array<char>(arena, n))
 #define DEL_STRING(s) (s).destroy()
 #endif
 
@@ -178,6 +185,36 @@ will print the string:
 
 For a better representation that can be parsed back into a Var, you can use XDL (`Xdl::encode(var)`) or JSON (`Json::encode(var)`).
 
+__Packed numeric arrays__
+
+An array of numbers can be stored packed, as a plain `Array<int>`, `Array<float>` or `Array<double>` instead of one Var
+per element. Such a var reports type ARRAY and behaves as an array of INT, FLOAT or NUMBER elements, but uses 4 or 8
+bytes per element instead of 16. Like regular arrays, packed arrays are shared by the vars copied from them. Packing is
+optional: a var is packed with `pack()`, created packed with `Var::packed()`, and the JSON and XDL decoders pack arrays
+whose elements are all numbers with the `Json::PACKED` option. Converting back to an Array of the same element type is
+immediate, as the storage is shared (like `array()` shares the Var array):
+
+~~~
+Var v = Json::decode("[1.5, 2, 3.25]", Json::PACKED); // v.packedType() == Var::NUMBER
+Array<double> x = v;                                  // no copy
+~~~
+
+All elements of a packed array have the same type, so an array like `[1, 2.5]` is packed as doubles and its first
+element then reads as NUMBER, not INT.
+
+Reading elements does not change the storage: `item(i)`, `operator[]` on a const Var and iteration return the
+elements by value (so assigning to the iteration variable has no effect on a packed array). Appending numbers of the
+packed type keeps it packed. Other modifications, like writing an element through `operator[]` on a non-const Var
+or appending a value of another type, convert the shared storage into a regular array of Vars (16 bytes per element)
+that all copies see.
+
+__Arena allocation__
+
+The decoders can allocate the string values and arrays of the decoded tree, and the property lists of its objects, in
+an Arena (`Json::decode(json, arena)`), which is faster to release. Object keys are regular Strings, so keys longer than
+15 bytes still take a heap block each. Vars copied from that tree share its content
+and keep the arena memory alive, so they can be used after the Arena object is gone. Use `clone()` to get a copy in
+normal memory that does not hold the whole arena.
 */
 
 
@@ -187,7 +224,7 @@ class ASL_API Var
 	void operator+(const Var& v) {}
 	void operator-(const Var& v) {}
   public:
-	enum Type {NONE, NUL, NUMBER, BOOL, INT, SSTRING, FLOAT, STRING=8, ARRAY, DIC, OBJ=10};
+	enum Type {NONE, NUL, NUMBER, BOOL, INT, SSTRING, FLOAT, STRING=8, ARRAY, DIC, OBJ=10, INT_ARRAY, FLOAT_ARRAY, DOUBLE_ARRAY, PACKED};
 	bool isPod() const {return (_type & 8)==0;}
 	Var(): _type(NONE), ll(0) {}
 	Var(Type t);
@@ -286,7 +323,32 @@ class ASL_API Var
 	/** Returns a string representation of this var */
 	String string() const { return toString(); }
 	/** Returns the internal type of this var */
-	Type type() const {return _type != SSTRING? _type : STRING;}
+	Type type() const {return _type == SSTRING ? STRING : _type > DIC ? ARRAY : _type;}
+	/**
+	Returns the element type (INT, FLOAT or NUMBER) if this var is a packed numeric array, or NONE otherwise
+	*/
+	Type packedType() const
+	{
+		switch (_type) {
+		case PACKED: return (*a)[0].packedType();
+		case INT_ARRAY: return INT;
+		case FLOAT_ARRAY: return FLOAT;
+		case DOUBLE_ARRAY: return NUMBER;
+		default: return NONE;
+		}
+	}
+	/**
+	Converts this var, if it is an array of numbers, to a packed array with elements of type `t` (INT, FLOAT or NUMBER),
+	or of the narrowest type that holds all elements exactly if `t` is NONE (INT if all are INT, FLOAT if all are FLOAT,
+	otherwise NUMBER); returns false if it is not a numeric array
+	*/
+	bool pack(Type t = NONE);
+	/**
+	Returns a packed var with a copy of the given numbers
+	*/
+	static Var packed(const Array<int>& a);
+	static Var packed(const Array<float>& a);
+	static Var packed(const Array<double>& a);
 
 	operator double() const;
 	operator float() const;
@@ -308,7 +370,7 @@ class ASL_API Var
 	/**
 	Returns the internal Array if this var is an array
 	*/
-	Array<Var> array() const { return _type == ARRAY ? *a : Array<Var>(); }
+	Array<Var> array() const { return _type == ARRAY ? *a : _type > DIC ? operator Array<Var>() : Array<Var>(); }
 
 	/**
 	Returns the boolean value of this var (similar to JS conversion)
@@ -346,6 +408,9 @@ class ASL_API Var
 	void operator=(const String& x);
 	template<class T>
 	void operator=(const Array<T>& x);
+	void operator=(const Array<int>& x) { *this = Var(x); }
+	void operator=(const Array<float>& x) { *this = Var(x); }
+	void operator=(const Array<double>& x) { *this = Var(x); }
 	template<class T>
 	void operator=(const HDic<T>& x);
 	/** Appends `x` to this var if this var is an array (useful for Var construction) */
@@ -362,11 +427,17 @@ class ASL_API Var
 			_type=ARRAY;
 			NEW_ARRAY(a);
 		}
-		else if(_type==ARRAY)
+		else if (_type == PACKED)
+			(*a)[0].resize(n);
+		else if (_type > DIC)
+			unpack();
+		if(_type==ARRAY)
 			a->resize(n);
 	}
-	/** Returns the element at index `i` if this var is an array */
-	const Var& operator[](int i) const;
+	/** Returns (a copy of) the element at index `i` if this var is an array */
+	Var operator[](int i) const;
+	/** Returns the element at index `i` if this var is an array, by value (it does not modify a packed array) */
+	Var item(int i) const;
 	/** Returns the element at index `i` if this var is an array */
 	Var& operator[](int i);
 	/** Returns the property named `key` if this var is an object */
@@ -406,6 +477,8 @@ class ASL_API Var
 			double x = *this;
 			return other == x;
 		}
+		else if (_type > DIC || other._type > DIC)
+			return equals(other);
 		else if(_type != other._type) return false;
 		switch(_type){
 			case NUMBER: return d==other.d;
@@ -483,7 +556,7 @@ class ASL_API Var
 	bool is(Type t) const
 	{
 		return _type == t || (t==NUMBER && (_type == INT || _type == FLOAT)) ||
-			(t==STRING && _type == SSTRING) || (t==SSTRING && _type == STRING);
+			(t==STRING && _type == SSTRING) || (t==SSTRING && _type == STRING) || (t == ARRAY && _type > DIC);
 	}
 
 	/**
@@ -491,6 +564,10 @@ class ASL_API Var
 	*/
 	bool isArrayOf(Type t) const
 	{
+		if (_type == PACKED)
+			return (*a)[0].isArrayOf(t);
+		if (_type > DIC)
+			return t == NUMBER || t == packedType() || length() == 0;
 		if (_type != ARRAY)
 			return false;
 		for (int i = 0, n = length(); i < n; i++)
@@ -504,6 +581,10 @@ class ASL_API Var
 	*/
 	bool isArrayOf(int n, Type t) const
 	{
+		if (_type == PACKED)
+			return (*a)[0].isArrayOf(n, t);
+		if (_type > DIC)
+			return length() == n && isArrayOf(t);
 		if (_type != ARRAY || a->length() != n)
 			return false;
 		for (int i = 0; i < n; i++)
@@ -525,58 +606,31 @@ class ASL_API Var
 		return (_type==DIC)? o->has(k) && (*o)[k].is(t) : false;
 	}
 	/** Checks if this var is an array and contains an element with value `x`. */
-	bool contains(const Var& x) const
-	{
-		return (_type==ARRAY)? a->contains(x) : false;
-	}
+	bool contains(const Var& x) const;
 	/** Clears the contents if this var is an array or an object. */
 	void clear()
 	{
 		if (_type==ARRAY)
 			a->clear();
+		else if (_type == PACKED)
+			(*a)[0].clear();
 		else if (_type==DIC)
 			o->clear();
+		else if (_type == INT_ARRAY)
+			ai->clear();
+		else if (_type == FLOAT_ARRAY)
+			af->clear();
+		else if (_type == DOUBLE_ARRAY)
+			ad->clear();
 	}
 
 	/**
 	Returns an independent copy of this Var (for arrays and objects)
 	*/
 	Var clone() const;
-	struct Enumerator
-	{
-		Var& v;
-#ifndef ASL_VAR_STATIC
-		HDic<Var>::Enumerator* e;
-#else
-		StaticSpace< HDic<Var>::Enumerator > e;
-#endif
-		int i;
-		Enumerator(const Var& x) : v(*(Var*)&x), i(0)
-		{
-			if(x._type==DIC)
-#ifndef ASL_VAR_STATIC
-				e=new HDic<Var>::Enumerator(*x.o);
-#else
-				e.construct(*x.o);
-#endif
-		}
-		~Enumerator()
-		{
-			if(v._type==DIC)
-#ifndef ASL_VAR_STATIC
-				delete e;
-#else
-				e.destroy();
-#endif
-		}
-		void operator++() {i++; if(v._type==DIC) ++*e;}
-		Var& operator*() {if(v._type==ARRAY) return (*v.a)[i]; else if(v._type==DIC) return **e; else return v;}
-		String operator~() {return ~*e;}
-		operator bool() const {return i < v.length();}
-		bool operator!=(const Enumerator& e) const { return (bool)*this; }
-	};
+	struct Enumerator;
 	/** Returns an enumerator for this var's contents */
-	Enumerator all() const {return Enumerator(*this);}
+	Enumerator all() const;
 
 	friend struct Enumerator;
 
@@ -596,12 +650,77 @@ class ASL_API Var
 		StaticSpace< HDic<Var> > o;
 		StaticSpace< Array<char> > s;
 #endif
+		StaticSpace< Array<int> > ai;
+		StaticSpace< Array<float> > af;
+		StaticSpace< Array<double> > ad;
 		char ss[VAR_SSPACE];
 	};
+	Var(const char* x, int n, Arena* arena);
+	void init(Type t, Arena* arena);
 	void free();
+	void box(Arena* arena = 0);
+	void unpack();
+	bool equals(const Var& other) const;
+	void packedTo(Array<int>& b) const;
+	void packedTo(Array<float>& b) const;
+	void packedTo(Array<double>& b) const;
+	template<class T>
+	void packedTo(Array<T>& b) const
+	{
+		b.resize(length());
+		for (int i = 0; i < b.length(); i++)
+			b[i] = item(i);
+	}
 	friend class XdlEncoder;
+	friend class XdlParser;
+};
+
+struct Var::Enumerator
+{
+	Var& v;
+#ifndef ASL_VAR_STATIC
+	HDic<Var>::Enumerator* e;
+#else
+	StaticSpace< HDic<Var>::Enumerator > e;
+#endif
+	int i;
+	Var value;
+	Enumerator(const Var& x) : v(x._type == PACKED ? (*x.a)[0] : *(Var*)&x), i(0)
+	{
+		if(x._type==DIC)
+#ifndef ASL_VAR_STATIC
+			e=new HDic<Var>::Enumerator(*x.o);
+#else
+			e.construct(*x.o);
+#endif
+	}
+	~Enumerator()
+	{
+		if(v._type==DIC)
+#ifndef ASL_VAR_STATIC
+			delete e;
+#else
+			e.destroy();
+#endif
+	}
+	void operator++() {i++; if(v._type==DIC) ++*e;}
+	Var& operator*()
+	{
+		if (v._type == ARRAY) return (*v.a)[i];
+		else if (v._type == DIC) return **e;
+		else if (v._type > DIC) { value = v.item(i); return value; }
+		else return v;
+	}
+	String operator~() {return ~*e;}
+	operator bool() const {return i < v.length();}
+	bool operator!=(const Enumerator& e) const { return (bool)*this; }
 };
 
+inline Var::Enumerator Var::all() const
+{
+	return Enumerator(*this);
+}
+
 template<class T>
 Var::Var(const Array<T>& v)
 {
@@ -622,6 +741,8 @@ Var::operator Array<T>() const
 		for(int i=0; i < a2.length(); i++)
 			a2[i]=(*a)[i];
 	}
+	else if (_type > DIC)
+		packedTo(a2);
 	return a2;
 }
 
@@ -675,6 +796,8 @@ Array<T>& Array<T>::operator=(const Var& b)
 		clear();
 		return *this;
 	}
+	if (b.packedType() != Var::NONE)
+		return *this = b.operator Array<T>();
 	*this = Array<T>(b.array().with<T>());
 	return *this;
 }
@@ -12,6 +12,7 @@
 namespace asl {
 
 class Var;
+class StringBuilder;
 
 struct WebSocketMsg
 {
@@ -86,6 +87,11 @@ public:
 
 	void send(const char* m) { send(String(m)); }
 	/**
+	Sends the content of a StringBuilder as one message without joining it first (for a builder with a sink, only
+	the content not yet flushed)
+	*/
+	void send(const StringBuilder& m, FrameType type = FRAME_TEXT);
+	/**
 	Sends a Var as a text message by encoding to JSON
 	*/
 	void send(const Var& v);
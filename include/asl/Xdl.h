@@ -7,6 +7,7 @@
 #include <asl/Stack.h>
 #include <asl/Array.h>
 #include <asl/String.h>
+#include <asl/StringBuilder.h>
 #include <asl/Var.h>
 #include <asl/JSON.h>
 
@@ -46,22 +47,37 @@ class ASL_API XdlParser: public XdlCodec
 	bool _inComment;
 	int _unicodeCount;
 	char _unicode[5];
-	char _ldp;
-	void put(const Var& x);
+	Arena* _arena;
+	bool _packed;
+	Array< Array<int> > _keyOrder;
+	Array<int> _keyCount;
+	void put(Var& x);
 public:
 	XdlParser();
+	/**
+	Constructs a parser that allocates the decoded values in an arena
+	*/
+	XdlParser(Arena& arena);
 	~XdlParser();
+	/**
+	Makes arrays whose elements are all numbers be decoded as packed arrays (see Var::pack())
+	*/
+	void setPacked(bool packed) { _packed = packed; }
 	void parse(const char* s);
+	/**
+	Parses the next `n` characters of input
+	*/
+	void parse(const char* s, int n);
 	void value_end();
 	virtual void reset();
 	Var value() const;
 	Var decode(const char* s);
-	virtual void new_number(int x) { put(x); }
-	virtual void new_number(double x) { put(x); }
-	virtual void new_number(float x) { put(x); }
-	virtual void new_string(const char* x) { put(x); }
-	virtual void new_string(const String& x) { put(x); }
-	virtual void new_bool(bool b) { put(b); }
+	virtual void new_number(int x) { Var v(x); put(v); }
+	virtual void new_number(double x) { Var v(x); put(v); }
+	virtual void new_number(float x) { Var v(x); put(v); }
+	virtual void new_string(const char* x) { Var v(x, (int)strlen(x), _arena); put(v); }
+	virtual void new_string(const String& x) { Var v(*x, x.length(), _arena); put(v); }
+	virtual void new_bool(bool b) { Var v(b); put(v); }
 	virtual void begin_array();
 	virtual void end_array();
 	virtual void begin_object(const char* _class);
@@ -72,24 +88,39 @@ public:
 class ASL_API XdlEncoder: public XdlCodec
 {
 protected:
-	String _out;
+	StringBuilder _buffer;
+	StringBuilder& _out;
 	bool _pretty;
 	bool _json;
 	bool _simple;
 	Json::Mode _mode;
-	const char* _fmtF;
-	const char* _fmtD;
+	int _digitsF;
+	int _digitsD;
 	String _indent;
 	String _sep1; // between items in same line
 	String _sep2; // between items, end of line
 	int _level;
 	void _encode(const Var& v);
+	void encodePacked(const Var& v);
+	void setMode(Json::Mode mode);
 public:
 	XdlEncoder();
+	/**
+	Constructs an encoder that appends its output to the given builder
+	*/
+	XdlEncoder(StringBuilder& out);
 	~XdlEncoder() {}
-	String data() const {return _out;}
+	String data() const {return _out.string();}
+	/**
+	Returns the output written so far
+	*/
+	const StringBuilder& output() const { return _out; }
 
 	String encode(const Var& v, Json::Mode mode);
+	/**
+	Encodes `v` appending it to the current output
+	*/
+	void append(const Var& v, Json::Mode mode);
 
 	void put_separator();
 
@@ -137,10 +168,26 @@ struct ASL_API Xdl
 	*/
 	static Var decode(const String& xdl);
 
+	/**
+	Decodes XDL with options (`Json::PACKED` to decode arrays of numbers as packed arrays)
+	*/
+	static Var decode(const String& xdl, int mode);
+
+	/**
+	Decodes XDL allocating the string values and arrays of the result (and the property lists of its objects) in an
+	arena; object keys longer than 15 bytes still use the heap
+	*/
+	static Var decode(const String& xdl, Arena& arena, int mode = 0);
+
 	/**
 	Encodes the given Var into an XDL-format representation.
 	*/
 	static String encode(const Var& v, int mode = Json::SIMPLE);
+
+	/**
+	Encodes the given Var into an XDL-format representation appended to a StringBuilder.
+	*/
+	static void encode(const Var& v, StringBuilder& out, int mode = Json::SIMPLE);
 };
 
 
@@ -7,6 +7,7 @@
 #include <asl/Array.h>
 #include <asl/Map.h>
 #include <asl/String.h>
+#include <asl/StringBuilder.h>
 
 namespace asl {
 
@@ -623,6 +624,10 @@ public:
 	*/
 	static Xml decode(const String& xml);
 	/**
+	Parses the `n` characters at `xml` as XML and returns the equivalent DOM tree.
+	*/
+	static Xml decode(const char* xml, int n);
+	/**
 	Encodes the given XML document as XML, with or without formatting.
 	*/
 	static String encode(const Xml& e, bool formatted = true);
@@ -688,11 +693,20 @@ public:
 
 class ASL_API XmlCodec
 {
-	String _xml;
+	StringBuilder _buffer;
+	StringBuilder& _xml;
 	bool _formatted;
 	int _level;
 public:
-	XmlCodec()
+	XmlCodec() : _xml(_buffer)
+	{
+		_formatted = true;
+		_level = 0;
+	}
+	/**
+	Constructs a codec that appends its output to the given builder
+	*/
+	XmlCodec(StringBuilder& out) : _xml(out)
 	{
 		_formatted = true;
 		_level = 0;
@@ -700,7 +714,11 @@ public:
 
 	void setFormatted(bool on) { _formatted = on; }
 
-	const String& text() const { return _xml; }
+	String text() const { return _xml.string(); }
+	/**
+	Returns the output written so far
+	*/
+	const StringBuilder& output() const { return _xml; }
 
 	void escape(const String& s);
 
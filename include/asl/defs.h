@@ -28,6 +28,10 @@ Main definitions.
 #undef LITTLEENDIAN
 #endif
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 #if defined(_MSC_VER) && (_MSC_VER >= 1900)
 #include <cmath>
 namespace asl {
@@ -98,6 +102,10 @@ namespace asl {
 #define ASL_EXPLICIT
 #endif
 
+#if !defined(ASL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define ASL_HAVE_SSE2
+#endif
+
 #if !defined(_WIN32) || defined(ASL_STATIC)
  #define ASL_API
 #elif defined(asl_EXPORTS)
@@ -288,6 +296,24 @@ ASL_API int myltoa(Long x, char* s);
 
 ASL_API double myatof(const char* s);
 
+/**
+Parses a decimal number in [s, end), correctly rounded and independently of the C locale (the decimal separator is
+`decimal`). Leading spaces are skipped and `nan`, `inf` and `infinity` are accepted. If `next` is not null it receives
+the position after the number, or `s` if there is no number.
+*/
+ASL_API double myatof(const char* s, const char* end, const char** next = 0, char decimal = '.');
+
+/**
+Writes `x` with the fewest significant digits (at most `digits`) that read back as the same value, laid out like
+printf's `%g` but always with a '.' decimal separator. `s` needs room for 26 characters; returns the length written.
+*/
+ASL_API int myftoa(double x, char* s, int digits = 17);
+
+/**
+Writes `x` with the fewest significant digits (at most `digits`) that read back as the same float
+*/
+ASL_API int myftoa(float x, char* s, int digits = 9);
+
 ASL_API int myitoa(int x, char* s);
 
 inline bool myisspace(char c)
@@ -333,6 +359,30 @@ inline T max(T a, T b) {if(a>b) return a; else return b;}
 template <class T>
 inline T min(T a, T b) {if(a<b) return a; else return b;}
 
+/** Returns the number of trailing zero bits of `x`, which must be non-zero */
+inline int trailingZeros(unsigned x)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward(&i, x);
+	return (int)i;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+/** Returns the index of the highest set bit of `x`, which must be non-zero */
+inline int highestBit(unsigned x)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanReverse(&i, x);
+	return (int)i;
+#else
+	return 31 - __builtin_clz(x);
+#endif
+}
+
 template <class T>
 inline void vswap(T& a, T& b) {T A=a; a=b; b=A;}
 
@@ -12,11 +12,18 @@ namespace asl {
 template<class T, int N>
 class Array_;
 
+class StringBuilder;
+
 /**
 \defgroup Global Global functions
 @{
 */
 
+/**
+Decodes a base64 encoded string of `n` chars (or up to a null char if `n` is -1) into a byte array. The string can
+contain whitespace, use the standard or the URL-safe alphabet, and omit the final padding. Invalid input gives an
+empty array.
+*/
 ASL_API Array<byte> decodeBase64(const char* src, int n = -1);
 
 /**
@@ -49,6 +56,19 @@ inline String encodeBase64(const String& s)
 template<int N>
 String encodeBase64(const Array_<byte,N>& src) { return encodeBase64((const byte*)src, N); }
 
+/**
+Encodes bytes using the URL-safe base64 alphabet (with `-` and `_`) and no padding, as used in URLs and JWT tokens
+*/
+ASL_API String encodeBase64Url(const byte* data, int n);
+
+/**
+Encodes a byte array using the URL-safe base64 alphabet and no padding
+*/
+inline String encodeBase64Url(const Array<byte>& s)
+{
+	return encodeBase64Url(s.ptr(), s.length());
+}
+
 ASL_API String encodeHex(const byte* data, int n);
 
 /**
@@ -59,10 +79,87 @@ inline String encodeHex(const Array<byte>& src) { return encodeHex(src.ptr(), sr
 template<int N>
 String encodeHex(const Array_<byte, N>& src) { return encodeHex((const byte*)src, N); }
 
+/**
+Decodes a hexadecimal encoded string of `n` chars (or up to a null char if `n` is -1) into a byte array; invalid input
+gives an empty array
+*/
+ASL_API Array<byte> decodeHex(const char* src, int n = -1);
+
 /**
 Decodes a hexadecimal encoded string into a byte array
 */
-ASL_API Array<byte> decodeHex(const String& src);
+inline Array<byte> decodeHex(const String& src) { return decodeHex(*src, src.length()); }
+
+/**
+Encodes data in base64 incrementally, so that large content can be encoded as it is read, without holding it all.
+The encoded text is appended to a StringBuilder, which can in turn write it to a File or Socket as it grows:
+
+~~~
+File file("image.png", File::READ);
+StringBuilder out(socket);
+Base64Encoder encoder;
+byte buffer[65536];
+int n;
+while ((n = file.read(buffer, sizeof(buffer))) > 0)
+	encoder.encode(buffer, n, out);
+encoder.finish(out);
+~~~
+*/
+class ASL_API Base64Encoder
+{
+public:
+	/**
+	Constructs an encoder using the standard alphabet, or the URL-safe one with no padding if `url` is true
+	*/
+	ASL_EXPLICIT Base64Encoder(bool url = false);
+	/**
+	Encodes `n` bytes appending to `out` all complete groups (up to 2 bytes are kept for the next call)
+	*/
+	void encode(const byte* data, int n, StringBuilder& out);
+	/**
+	Encodes the remaining bytes with padding, after which the encoder can be reused
+	*/
+	void finish(StringBuilder& out);
+private:
+	byte _rest[3];
+	int _n;
+	bool _url;
+};
+
+/**
+Decodes base64 incrementally (in chunks of any size, e.g. as received from a socket), appending the decoded bytes to an
+array. Like decodeBase64(), it accepts whitespace and both alphabets, and it reports invalid input.
+
+~~~
+Base64Decoder decoder;
+Array<byte> data;
+while (...)
+	if (!decoder.decode(chunk, n, data))
+		break;
+bool ok = decoder.finish(data);
+~~~
+*/
+class ASL_API Base64Decoder
+{
+public:
+	Base64Decoder();
+	/**
+	Decodes `n` chars appending the complete bytes to `out`; returns false if invalid input was found
+	*/
+	bool decode(const char* src, int n, Array<byte>& out);
+	/**
+	Appends the last bytes and returns true if the whole input was valid; after this the decoder can be reused
+	*/
+	bool finish(Array<byte>& out);
+	/**
+	Returns true if invalid input was found
+	*/
+	bool error() const { return _error; }
+private:
+	byte _k[4];
+	int _n, _pad;
+	bool _error;
+};
 
 /**@}*/
 
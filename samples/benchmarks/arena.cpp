@@ -0,0 +1,51 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Decodes a JSON array of records (objects with strings, numbers and nested arrays and objects) normally and with an
+Arena, and reports the time to decode and the time to release the result in each case.
+
+Usage: bench-arena [count]
+*/
+
+using namespace asl;
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 100000;
+	Var doc = Var(Var::ARRAY);
+	for (int i = 0; i < n; i++)
+		doc << Var("id", i)("name", String(0, "item number %i", i))("x", i * 0.37)("tags", array<Var>("alpha", "b"))
+			("ok", true)("nested", Var("k", String(0, "some longer text value %i", i)));
+	String json = Json::encode(doc);
+	doc = Var();
+	printf("%.1f MB\n\n%-8s %12s %12s\n", json.length() / 1e6, "", "decode ms", "free ms");
+
+	double td[2] = { 1e9, 1e9 }, tf[2] = { 1e9, 1e9 };
+	for (int k = 0; k < 5; k++)
+	{
+		double t1 = now();
+		Var* v = new Var(Json::decode(json));
+		double t2 = now();
+		delete v;
+		double t3 = now();
+		td[0] = min(td[0], t2 - t1);
+		tf[0] = min(tf[0], t3 - t2);
+
+		t1 = now();
+		Arena* arena = new Arena;
+		v = new Var(Json::decode(json, *arena));
+		t2 = now();
+		delete v;
+		delete arena;
+		t3 = now();
+		td[1] = min(td[1], t2 - t1);
+		tf[1] = min(tf[1], t3 - t2);
+	}
+	printf("%-8s %12.1f %12.1f\n", "heap", td[0] * 1e3, tf[0] * 1e3);
+	printf("%-8s %12.1f %12.1f\n", "arena", td[1] * 1e3, tf[1] * 1e3);
+	return 0;
+}
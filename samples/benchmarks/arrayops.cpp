@@ -0,0 +1,85 @@
+#include <asl/Array2.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares the array kernels in asl::ops with the plain loops users would write, for each element type.
+Results are in millions of elements per second.
+
+Usage: bench-arrayops [length]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+template<class T, class K>
+void bench(const char* type, int n)
+{
+	typedef typename ArrayOpTraits<T>::Sum S;
+	Array<T> a(n), b(n), c(n);
+	Array<K> k(n);
+	for (int i = 0; i < n; i++)
+	{
+		a[i] = T(i % 200 + 1);
+		b[i] = T(i % 17);
+	}
+	T lo = T(10), hi = T(100), s = T(3);
+	printf("\n%s\n%-10s %10s %10s %8s\n", type, "op", "loop", "ops", "speedup");
+	double r0, r1;
+	const T* pa = a.ptr(), *pb = b.ptr();
+	T* pc = c.ptr();
+
+#define ROW(name) printf("%-10s %10.0f %10.0f %7.1fx\n", name, r0, r1, r1 / r0)
+	r0 = rate(n, [&]() { S t = 0; for (int i = 0; i < n; i++) t += pa[i]; sink = (double)t; });
+	r1 = rate(n, [&]() { sink = (double)ops::sum(a); });
+	ROW("sum");
+	r0 = rate(n, [&]() { S t = 0; for (int i = 0; i < n; i++) t += (S)pa[i] * pb[i]; sink = (double)t; });
+	r1 = rate(n, [&]() { sink = (double)ops::dot(a, b); });
+	ROW("dot");
+	r0 = rate(n, [&]() { T l = pa[0], h = pa[0]; for (int i = 1; i < n; i++) { if (pa[i] < l) l = pa[i]; if (pa[i] > h) h = pa[i]; } sink = l + h; });
+	r1 = rate(n, [&]() { T l, h; ops::minmax(pa, n, l, h); sink = l + h; });
+	ROW("minmax");
+	r0 = rate(n, [&]() { for (int i = 0; i < n; i++) pc[i] = T(pa[i] * s); });
+	r1 = rate(n, [&]() { ops::scale(pa, s, pc, n); });
+	ROW("scale");
+	r0 = rate(n, [&]() { for (int i = 0; i < n; i++) pc[i] = T(pa[i] + pb[i]); });
+	r1 = rate(n, [&]() { ops::add(pa, pb, pc, n); });
+	ROW("add");
+	r0 = rate(n, [&]() { for (int i = 0; i < n; i++) pc[i] = T(pa[i] * pb[i]); });
+	r1 = rate(n, [&]() { ops::multiply(pa, pb, pc, n); });
+	ROW("multiply");
+	r0 = rate(n, [&]() { for (int i = 0; i < n; i++) pc[i] = clamp(pa[i], lo, hi); });
+	r1 = rate(n, [&]() { ops::clamp(pa, lo, hi, pc, n); });
+	ROW("clamp");
+	K* pk = k.ptr();
+	r0 = rate(n, [&]() { for (int i = 0; i < n; i++) pk[i] = (K)pa[i]; });
+	r1 = rate(n, [&]() { ops::convert(pa, pk, n); });
+	ROW("convert");
+	int w = 1024, h = n / w;
+	r0 = rate(w * h, [&]() { for (int i = 0; i < h; i++) for (int j = 0; j < w; j++) pc[j * h + i] = pa[i * w + j]; });
+	r1 = rate(w * h, [&]() { ops::transpose(pa, h, w, pc); });
+	ROW("transpose");
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	bench<float, int>("float (convert to int)", n);
+	bench<double, float>("double (convert to float)", n);
+	bench<int, float>("int (convert to float)", n);
+	bench<byte, float>("byte (convert to float)", n);
+	return 0;
+}
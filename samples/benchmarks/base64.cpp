@@ -0,0 +1,71 @@
+#include <asl/util.h>
+#include <asl/StringBuilder.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Encodes and decodes a block of random bytes in base64 (standard and URL-safe), base64 with line breaks, and hex, and
+also with the streaming base64 encoder in small chunks. Reports the speed in MB/s of binary data.
+
+Usage: bench-base64 [size_in_MB]
+*/
+
+using namespace asl;
+
+template<class F>
+static double bestOf(int runs, F f)
+{
+	double t = 1e9;
+	for (int k = 0; k < runs; k++)
+	{
+		double t1 = now();
+		f();
+		t = min(t, now() - t1);
+	}
+	return t;
+}
+
+static double mb;
+
+template<class F>
+static void run(const char* name, F f)
+{
+	printf("%-14s %8.0f MB/s\n", name, mb / bestOf(5, f));
+}
+
+int main(int argc, char* argv[])
+{
+	int n = (argc > 1 ? atoi(argv[1]) : 16) << 20;
+	Array<byte> data(n), out;
+	for (int i = 0; i < n; i++)
+		data[i] = byte(rand());
+	mb = n / 1048576.0;
+
+	String b64, url, lines, hex;
+	bool ok = true;
+
+	run("encode", [&]() { b64 = encodeBase64(data); });
+	run("decode", [&]() { out = decodeBase64(b64); });
+	ok = ok && out == data;
+	run("encode url", [&]() { url = encodeBase64Url(data); });
+	run("decode url", [&]() { out = decodeBase64(url); });
+	ok = ok && out == data;
+	for (int i = 0; i < b64.length(); i += 76)
+		lines << b64.substring(i, min(i + 76, b64.length())) << "\r\n";
+	run("decode lines", [&]() { out = decodeBase64(lines); });
+	ok = ok && out == data;
+	run("stream encode", [&]() {
+		StringBuilder sb;
+		Base64Encoder encoder;
+		for (int i = 0; i < n; i += 1000)
+			encoder.encode(data.ptr() + i, min(1000, n - i), sb);
+		encoder.finish(sb);
+	});
+	run("hex encode", [&]() { hex = encodeHex(data); });
+	run("hex decode", [&]() { out = decodeHex(hex); });
+	ok = ok && out == data;
+	if (!ok)
+		printf("error: wrong result\n");
+	return ok ? 0 : 1;
+}
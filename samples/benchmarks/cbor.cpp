@@ -0,0 +1,67 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/Cbor.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Compares encoding and decoding a document with JSON and CBOR: a list of records with mixed fields (strings, ints,
+doubles) and a large array of floats, which CBOR stores as a raw typed array. Results are in MB of Var data per second
+(measured as the JSON size) and the encoded sizes.
+
+Usage: bench-cbor [count]
+*/
+
+using namespace asl;
+
+template<class F>
+double timeit(F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.3);
+	return (t2 - t1) / count;
+}
+
+volatile int sink;
+
+void run(const char* name, const Var& v)
+{
+	String json = Json::encode(v);
+	Array<byte> cbor = Cbor::encode(v);
+	double mb = json.length() / 1e6;
+
+	double te1 = timeit([&]() { sink = Json::encode(v).length(); });
+	double te2 = timeit([&]() { sink = Cbor::encode(v).length(); });
+	double td1 = timeit([&]() { sink = Json::decode(json).length(); });
+	double td2 = timeit([&]() { sink = Cbor::decode(cbor).length(); });
+
+	printf("%-10s %9s %9.1f %9.1f %11.1f %11.1f\n", name, "JSON", json.length() / 1e3, 1.0, mb / te1, mb / td1);
+	printf("%-10s %9s %9.1f %9.2f %11.1f %11.1f\n", "", "CBOR", cbor.length() / 1e3, (double)cbor.length() / json.length(),
+		mb / te2, mb / td2);
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 20000;
+	Random rnd(false);
+
+	Var records = Var(Var::ARRAY);
+	for (int i = 0; i < n / 10; i++)
+		records << Var("id", i)("name", String(0, "item-%i", i))("price", rnd(0.0, 100.0))("count", (int)rnd(1000.0))
+			("tags", array<Var>("a", "bcd"))("active", i % 2 == 0);
+
+	Array<float> values(n);
+	for (int i = 0; i < n; i++)
+		values[i] = (float)rnd(-1000.0, 1000.0);
+	Var points = Var("points", values);
+
+	printf("%-10s %9s %9s %9s %11s %11s\n", "", "format", "size KB", "ratio", "encode MB/s", "decode MB/s");
+	run("records", records);
+	run("floats", points);
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include <asl/Matrix.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Measures elementwise expressions on large matrices: C = A * s + B - D evaluated with the regular operators (which
+create a temporary per operation), with a lazy expression into a new matrix and assigned in place.
+
+Usage: bench-elementwise [size]
+*/
+
+using namespace asl;
+
+template<class T>
+Matrix_<T> randomMatrix(int m, int n)
+{
+	Matrix_<T> a(m, n);
+	for (int i = 0; i < a.length(); i++)
+		a[i] = (T)asl::random(-1.0, 1.0);
+	return a;
+}
+
+template<class F>
+double timeit(F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.5);
+	return (t2 - t1) / count * 1e3;
+}
+
+template<class T>
+void bench(const char* type, int n)
+{
+	Matrix_<T> a = randomMatrix<T>(n, n), b = randomMatrix<T>(n, n), d = randomMatrix<T>(n, n), c(n, n);
+	T s = T(0.75);
+	double t0 = timeit([&]() { c = a * s + b - d; });
+	double t1 = timeit([&]() { c = lazy(a) * s + b - d; });
+	double t2 = timeit([&]() { c.assign(lazy(a) * s + b - d); });
+	double t3 = timeit([&]() { c.assign(lazy(b) - d); c.axpy(s, a); });
+	printf("%-8s %10.2f %10.2f %10.2f %10.2f\n", type, t0, t1, t2, t3);
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 2000;
+	printf("C = A * s + B - D, %i x %i (ms)\n%-8s %10s %10s %10s %10s\n", n, n, "type", "operators", "lazy", "assign",
+		"axpy");
+	bench<float>("float", n);
+	bench<double>("double", n);
+	return 0;
+}
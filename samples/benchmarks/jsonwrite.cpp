@@ -0,0 +1,65 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/TextFile.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+/*
+Writes a large JSON document to a file in two ways: encoding it first into a String and writing that (the way
+Json::write worked before), and streaming it through a StringBuilder attached to the file, which is what Json::write
+does now. Reports throughput and the growth of the peak memory (resident set) of the process for each.
+
+The document is an array of arrays that all share the same objects, so it takes little memory itself.
+
+Usage: bench-jsonwrite [size in MB] [file]
+*/
+
+using namespace asl;
+
+double peakMB()
+{
+#ifndef _WIN32
+	rusage r;
+	getrusage(RUSAGE_SELF, &r);
+	return r.ru_maxrss / 1024.0;
+#else
+	return 0;
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	int mb = argc > 1 ? atoi(argv[1]) : 256;
+	String path = argc > 2 ? argv[2] : "bench-jsonwrite.json";
+
+	Var row = Var(Var::ARRAY);
+	for (int i = 0; i < 1000; i++)
+		row << Var("id", i)("name", String(0, "item %i", i))("x", i * 0.37)("v", Var(Var::ARRAY) << 1.5 << i << "z");
+	int rowSize = Json::encode(row).length();
+	Var doc = Var(Var::ARRAY);
+	for (Long size = 0; size < (Long)mb << 20; size += rowSize + 1)
+		doc << row;
+
+	printf("%-22s %10s %12s\n", "", "MB/s", "peak +MB");
+
+	double m0 = peakMB();
+	double t1 = now();
+	Json::write(path, doc, Json::NONE);
+	double t2 = now();
+	double m1 = peakMB();
+	double size = (double)File(path).size() / (1 << 20);
+	printf("%-22s %10.1f %12.1f\n", "streaming Json::write", size / (t2 - t1), m1 - m0);
+
+	t1 = now();
+	TextFile(path).put(Json::encode(doc, Json::NONE));
+	t2 = now();
+	double m2 = peakMB();
+	printf("%-22s %10.1f %12.1f\n", "encode + put", size / (t2 - t1), m2 - m1);
+	printf("document: %.1f MB\n", size);
+	File(path).remove();
+	return 0;
+}
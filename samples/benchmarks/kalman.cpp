@@ -0,0 +1,89 @@
+#include <asl/MatrixN.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares a Kalman filter (3D constant-velocity model: 6 states, 3 position measurements) written with dynamic
+Matrixd and with fixed-size MatrixN_ matrices. The code of both is identical apart from the matrix types.
+
+Usage: bench-kalman [steps]
+*/
+
+using namespace asl;
+
+template<class M6, class M3, class M36, class M63, class V6, class V3>
+struct Kalman
+{
+	M6 F, Q, P;
+	M3 R;
+	M36 H;
+	V6 x;
+
+	Kalman(double dt) : F(M6::identity()), Q(M6::identity() * 1e-3), P(M6::identity()), R(M3::identity() * 0.05),
+		H(M36::identity()), x(V6::identity() * 0.0)
+	{
+		for (int i = 0; i < 3; i++)
+			F(i, i + 3) = dt;
+	}
+
+	void step(const V3& z)
+	{
+		x = F * x;
+		P = F * P * F.transposed() + Q;
+		V3 y = z - H * x;
+		M3 S = H * P * H.transposed() + R;
+		M63 K = P * H.transposed() * S.inverse();
+		x = x + K * y;
+		P = (M6::identity() - K * H) * P;
+	}
+};
+
+// Wraps Matrixd to give it the fixed-size interface (construction and identity without a size)
+
+template<int R, int C>
+struct Dyn : public Matrixd
+{
+	Dyn() : Matrixd(R, C) {}
+	Dyn(const Matrixd& m) : Matrixd(m) {}
+	static Dyn identity()
+	{
+		Dyn I;
+		for (int i = 0; i < R; i++)
+			for (int j = 0; j < C; j++)
+				I(i, j) = i == j ? 1.0 : 0.0;
+		return I;
+	}
+};
+
+typedef Kalman<Dyn<6, 6>, Dyn<3, 3>, Dyn<3, 6>, Dyn<6, 3>, Dyn<6, 1>, Dyn<3, 1> > DynamicKalman;
+typedef Kalman<MatrixN_<double, 6>, MatrixN_<double, 3>, MatrixN_<double, 3, 6>, MatrixN_<double, 6, 3>,
+	MatrixN_<double, 6, 1>, MatrixN_<double, 3, 1> > FixedKalman;
+
+template<class K, class V3>
+double run(K& kf, int steps)
+{
+	V3 z;
+	double t1 = now();
+	for (int i = 0; i < steps; i++)
+	{
+		double t = i * 0.01;
+		z(0, 0) = t;
+		z(1, 0) = sin(t);
+		z(2, 0) = 0.5 * t * t;
+		kf.step(z);
+	}
+	return (now() - t1) / steps * 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+	int steps = argc > 1 ? atoi(argv[1]) : 200000;
+	DynamicKalman kd(0.01);
+	FixedKalman kf(0.01);
+	double td = run<DynamicKalman, Dyn<3, 1> >(kd, steps);
+	double tf = run<FixedKalman, MatrixN_<double, 3, 1> >(kf, steps);
+	printf("Kalman filter step (ns)\n%10s %10s %10s\n%10.1f %10.1f %9.1fx\n", "Matrixd", "MatrixN_", "speedup",
+		td, tf, td / tf);
+	printf("state difference: %g\n", (kd.x - kf.x.matrix()).norm());
+	return 0;
+}
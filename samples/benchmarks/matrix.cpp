@@ -0,0 +1,73 @@
+#include <asl/Matrix.h>
+#include <asl/Thread.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Measures the speed of matrix products (GFLOP/s) of the Matrix_ class compared to a naive triple loop,
+which is how operator* used to be implemented.
+
+Usage: bench-matrix [max_size]
+*/
+
+using namespace asl;
+
+template<class T>
+Matrix_<T> naiveProduct(const Matrix_<T>& a, const Matrix_<T>& b)
+{
+	Matrix_<T> c(a.rows(), b.cols());
+	for (int i = 0; i < c.rows(); i++)
+		for (int j = 0; j < c.cols(); j++)
+		{
+			c(i, j) = 0;
+			for (int k = 0; k < a.cols(); k++)
+				c(i, j) += a(i, k) * b(k, j);
+		}
+	return c;
+}
+
+template<class T>
+Matrix_<T> randomMatrix(int m, int n)
+{
+	Matrix_<T> a(m, n);
+	for (int i = 0; i < a.length(); i++)
+		a[i] = (T)asl::random(-1.0, 1.0);
+	return a;
+}
+
+// Runs f repeatedly for at least 0.5 s and returns the GFLOP/s of an n x n product
+
+template<class F>
+double gflops(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.5);
+	return 2.0 * n * n * n * count / (t2 - t1) * 1e-9;
+}
+
+template<class T>
+void bench(const char* type, int maxSize)
+{
+	int nth = Thread::numProcessors();
+	printf("\n%s (%i threads available)\n%6s %10s %10s %10s\n", type, nth, "size", "naive", "blocked", "threaded");
+	for (int n = 100; n <= maxSize; n *= 2)
+	{
+		Matrix_<T> a = randomMatrix<T>(n, n), b = randomMatrix<T>(n, n), c;
+		double g0 = n <= 800 ? gflops(n, [&]() { c = naiveProduct(a, b); }) : 0;
+		double g1 = gflops(n, [&]() { c = a * b; });
+		double g2 = gflops(n, [&]() { c = a.multiply(b, nth); });
+		printf("%6i %10.2f %10.2f %10.2f\n", n, g0, g1, g2);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int maxSize = argc > 1 ? atoi(argv[1]) : 1600;
+	bench<float>("float", maxSize);
+	bench<double>("double", maxSize);
+	return 0;
+}
@@ -0,0 +1,95 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Compares number formatting and parsing with the C library (sprintf with %.17g / %.9g and strtod) and with myftoa and
+myatof, which give the shortest round-trip text and correctly rounded values independently of the locale. Also
+measures encoding and decoding a JSON array of doubles. Results are in millions of numbers per second.
+
+Usage: bench-numbers [count]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 100000;
+	Random rnd(false);
+	Array<double> values(n);
+	Array<String> texts(n);
+	Var list = Var(Var::ARRAY);
+	for (int i = 0; i < n; i++)
+	{
+		values[i] = i % 3 == 0 ? rnd(-1000.0, 1000.0) : i % 3 == 1 ? (int)rnd(100000.0) / 100.0 : rnd(1e-5) * 1e10;
+		texts[i] = String(0, "%.17g", values[i]);
+		list << values[i];
+	}
+
+	printf("%-16s %10s %10s %8s\n", "Mnumbers/s", "libc", "asl", "speedup");
+
+	char s[40];
+	double r1 = rate(n, [&]() {
+		int k = 0;
+		for (int i = 0; i < n; i++)
+			k += sprintf(s, "%.17g", values[i]);
+		sink = k;
+	});
+	double r2 = rate(n, [&]() {
+		int k = 0;
+		for (int i = 0; i < n; i++)
+			k += myftoa(values[i], s);
+		sink = k;
+	});
+	printf("%-16s %10.2f %10.2f %7.1fx\n", "format double", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() {
+		int k = 0;
+		for (int i = 0; i < n; i++)
+			k += sprintf(s, "%.9g", (float)values[i]);
+		sink = k;
+	});
+	r2 = rate(n, [&]() {
+		int k = 0;
+		for (int i = 0; i < n; i++)
+			k += myftoa((float)values[i], s);
+		sink = k;
+	});
+	printf("%-16s %10.2f %10.2f %7.1fx\n", "format float", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() {
+		double y = 0;
+		for (int i = 0; i < n; i++)
+			y += strtod(texts[i], 0);
+		sink = y;
+	});
+	r2 = rate(n, [&]() {
+		double y = 0;
+		for (int i = 0; i < n; i++)
+			y += myatof(texts[i]);
+		sink = y;
+	});
+	printf("%-16s %10.2f %10.2f %7.1fx\n", "parse double", r1, r2, r2 / r1);
+
+	String json = Json::encode(list);
+	double r3 = rate(n, [&]() { sink = Json::encode(list).length(); });
+	double r4 = rate(n, [&]() { sink = Json::decode(json).length(); });
+	printf("\nJSON array of %i doubles: encode %.2f, decode %.2f Mnumbers/s\n", n, r3, r4);
+	return 0;
+}
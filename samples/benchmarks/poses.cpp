@@ -0,0 +1,70 @@
+#include <asl/Pose.h>
+#include <asl/Array.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares the batch quaternion and pose functions (Quaternion_::slerp(), Pose_::compose(), Pose_::invert() and
+Pose_::interpolate() on arrays) with loops calling the single-object versions. Results are in millions of
+operations per second.
+
+Usage: bench-poses [count] [threads]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+template<class T>
+void bench(const char* type, int n, int nthreads)
+{
+	Array<Quaternion_<T> > qa(n), qb(n), q(n);
+	Array<Pose_<T> > pa(n), pb(n), p(n);
+	Array<T> t(n);
+	for (int i = 0; i < n; i++)
+	{
+		qa[i] = Quaternion_<T>::fromAxisAngle(Vec3_<T>(T(sin(i * 0.3)), T(cos(i * 0.7)), 1), T(i * 0.01));
+		qb[i] = Quaternion_<T>::fromAxisAngle(Vec3_<T>(1, T(0.5), T(sin(i * 0.2))), T(i * 0.03));
+		pa[i] = Pose_<T>(Vec3_<T>(T(i * 0.01), 1, 2), qa[i]);
+		pb[i] = Pose_<T>(Vec3_<T>(1, T(i * 0.02), 0), qb[i]);
+		t[i] = T((i % 100) * 0.01);
+	}
+	printf("\n%s\n%-12s %10s %10s %8s\n", type, "op", "loop", "batch", "speedup");
+
+	double r1 = rate(n, [&]() { for (int i = 0; i < n; i++) q[i] = qa[i].slerp(qb[i], t[i]); sink = q[0].w; });
+	double r2 = rate(n, [&]() { Quaternion_<T>::slerp(qa.ptr(), qb.ptr(), t.ptr(), q.ptr(), n, nthreads); sink = q[0].w; });
+	printf("%-12s %10.1f %10.1f %7.1fx\n", "slerp", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { for (int i = 0; i < n; i++) p[i] = pa[i] * pb[i]; sink = p[0].position().x; });
+	r2 = rate(n, [&]() { Pose_<T>::compose(pa.ptr(), pb.ptr(), p.ptr(), n, nthreads); sink = p[0].position().x; });
+	printf("%-12s %10.1f %10.1f %7.1fx\n", "compose", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { for (int i = 0; i < n; i++) p[i] = pa[i].inverse(); sink = p[0].position().x; });
+	r2 = rate(n, [&]() { Pose_<T>::invert(pa.ptr(), p.ptr(), n, nthreads); sink = p[0].position().x; });
+	printf("%-12s %10.1f %10.1f %7.1fx\n", "invert", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { for (int i = 0; i < n; i++) p[i] = pa[i].interpolate(pb[i], t[i]); sink = p[0].position().x; });
+	r2 = rate(n, [&]() { Pose_<T>::interpolate(pa.ptr(), pb.ptr(), t.ptr(), p.ptr(), n, nthreads); sink = p[0].position().x; });
+	printf("%-12s %10.1f %10.1f %7.1fx\n", "interpolate", r1, r2, r2 / r1);
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 10000;
+	int nthreads = argc > 2 ? atoi(argv[2]) : 1;
+	bench<float>("float", n, nthreads);
+	bench<double>("double", n, nthreads);
+	return 0;
+}
@@ -0,0 +1,131 @@
+#include <asl/Matrix.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares the speed and accuracy of the LU, Cholesky and QR decompositions used by solve(), inverse() and
+pseudoinverse() with the previous implementation (Gaussian elimination repeated for each right-hand side and
+a pseudoinverse through the normal equations).
+
+Usage: bench-solve [max_size]
+*/
+
+using namespace asl;
+
+// Previous solver, which eliminates A again for each column of b
+
+Matrixd oldSolve(const Matrixd& A_, const Matrixd& b_)
+{
+	Matrixd x(b_.rows(), b_.cols());
+	int n = A_.rows();
+	Array<int> _(n);
+	Matrixd A = A_.clone();
+	Matrixd b = b_.clone();
+	for (int j = 0; j < b_.cols(); j++)
+	{
+		if (j > 0)
+			A.copy(A_);
+		for (int i = 0; i < n; i++)
+			_[i] = i;
+		for (int k = 0; k < n - 1; k++)
+		{
+			double max = 0;
+			int ipivot = 0;
+			for (int i = k; i < n; i++)
+			{
+				if (max < fabs(A(_[i], k))) {
+					max = fabs(A(_[i], k));
+					ipivot = i;
+				}
+			}
+			swap(_[k], _[ipivot]);
+			for (int i = k + 1; i < n; i++)
+			{
+				int ii = _[i], kk = _[k];
+				double f = -A(ii, k) / A(kk, k);
+				for (int jj = k; jj < n; jj++)
+					A(ii, jj) += A(kk, jj) * f;
+				b(ii, j) += b(kk, j) * f;
+			}
+		}
+		for (int k = n - 1; k >= 0; k--)
+		{
+			double sum = 0;
+			int kk = _[k];
+			for (int i = k + 1; i < n; i++)
+				sum += A(kk, i) * x(i, j);
+			x(k, j) = (b(kk, j) - sum) / A(kk, k);
+		}
+	}
+	return x;
+}
+
+Matrixd oldPseudoinverse(const Matrixd& A)
+{
+	Matrixd aT = A.transposed();
+	return oldSolve(aT * A, Matrixd::identity(A.cols())) * aT;
+}
+
+Matrixd randomMatrix(int m, int n)
+{
+	Matrixd a(m, n);
+	for (int i = 0; i < a.length(); i++)
+		a[i] = asl::random(-1.0, 1.0);
+	return a;
+}
+
+template<class F>
+double timeit(F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.3);
+	return (t2 - t1) / count * 1e3;
+}
+
+int main(int argc, char* argv[])
+{
+	int maxSize = argc > 1 ? atoi(argv[1]) : 800;
+
+	printf("Inverse of n x n matrix (ms)\n%6s %10s %10s %10s %12s\n", "n", "old", "LU", "Cholesky", "residual");
+	for (int n = 50; n <= maxSize; n *= 2)
+	{
+		Matrixd A = randomMatrix(n, n), S = A * A.transposed() + Matrixd::identity(n), X;
+		Matrixd I = Matrixd::identity(n);
+		double t0 = n <= 400 ? timeit([&]() { X = oldSolve(A, I); }) : 0;
+		double t1 = timeit([&]() { X = LU<double>(A).inverse(); });
+		double t2 = timeit([&]() { X = Cholesky<double>(S).inverse(); });
+		printf("%6i %10.2f %10.2f %10.2f %12.3g\n", n, t0, t1, t2, (A * LU<double>(A).inverse() - I).norm());
+	}
+
+	printf("\nSolve with 1 right-hand side (ms)\n%6s %10s %10s %10s\n", "n", "old", "LU", "QR");
+	for (int n = 50; n <= maxSize; n *= 2)
+	{
+		Matrixd A = randomMatrix(n, n), b = randomMatrix(n, 1), x;
+		double t0 = timeit([&]() { x = oldSolve(A, b); });
+		double t1 = timeit([&]() { x = solve(A, b); });
+		double t2 = timeit([&]() { x = QR<double>(A).solve(b); });
+		printf("%6i %10.2f %10.2f %10.2f\n", n, t0, t1, t2);
+	}
+
+	// Polynomial fit with a Vandermonde matrix, which is badly conditioned
+	printf("\nLeast-squares fit error of a degree d polynomial (200 points)\n%6s %14s %14s\n", "d", "normal eqs", "QR");
+	for (int d = 4; d <= 14; d += 2)
+	{
+		int m = 200;
+		Matrixd V(m, d + 1), c(d + 1, 1), y;
+		for (int j = 0; j <= d; j++)
+			c[j] = 1.0 / (j + 1);
+		for (int i = 0; i < m; i++)
+			for (int j = 0; j <= d; j++)
+				V(i, j) = pow(i / double(m - 1), j);
+		y = V * c;
+		double e0 = (oldPseudoinverse(V) * y - c).norm();
+		double e1 = (V.pseudoinverse() * y - c).norm();
+		printf("%6i %14.3g %14.3g\n", d, e0, e1);
+	}
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include <asl/String.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares parsing text with String functions, which copy each substring to a new String, and with StringView
+functions, which only point into the original text. Results are in millions of lines per second.
+
+Usage: bench-strings [lines]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 20000;
+	Array<String> csv(n), headers(n);
+	const char* names[] = { "Content-Type", "Content-Length", "Accept-Encoding", "User-Agent", "Cache-Control" };
+	const char* values[] = { "text/html; charset=utf-8", "1234", "gzip, deflate, br", "Mozilla/5.0 (X11; Linux x86_64)",
+		"no-cache" };
+	for (int i = 0; i < n; i++)
+	{
+		csv[i] = String::f("%i,sensor_%i,%.3f,%.5f,%s,%i", i, i % 17, i * 0.25, i * -1e-3, i % 2 ? "ok" : "failed", i % 100);
+		headers[i] = String::f("%s: %s\r", names[i % 5], values[i % 5]);
+	}
+
+	printf("%-16s %10s %10s %8s\n", "Mlines/s", "String", "StringView", "speedup");
+
+	Array<String> parts;
+	Array<StringView> views;
+	double r1 = rate(n, [&]() {
+		double s = 0;
+		for (int i = 0; i < n; i++)
+		{
+			csv[i].split(",", parts);
+			s += parts[2].toDouble() + parts[5].toInt() + parts[1].length();
+		}
+		sink = s;
+	});
+	double r2 = rate(n, [&]() {
+		double s = 0;
+		for (int i = 0; i < n; i++)
+		{
+			csv[i].splitViews(",", views);
+			s += views[2].toDouble() + views[5].toInt() + views[1].length();
+		}
+		sink = s;
+	});
+	printf("%-16s %10.2f %10.2f %7.1fx\n", "CSV split", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() {
+		int s = 0;
+		for (int i = 0; i < n; i++)
+		{
+			String line = headers[i].trimmed();
+			int j = line.indexOf(':');
+			String name = line.substring(0, j), value = line.substring(j + 1).trimmed();
+			s += name.length() + value.length() + (name.equalsNocase("content-length") ? value.toInt() : 0);
+		}
+		sink = s;
+	});
+	r2 = rate(n, [&]() {
+		int s = 0;
+		for (int i = 0; i < n; i++)
+		{
+			StringView line = headers[i].trimmedView();
+			int j = line.indexOf(':');
+			StringView name = line.substring(0, j), value = line.substring(j + 1).trimmed();
+			s += name.length() + value.length() + (name.equalsNocase("content-length") ? value.toInt() : 0);
+		}
+		sink = s;
+	});
+	printf("%-16s %10.2f %10.2f %7.1fx\n", "HTTP headers", r1, r2, r2 / r1);
+	return 0;
+}
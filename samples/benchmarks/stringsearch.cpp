@@ -0,0 +1,103 @@
+#include <asl/String.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+Compares String search, replace and case conversion with the way they worked before (strstr, a forward loop of
+searches for lastIndexOf, replace by appending substrings, and per byte case conversion). Results are in MB/s. The first lastIndexOf searches a word found only at the start; the
+one marked (*) searches a word that appears everywhere.
+
+Usage: bench-stringsearch [length]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+static int oldLastIndexOf(const String& s, const char* a)
+{
+	int i = 0, j = -1;
+	const char* p;
+	const char* volatile hay = *s;
+	while ((p = strstr(hay + i, a)) != 0)
+	{
+		j = int(p - *s);
+		i = j + 1;
+	}
+	return j;
+}
+
+static String oldReplace(const String& s, const String& a, const String& b)
+{
+	String out;
+	const char* p = strstr(*s, *a);
+	int j = p ? int(p - *s) : -1, m = a.length();
+	if (j == -1)
+		return s;
+	out << s.substring(0, j);
+	for (int i = j + m; i <= s.length(); i = j + m)
+	{
+		p = strstr(*s + i, *a);
+		j = p ? int(p - *s) : s.length();
+		out << b << s.substring(i, j);
+	}
+	return out;
+}
+
+static String oldUpperCase(const String& s)
+{
+	String u(s.length(), s.length());
+	for (int i = 0; i < s.length(); i++)
+		u[i] = (char)toupper((unsigned char)s[i]);
+	return u;
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	const char* words[] = { "the ", "quick ", "brown ", "Fox ", "jumps ", "over ", "the ", "lazy ", "Dog, ", "and " };
+	String text = "Lorem ipsum: ";
+	for (unsigned i = 0; text.length() < n - 50; i = i * 1103515245 + 12345)
+		text << words[(i >> 16) % 10];
+	text << "needle in a haystack.";
+	n = text.length();
+	String csv = text.replace(" ", ",");
+
+	printf("%-16s %10s %10s %8s\n", "MB/s", "before", "after", "speedup");
+
+	const char* volatile hay = *text; // keeps the compiler from hoisting strstr out of the loop
+	double r1 = rate(n, [&]() { sink = strstr(hay, "needle") - hay; });
+	double r2 = rate(n, [&]() { sink = text.indexOf("needle"); });
+	printf("%-16s %10.0f %10.0f %7.1fx\n", "indexOf", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { sink = oldLastIndexOf(text, "ipsum"); });
+	r2 = rate(n, [&]() { sink = text.lastIndexOf("ipsum"); });
+	printf("%-16s %10.0f %10.0f %7.1fx\n", "lastIndexOf", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { sink = oldLastIndexOf(text, "the "); });
+	r2 = rate(n, [&]() { sink = text.lastIndexOf("the "); });
+	printf("%-16s %10.0f %10.0f %7.1fx\n", "lastIndexOf (*)", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { sink = oldReplace(csv, ",", ", ").length(); });
+	r2 = rate(n, [&]() { sink = csv.replace(",", ", ").length(); });
+	printf("%-16s %10.0f %10.0f %7.1fx\n", "replace", r1, r2, r2 / r1);
+
+	r1 = rate(n, [&]() { sink = oldUpperCase(text).length(); });
+	r2 = rate(n, [&]() { sink = text.toUpperCase().length(); });
+	printf("%-16s %10.0f %10.0f %7.1fx\n", "toUpperCase", r1, r2, r2 / r1);
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <asl/Matrix.h>
+#include <asl/time.h>
+#include <stdio.h>
+
+/*
+Compares ways of transposing a matrix (a naive double loop, a cache-blocked loop and ops::transpose(), which
+uses register tiles) and of working on a block of a matrix (copying it with slice() or using a view).
+Results are in millions of elements per second.
+
+Usage: bench-transpose [size]
+*/
+
+using namespace asl;
+
+template<class F>
+double rate(int n, F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.2);
+	return (double)n * count / (t2 - t1) * 1e-6;
+}
+
+volatile double sink;
+
+template<class T>
+void naive(const Array2<T>& a, Array2<T>& b)
+{
+	for (int i = 0; i < a.rows(); i++)
+		for (int j = 0; j < a.cols(); j++)
+			b(j, i) = a(i, j);
+}
+
+template<class T>
+void blocked(const Array2<T>& a, Array2<T>& b)
+{
+	const int B = 32;
+	for (int i0 = 0; i0 < a.rows(); i0 += B)
+		for (int j0 = 0; j0 < a.cols(); j0 += B)
+			for (int i = i0; i < min(i0 + B, a.rows()); i++)
+				for (int j = j0; j < min(j0 + B, a.cols()); j++)
+					b(j, i) = a(i, j);
+}
+
+template<class T>
+void bench(const char* type, int n)
+{
+	Array2<T> a(n, n + 3), b(n + 3, n);
+	for (int i = 0; i < a.data().length(); i++)
+		a.data()[i] = T(i % 101);
+	int len = a.data().length();
+	double r1 = rate(len, [&]() { naive(a, b); sink = b(1, 2); });
+	double r2 = rate(len, [&]() { blocked(a, b); sink = b(1, 2); });
+	double r3 = rate(len, [&]() { ops::transpose(a.data().ptr(), a.rows(), a.cols(), b.data().ptr()); sink = b(1, 2); });
+	printf("%-8s %10.0f %10.0f %12.0f %8.1fx\n", type, r1, r2, r3, r3 / r1);
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 2000;
+	printf("transpose %ix%i (Melem/s)\n%-8s %10s %10s %12s %8s\n", n, n + 3, "type", "naive", "blocked",
+		"ops", "speedup");
+	bench<float>("float", n);
+	bench<double>("double", n);
+	bench<int>("int", n);
+	bench<byte>("byte", n);
+
+	Matrix m(n, n, 1.0f);
+	int h = n / 2;
+	double r1 = rate(h * h, [&]() { Matrix s = m.slice(h / 2, h / 2 + h, h / 2, h / 2 + h); s += s; sink = s(0, 0); });
+	double r2 = rate(h * h, [&]() { Matrix s(m.view(h / 2, h / 2 + h, h / 2, h / 2 + h)); s += s; sink = s(0, 0); });
+	double r3 = rate(h * h, [&]() { Array2View<float> v = m.view(h / 2, h / 2 + h, h / 2, h / 2 + h); v.set(2.0f); sink = v(0, 0); });
+	printf("\nblock %ix%i (Melem/s)\n%10s %10s %10s\n%10.0f %10.0f %10.0f\n", h, h, "slice", "view copy", "view set",
+		r1, r2, r3);
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define HAVE_MALLINFO
+#endif
+
+/*
+Decodes a JSON array of objects that all have the same keys (like a table of records) and reports the decoding time,
+the heap memory used per object (only with glibc) and the time to look up properties by key in all objects.
+The "quality_indicator" key is longer than 15 chars, so each object has its own heap copy of it.
+
+Usage: bench-varkeys [count]
+*/
+
+using namespace asl;
+
+static Long heapUsed()
+{
+#ifdef HAVE_MALLINFO
+	return (Long)mallinfo2().uordblks;
+#else
+	return 0;
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 300000;
+	String json = "[";
+	for (int i = 0; i < n; i++)
+		json << String(0, "%s{\"x\":%i,\"y\":%i,\"t\":%i,\"label\":\"p%i\",\"quality_indicator\":%i}",
+			i ? "," : "", i, 2 * i, 3 * i, i, i % 5);
+	json << "]";
+
+	double td = 1e9, tl = 1e9;
+	Long memory = 0;
+	double sum = 0;
+	for (int k = 0; k < 5; k++)
+	{
+		Long m0 = heapUsed();
+		double t1 = now();
+		Var v = Json::decode(json);
+		double t2 = now();
+		memory = heapUsed() - m0;
+		String t = "t", q = "quality_indicator";
+		for (int i = 0; i < n; i++)
+			sum += (int)v[i][t] + (int)v[i][q];
+		double t3 = now();
+		td = min(td, t2 - t1);
+		tl = min(tl, t3 - t2);
+	}
+	printf("%i objects (%.1f MB of JSON)\n\n", n, json.length() / 1e6);
+	printf("decode:  %8.1f ms\n", td * 1e3);
+	if (memory > 0)
+		printf("memory:  %8.0f bytes/object\n", (double)memory / n);
+	printf("lookup:  %8.1f ns/key\n", tl * 1e9 / (2 * n));
+	return sum == 0;
+}
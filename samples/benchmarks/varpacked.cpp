@@ -0,0 +1,62 @@
+#include <asl/Var.h>
+#include <asl/JSON.h>
+#include <asl/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+Decodes a JSON array of numbers with the Json::PACKED option, which gives a packed Var (an Array<double> or Array<int>
+inside), and converts it to an Array. For comparison, the same array is decoded without the option as a regular array
+of Vars. Reports decoding time, conversion time and the memory held by the decoded array.
+
+Usage: bench-varpacked [count]
+*/
+
+using namespace asl;
+
+template<class F>
+double timeit(F f)
+{
+	int count = 0;
+	double t1 = now(), t2;
+	do {
+		f();
+		count++;
+	} while ((t2 = now()) - t1 < 0.5);
+	return (t2 - t1) / count;
+}
+
+volatile double sink;
+
+template<class T>
+void run(const char* name, const String& json)
+{
+	Var v1, v2;
+	double td1 = timeit([&]() { v1 = Json::decode(json, Json::PACKED); });
+	double td2 = timeit([&]() { v2 = Json::decode(json); });
+	double tc1 = timeit([&]() { Array<T> a = v1; sink = a[1]; });
+	double tc2 = timeit([&]() { Array<T> a = v2; sink = a[1]; });
+	int n = v1.length();
+	printf("%-16s %12.2f %12.3f %12.1f\n", *(String(name) + " packed"), td1 * 1e3, tc1 * 1e3, n * sizeof(T) / 1e6);
+	printf("%-16s %12.2f %12.3f %12.1f\n", *(String(name) + " Vars"), td2 * 1e3, tc2 * 1e3, n * sizeof(Var) / 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+	int n = argc > 1 ? atoi(argv[1]) : 1000000;
+	Random rnd(false);
+	Array<double> values(n);
+	Array<int> ints(n);
+	for (int i = 0; i < n; i++)
+	{
+		values[i] = rnd(-1000.0, 1000.0);
+		ints[i] = (int)rnd(-100000.0, 100000.0);
+	}
+	String json = Json::encode(values);
+	String jsoni = Json::encode(ints);
+
+	printf("%-16s %12s %12s %12s\n", "", "decode ms", "to Array ms", "memory MB");
+	run<double>("doubles", json);
+	run<int>("ints", jsoni);
+	return 0;
+}
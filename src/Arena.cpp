@@ -0,0 +1,61 @@
+#include <asl/Arena.h>
+#include <stdlib.h>
+
+namespace asl {
+
+// chunks are linked through a header at their start, padded to keep blocks 16-byte aligned
+
+struct ArenaChunk
+{
+	ArenaChunk* next;
+	size_t pad;
+};
+
+Arena::Arena(int chunkSize)
+{
+	_r = new Region;
+	_r->p = _r->end = 0;
+	_r->chunks = 0;
+	_r->chunkSize = max(chunkSize, 1024);
+	_r->size = 0;
+	_r->retain();
+}
+
+void Arena::Region::release()
+{
+	if (--rc > 0)
+		return;
+	ArenaChunk* c = (ArenaChunk*)chunks;
+	while (c)
+	{
+		ArenaChunk* next = c->next;
+		::free(c);
+		c = next;
+	}
+	delete this;
+}
+
+void* Arena::Region::allocChunk(size_t n)
+{
+	bool big = n > chunkSize / 4;
+	size_t bytes = sizeof(ArenaChunk) + (big ? n : chunkSize);
+	ArenaChunk* c = (ArenaChunk*)malloc(bytes);
+	if (!c)
+		ASL_BAD_ALLOC();
+	size += bytes;
+	char* q = (char*)(c + 1);
+	if (big && chunks) // keep allocating from the current chunk after a big block
+	{
+		ArenaChunk* current = (ArenaChunk*)chunks;
+		c->next = current->next;
+		current->next = c;
+		return q;
+	}
+	c->next = (ArenaChunk*)chunks;
+	chunks = c;
+	p = q + n;
+	end = (char*)c + bytes;
+	return q;
+}
+
+}
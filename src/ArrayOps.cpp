@@ -0,0 +1,703 @@
+#include <asl/ArrayOps.h>
+
+#include "simd.h"
+
+namespace asl {
+namespace ops {
+
+// Portable versions: reductions use several accumulators to shorten dependency chains, and elementwise loops are
+// simple enough for the compiler to vectorize for the baseline instruction set.
+
+template<class T, class S>
+static S sumScalar(const T* a, int n)
+{
+	S s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		s0 += a[i];
+		s1 += a[i + 1];
+		s2 += a[i + 2];
+		s3 += a[i + 3];
+	}
+	for (; i < n; i++)
+		s0 += a[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+template<class T, class S>
+static S dotScalar(const T* a, const T* b, int n)
+{
+	S s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		s0 += (S)a[i] * b[i];
+		s1 += (S)a[i + 1] * b[i + 1];
+		s2 += (S)a[i + 2] * b[i + 2];
+		s3 += (S)a[i + 3] * b[i + 3];
+	}
+	for (; i < n; i++)
+		s0 += (S)a[i] * b[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+template<class T>
+static void minmaxScalar(const T* a, int n, T& lo, T& hi)
+{
+	T l = lo, h = hi;
+	for (int i = 0; i < n; i++)
+	{
+		l = a[i] < l ? a[i] : l;
+		h = a[i] > h ? a[i] : h;
+	}
+	lo = l;
+	hi = h;
+}
+
+template<class T>
+static void scaleScalar(const T* a, T s, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = T(a[i] * s);
+}
+
+template<class T>
+static void addScalar(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = T(a[i] + b[i]);
+}
+
+template<class T>
+static void subtractScalar(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = T(a[i] - b[i]);
+}
+
+template<class T>
+static void multiplyScalar(const T* a, const T* b, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = T(a[i] * b[i]);
+}
+
+template<class T>
+static void clampScalar(const T* a, T lo, T hi, T* out, int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		T x = a[i] < lo ? lo : a[i];
+		out[i] = x > hi ? hi : x;
+	}
+}
+
+template<class T, class K>
+struct Converter
+{
+	static K get(T x) { return (K)x; }
+};
+
+template<class T>
+struct Converter<T, byte>
+{
+	static byte get(T x) { return !(x > 0) ? 0 : x >= 255 ? 255 : (byte)x; }
+};
+
+template<class T, class K>
+static void convertScalar(const T* a, K* out, int n)
+{
+	for (int i = 0; i < n; i++)
+		out[i] = Converter<T, K>::get(a[i]);
+}
+
+#ifdef ASL_X86_AVX2
+
+ASL_TARGET_AVX2 static inline float hsum(__m256 v)
+{
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+}
+
+ASL_TARGET_AVX2 static inline double hsum(__m256d v)
+{
+	__m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+	return _mm_cvtsd_f64(s);
+}
+
+ASL_TARGET_AVX2 static inline Long hsum64(__m256i v)
+{
+	Long t[4];
+	_mm256_storeu_si256((__m256i*)t, v);
+	return (t[0] + t[1]) + (t[2] + t[3]);
+}
+
+ASL_TARGET_AVX2 static float sumAvx(const float* a, int n)
+{
+	__m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+	int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		s0 = _mm256_add_ps(s0, _mm256_loadu_ps(a + i));
+		s1 = _mm256_add_ps(s1, _mm256_loadu_ps(a + i + 8));
+		s2 = _mm256_add_ps(s2, _mm256_loadu_ps(a + i + 16));
+		s3 = _mm256_add_ps(s3, _mm256_loadu_ps(a + i + 24));
+	}
+	for (; i + 8 <= n; i += 8)
+		s0 = _mm256_add_ps(s0, _mm256_loadu_ps(a + i));
+	float s = hsum(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+	for (; i < n; i++)
+		s += a[i];
+	return s;
+}
+
+ASL_TARGET_AVX2 static double sumAvx(const double* a, int n)
+{
+	__m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+	int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+		s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+		s2 = _mm256_add_pd(s2, _mm256_loadu_pd(a + i + 8));
+		s3 = _mm256_add_pd(s3, _mm256_loadu_pd(a + i + 12));
+	}
+	for (; i + 4 <= n; i += 4)
+		s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+	double s = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+	for (; i < n; i++)
+		s += a[i];
+	return s;
+}
+
+ASL_TARGET_AVX2 static Long sumAvx(const int* a, int n)
+{
+	__m256i s0 = _mm256_setzero_si256(), s1 = s0;
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i v = _mm256_loadu_si256((const __m256i*)(a + i));
+		s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+		s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+	}
+	Long s = hsum64(_mm256_add_epi64(s0, s1));
+	for (; i < n; i++)
+		s += a[i];
+	return s;
+}
+
+ASL_TARGET_AVX2 static Long sumAvx(const byte* a, int n)
+{
+	__m256i s = _mm256_setzero_si256(), zero = s;
+	int i = 0;
+	for (; i + 32 <= n; i += 32)
+		s = _mm256_add_epi64(s, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(a + i)), zero));
+	Long t = hsum64(s);
+	for (; i < n; i++)
+		t += a[i];
+	return t;
+}
+
+ASL_TARGET_AVX2 static float dotAvx(const float* a, const float* b, int n)
+{
+	__m256 s0 = _mm256_setzero_ps(), s1 = s0, s2 = s0, s3 = s0;
+	int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+		s1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), s1);
+		s2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), s2);
+		s3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), s3);
+	}
+	for (; i + 8 <= n; i += 8)
+		s0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), s0);
+	float s = hsum(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+	for (; i < n; i++)
+		s += a[i] * b[i];
+	return s;
+}
+
+ASL_TARGET_AVX2 static double dotAvx(const double* a, const double* b, int n)
+{
+	__m256d s0 = _mm256_setzero_pd(), s1 = s0, s2 = s0, s3 = s0;
+	int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+		s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), s1);
+		s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), s2);
+		s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), s3);
+	}
+	for (; i + 4 <= n; i += 4)
+		s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), s0);
+	double s = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+	for (; i < n; i++)
+		s += a[i] * b[i];
+	return s;
+}
+
+// 32x32 -> 64 bit products of the even lanes, then of the odd lanes shifted down
+
+ASL_TARGET_AVX2 static Long dotAvx(const int* a, const int* b, int n)
+{
+	__m256i s0 = _mm256_setzero_si256(), s1 = s0;
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(a + i)), y = _mm256_loadu_si256((const __m256i*)(b + i));
+		s0 = _mm256_add_epi64(s0, _mm256_mul_epi32(x, y));
+		s1 = _mm256_add_epi64(s1, _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32)));
+	}
+	Long s = hsum64(_mm256_add_epi64(s0, s1));
+	for (; i < n; i++)
+		s += (Long)a[i] * b[i];
+	return s;
+}
+
+// Bytes are widened to 16 bits and multiplied-added in pairs into 32-bit lanes, which are moved to 64-bit sums
+// before they can overflow
+
+ASL_TARGET_AVX2 static Long dotAvx(const byte* a, const byte* b, int n)
+{
+	__m256i s = _mm256_setzero_si256(), t = s;
+	int i = 0;
+	while (i + 32 <= n)
+	{
+		__m256i s32 = _mm256_setzero_si256();
+		for (int k = 0; k < 4096 && i + 32 <= n; k++, i += 32)
+		{
+			__m256i x = _mm256_loadu_si256((const __m256i*)(a + i)), y = _mm256_loadu_si256((const __m256i*)(b + i));
+			__m256i x0 = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(x)), x1 = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(x, 1));
+			__m256i y0 = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(y)), y1 = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(y, 1));
+			s32 = _mm256_add_epi32(s32, _mm256_add_epi32(_mm256_madd_epi16(x0, y0), _mm256_madd_epi16(x1, y1)));
+		}
+		s = _mm256_add_epi64(s, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(s32)));
+		t = _mm256_add_epi64(t, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(s32, 1)));
+	}
+	Long r = hsum64(_mm256_add_epi64(s, t));
+	for (; i < n; i++)
+		r += a[i] * b[i];
+	return r;
+}
+
+// Elementwise operations for each type, through a small traits class with the vector load/store and operations
+
+struct AvxFloat
+{
+	typedef float T;
+	typedef __m256 V;
+	enum { N = 8 };
+	ASL_TARGET_AVX2 static V load(const T* p) { return _mm256_loadu_ps(p); }
+	ASL_TARGET_AVX2 static void store(T* p, V v) { _mm256_storeu_ps(p, v); }
+	ASL_TARGET_AVX2 static V set1(T x) { return _mm256_set1_ps(x); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	ASL_TARGET_AVX2 static V vmin(V a, V b) { return _mm256_min_ps(a, b); }
+	ASL_TARGET_AVX2 static V vmax(V a, V b) { return _mm256_max_ps(a, b); }
+};
+
+struct AvxDouble
+{
+	typedef double T;
+	typedef __m256d V;
+	enum { N = 4 };
+	ASL_TARGET_AVX2 static V load(const T* p) { return _mm256_loadu_pd(p); }
+	ASL_TARGET_AVX2 static void store(T* p, V v) { _mm256_storeu_pd(p, v); }
+	ASL_TARGET_AVX2 static V set1(T x) { return _mm256_set1_pd(x); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_pd(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+	ASL_TARGET_AVX2 static V vmin(V a, V b) { return _mm256_min_pd(a, b); }
+	ASL_TARGET_AVX2 static V vmax(V a, V b) { return _mm256_max_pd(a, b); }
+};
+
+struct AvxInt
+{
+	typedef int T;
+	typedef __m256i V;
+	enum { N = 8 };
+	ASL_TARGET_AVX2 static V load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+	ASL_TARGET_AVX2 static void store(T* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+	ASL_TARGET_AVX2 static V set1(T x) { return _mm256_set1_epi32(x); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+	ASL_TARGET_AVX2 static V vmin(V a, V b) { return _mm256_min_epi32(a, b); }
+	ASL_TARGET_AVX2 static V vmax(V a, V b) { return _mm256_max_epi32(a, b); }
+};
+
+// Bytes: products keep the low 8 bits of the 16-bit products
+
+struct AvxByte
+{
+	typedef byte T;
+	typedef __m256i V;
+	enum { N = 32 };
+	ASL_TARGET_AVX2 static V load(const T* p) { return _mm256_loadu_si256((const __m256i*)p); }
+	ASL_TARGET_AVX2 static void store(T* p, V v) { _mm256_storeu_si256((__m256i*)p, v); }
+	ASL_TARGET_AVX2 static V set1(T x) { return _mm256_set1_epi8((char)x); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_epi8(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_epi8(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b)
+	{
+		__m256i mask = _mm256_set1_epi16(0xff);
+		__m256i even = _mm256_mullo_epi16(a, b);
+		__m256i odd = _mm256_mullo_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+		return _mm256_or_si256(_mm256_and_si256(even, mask), _mm256_slli_epi16(odd, 8));
+	}
+	ASL_TARGET_AVX2 static V vmin(V a, V b) { return _mm256_min_epu8(a, b); }
+	ASL_TARGET_AVX2 static V vmax(V a, V b) { return _mm256_max_epu8(a, b); }
+};
+
+template<class A>
+ASL_TARGET_AVX2 static void minmaxAvx(const typename A::T* a, int n, typename A::T& lo, typename A::T& hi)
+{
+	typedef typename A::T T;
+	typedef typename A::V V;
+	int i = 0;
+	if (n >= A::N)
+	{
+		V l = A::load(a), h = l;
+		for (i = A::N; i + A::N <= n; i += A::N)
+		{
+			V x = A::load(a + i);
+			l = A::vmin(l, x);
+			h = A::vmax(h, x);
+		}
+		T tl[A::N], th[A::N];
+		A::store(tl, l);
+		A::store(th, h);
+		minmaxScalar(tl, A::N, lo, hi);
+		minmaxScalar(th, A::N, lo, hi);
+	}
+	minmaxScalar(a + i, n - i, lo, hi);
+}
+
+template<class A>
+ASL_TARGET_AVX2 static void scaleAvx(const typename A::T* a, typename A::T s, typename A::T* out, int n)
+{
+	typename A::V vs = A::set1(s);
+	int i = 0;
+	for (; i + A::N <= n; i += A::N)
+		A::store(out + i, A::mul(A::load(a + i), vs));
+	scaleScalar(a + i, s, out + i, n - i);
+}
+
+template<class A>
+ASL_TARGET_AVX2 static void addAvx(const typename A::T* a, const typename A::T* b, typename A::T* out, int n)
+{
+	int i = 0;
+	for (; i + A::N <= n; i += A::N)
+		A::store(out + i, A::add(A::load(a + i), A::load(b + i)));
+	addScalar(a + i, b + i, out + i, n - i);
+}
+
+template<class A>
+ASL_TARGET_AVX2 static void subtractAvx(const typename A::T* a, const typename A::T* b, typename A::T* out, int n)
+{
+	int i = 0;
+	for (; i + A::N <= n; i += A::N)
+		A::store(out + i, A::sub(A::load(a + i), A::load(b + i)));
+	subtractScalar(a + i, b + i, out + i, n - i);
+}
+
+template<class A>
+ASL_TARGET_AVX2 static void multiplyAvx(const typename A::T* a, const typename A::T* b, typename A::T* out, int n)
+{
+	int i = 0;
+	for (; i + A::N <= n; i += A::N)
+		A::store(out + i, A::mul(A::load(a + i), A::load(b + i)));
+	multiplyScalar(a + i, b + i, out + i, n - i);
+}
+
+template<class A>
+ASL_TARGET_AVX2 static void clampAvx(const typename A::T* a, typename A::T lo, typename A::T hi, typename A::T* out, int n)
+{
+	typename A::V vl = A::set1(lo), vh = A::set1(hi);
+	int i = 0;
+	for (; i + A::N <= n; i += A::N)
+		A::store(out + i, A::vmin(A::vmax(A::load(a + i), vl), vh));
+	clampScalar(a + i, lo, hi, out + i, n - i);
+}
+
+// Conversions, 8 elements per iteration (4 from double). Values converted to byte are first limited to [0, 255]
+// (so NaN gives 0) and then truncated and packed.
+
+ASL_TARGET_AVX2 static inline void storeBytes8(byte* p, __m256i v)
+{
+	__m128i w = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	_mm_storel_epi64((__m128i*)p, _mm_packus_epi16(w, w));
+}
+
+ASL_TARGET_AVX2 static inline __m256i loadBytes8(const byte* p)
+{
+	return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const float* a, double* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(a + i);
+		_mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+		_mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+	}
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const float* a, int* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_cvttps_epi32(_mm256_loadu_ps(a + i)));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const float* a, byte* out, int n)
+{
+	__m256 zero = _mm256_setzero_ps(), top = _mm256_set1_ps(255.0f);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		storeBytes8(out + i, _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(a + i), zero), top)));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const double* a, float* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128 x0 = _mm256_cvtpd_ps(_mm256_loadu_pd(a + i)), x1 = _mm256_cvtpd_ps(_mm256_loadu_pd(a + i + 4));
+		_mm256_storeu_ps(out + i, _mm256_insertf128_ps(_mm256_castps128_ps256(x0), x1, 1));
+	}
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const double* a, int* out, int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm_storeu_si128((__m128i*)(out + i), _mm256_cvttpd_epi32(_mm256_loadu_pd(a + i)));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const double* a, byte* out, int n)
+{
+	__m256d zero = _mm256_setzero_pd(), top = _mm256_set1_pd(255.0);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i x0 = _mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(_mm256_loadu_pd(a + i), zero), top));
+		__m128i x1 = _mm256_cvttpd_epi32(_mm256_min_pd(_mm256_max_pd(_mm256_loadu_pd(a + i + 4), zero), top));
+		storeBytes8(out + i, _mm256_inserti128_si256(_mm256_castsi128_si256(x0), x1, 1));
+	}
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const int* a, float* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(a + i))));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const int* a, double* out, int n)
+{
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(out + i, _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(a + i))));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const int* a, byte* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		storeBytes8(out + i, _mm256_loadu_si256((const __m256i*)(a + i)));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void castAvx(const int* a, byte* out, int n)
+{
+	__m256i low = _mm256_set1_epi32(255);
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		storeBytes8(out + i, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + i)), low));
+	cast<int>(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const byte* a, float* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_ps(out + i, _mm256_cvtepi32_ps(loadBytes8(a + i)));
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const byte* a, double* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m256i x = loadBytes8(a + i);
+		_mm256_storeu_pd(out + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(x)));
+		_mm256_storeu_pd(out + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)));
+	}
+	convertScalar(a + i, out + i, n - i);
+}
+
+ASL_TARGET_AVX2 static void convertAvx(const byte* a, int* out, int n)
+{
+	int i = 0;
+	for (; i + 8 <= n; i += 8)
+		_mm256_storeu_si256((__m256i*)(out + i), loadBytes8(a + i));
+	convertScalar(a + i, out + i, n - i);
+}
+
+// Transposes of 8x8 floats (or ints) and 4x4 doubles in registers
+
+ASL_TARGET_AVX2 static inline void transposeTile(const float* a, int lda, float* out, int ldo)
+{
+	__m256 r0 = _mm256_loadu_ps(a), r1 = _mm256_loadu_ps(a + lda), r2 = _mm256_loadu_ps(a + 2 * lda),
+		r3 = _mm256_loadu_ps(a + 3 * lda), r4 = _mm256_loadu_ps(a + 4 * lda), r5 = _mm256_loadu_ps(a + 5 * lda),
+		r6 = _mm256_loadu_ps(a + 6 * lda), r7 = _mm256_loadu_ps(a + 7 * lda);
+	__m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1), t2 = _mm256_unpacklo_ps(r2, r3),
+		t3 = _mm256_unpackhi_ps(r2, r3), t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5),
+		t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+	__m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)),
+		s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)),
+		s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2)),
+		s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+	_mm256_storeu_ps(out, _mm256_permute2f128_ps(s0, s4, 0x20));
+	_mm256_storeu_ps(out + ldo, _mm256_permute2f128_ps(s1, s5, 0x20));
+	_mm256_storeu_ps(out + 2 * ldo, _mm256_permute2f128_ps(s2, s6, 0x20));
+	_mm256_storeu_ps(out + 3 * ldo, _mm256_permute2f128_ps(s3, s7, 0x20));
+	_mm256_storeu_ps(out + 4 * ldo, _mm256_permute2f128_ps(s0, s4, 0x31));
+	_mm256_storeu_ps(out + 5 * ldo, _mm256_permute2f128_ps(s1, s5, 0x31));
+	_mm256_storeu_ps(out + 6 * ldo, _mm256_permute2f128_ps(s2, s6, 0x31));
+	_mm256_storeu_ps(out + 7 * ldo, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+ASL_TARGET_AVX2 static inline void transposeTile(const double* a, int lda, double* out, int ldo)
+{
+	__m256d r0 = _mm256_loadu_pd(a), r1 = _mm256_loadu_pd(a + lda), r2 = _mm256_loadu_pd(a + 2 * lda),
+		r3 = _mm256_loadu_pd(a + 3 * lda);
+	__m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1), t2 = _mm256_unpacklo_pd(r2, r3),
+		t3 = _mm256_unpackhi_pd(r2, r3);
+	_mm256_storeu_pd(out, _mm256_permute2f128_pd(t0, t2, 0x20));
+	_mm256_storeu_pd(out + ldo, _mm256_permute2f128_pd(t1, t3, 0x20));
+	_mm256_storeu_pd(out + 2 * ldo, _mm256_permute2f128_pd(t0, t2, 0x31));
+	_mm256_storeu_pd(out + 3 * ldo, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+// Cache blocks of 32 x 32 elements, made of register tiles of TS x TS, and plain loops for the borders
+
+template<class T, int TS>
+ASL_TARGET_AVX2 static void transposeAvx(const T* a, int rows, int cols, int lda, T* out, int ldo)
+{
+	const int B = 32;
+	for (int i0 = 0; i0 < rows; i0 += B)
+		for (int j0 = 0; j0 < cols; j0 += B)
+		{
+			int i1 = min(i0 + B, rows), j1 = min(j0 + B, cols);
+			int ie = i0 + (i1 - i0) / TS * TS, je = j0 + (j1 - j0) / TS * TS;
+			for (int i = i0; i < ie; i += TS)
+				for (int j = j0; j < je; j += TS)
+					transposeTile(a + i * lda + j, lda, out + j * ldo + i, ldo);
+			for (int i = i0; i < i1; i++)
+				for (int j = i < ie ? je : j0; j < j1; j++)
+					out[j * ldo + i] = a[i * lda + j];
+		}
+}
+
+#define ASL_DISPATCH(avx, scalar) if (hasAvx2()) return avx; return scalar
+
+#else
+
+#define ASL_DISPATCH(avx, scalar) return scalar
+
+#endif
+
+float sum(const float* a, int n) { ASL_DISPATCH(sumAvx(a, n), (sumScalar<float, float>(a, n))); }
+double sum(const double* a, int n) { ASL_DISPATCH(sumAvx(a, n), (sumScalar<double, double>(a, n))); }
+Long sum(const int* a, int n) { ASL_DISPATCH(sumAvx(a, n), (sumScalar<int, Long>(a, n))); }
+Long sum(const byte* a, int n) { ASL_DISPATCH(sumAvx(a, n), (sumScalar<byte, Long>(a, n))); }
+
+float dot(const float* a, const float* b, int n) { ASL_DISPATCH(dotAvx(a, b, n), (dotScalar<float, float>(a, b, n))); }
+double dot(const double* a, const double* b, int n) { ASL_DISPATCH(dotAvx(a, b, n), (dotScalar<double, double>(a, b, n))); }
+Long dot(const int* a, const int* b, int n) { ASL_DISPATCH(dotAvx(a, b, n), (dotScalar<int, Long>(a, b, n))); }
+Long dot(const byte* a, const byte* b, int n) { ASL_DISPATCH(dotAvx(a, b, n), (dotScalar<byte, Long>(a, b, n))); }
+
+#define ASL_MINMAX(T, A) \
+void minmax(const T* a, int n, T& lo, T& hi) \
+{ \
+	if (n <= 0) \
+		return; \
+	lo = hi = a[0]; \
+	ASL_DISPATCH(minmaxAvx<A>(a, n, lo, hi), minmaxScalar(a, n, lo, hi)); \
+}
+
+#define ASL_ELEMENTWISE(T, A) \
+void scale(const T* a, T s, T* out, int n) { ASL_DISPATCH(scaleAvx<A>(a, s, out, n), scaleScalar(a, s, out, n)); } \
+void add(const T* a, const T* b, T* out, int n) { ASL_DISPATCH(addAvx<A>(a, b, out, n), addScalar(a, b, out, n)); } \
+void subtract(const T* a, const T* b, T* out, int n) { ASL_DISPATCH(subtractAvx<A>(a, b, out, n), subtractScalar(a, b, out, n)); } \
+void multiply(const T* a, const T* b, T* out, int n) { ASL_DISPATCH(multiplyAvx<A>(a, b, out, n), multiplyScalar(a, b, out, n)); } \
+void clamp(const T* a, T lo, T hi, T* out, int n) { ASL_DISPATCH(clampAvx<A>(a, lo, hi, out, n), clampScalar(a, lo, hi, out, n)); }
+
+ASL_MINMAX(float, AvxFloat)
+ASL_MINMAX(double, AvxDouble)
+ASL_MINMAX(int, AvxInt)
+ASL_MINMAX(byte, AvxByte)
+
+ASL_ELEMENTWISE(float, AvxFloat)
+ASL_ELEMENTWISE(double, AvxDouble)
+ASL_ELEMENTWISE(int, AvxInt)
+ASL_ELEMENTWISE(byte, AvxByte)
+
+#define ASL_CONVERT(T, K) \
+void convert(const T* a, K* out, int n) { ASL_DISPATCH(convertAvx(a, out, n), convertScalar(a, out, n)); }
+
+ASL_CONVERT(float, double)
+ASL_CONVERT(float, int)
+ASL_CONVERT(float, byte)
+ASL_CONVERT(double, float)
+ASL_CONVERT(double, int)
+ASL_CONVERT(double, byte)
+ASL_CONVERT(int, float)
+ASL_CONVERT(int, double)
+ASL_CONVERT(int, byte)
+ASL_CONVERT(byte, float)
+ASL_CONVERT(byte, double)
+ASL_CONVERT(byte, int)
+
+void cast(const int* a, byte* out, int n) { ASL_DISPATCH(castAvx(a, out, n), cast<int>(a, out, n)); }
+
+void transpose(const float* a, int rows, int cols, int lda, float* out, int ldo)
+{
+	ASL_DISPATCH((transposeAvx<float, 8>(a, rows, cols, lda, out, ldo)), transpose<float>(a, rows, cols, lda, out, ldo));
+}
+
+void transpose(const double* a, int rows, int cols, int lda, double* out, int ldo)
+{
+	ASL_DISPATCH((transposeAvx<double, 4>(a, rows, cols, lda, out, ldo)), transpose<double>(a, rows, cols, lda, out, ldo));
+}
+
+void transpose(const int* a, int rows, int cols, int lda, int* out, int ldo)
+{
+	transpose((const float*)a, rows, cols, lda, (float*)out, ldo);
+}
+
+void transpose(const byte* a, int rows, int cols, int lda, byte* out, int ldo)
+{
+	transpose<byte>(a, rows, cols, lda, out, ldo);
+}
+
+}
+}
@@ -0,0 +1,501 @@
+#include <asl/Cbor.h>
+#include <asl/File.h>
+#include <math.h>
+
+namespace asl {
+
+// RFC 8746 typed array tags used when encoding (little-endian blocks)
+
+enum { TAG_INT32LE = 78, TAG_FLOAT32LE = 85, TAG_FLOAT64LE = 86 };
+
+static inline byte* grow(StreamBuffer& out, int k)
+{
+	int n = out.length();
+	out.resize(n + k);
+	return out.ptr() + n;
+}
+
+static void putHead(StreamBuffer& out, int major, ULong n)
+{
+	byte m = byte(major << 5);
+	if (n < 24)
+		*grow(out, 1) = m | byte(n);
+	else if (n < 256)
+	{
+		byte* p = grow(out, 2);
+		p[0] = m | 24;
+		p[1] = byte(n);
+	}
+	else if (n < 65536)
+	{
+		byte* p = grow(out, 3);
+		p[0] = m | 25;
+		p[1] = byte(n >> 8); p[2] = byte(n);
+	}
+	else if (n <= 0xffffffffu)
+	{
+		byte* p = grow(out, 5);
+		p[0] = m | 26;
+		for (int i = 0; i < 4; i++)
+			p[1 + i] = byte(n >> (24 - 8 * i));
+	}
+	else
+	{
+		byte* p = grow(out, 9);
+		p[0] = m | 27;
+		for (int i = 0; i < 8; i++)
+			p[1 + i] = byte(n >> (56 - 8 * i));
+	}
+}
+
+template<class T>
+static inline void putLE(byte* p, T x)
+{
+	AsBytes<T> y(x);
+	if (ASL_OTHER_ENDIAN == ENDIAN_BIG)
+		memcpy(p, y.b, sizeof(T));
+	else
+		for (int i = 0; i < (int)sizeof(T); i++)
+			p[i] = y.b[sizeof(T) - 1 - i];
+}
+
+template<class T>
+static inline void putBE(byte* p, T x)
+{
+	AsBytes<T> y(x);
+	if (ASL_OTHER_ENDIAN == ENDIAN_LITTLE)
+		memcpy(p, y.b, sizeof(T));
+	else
+		for (int i = 0; i < (int)sizeof(T); i++)
+			p[i] = y.b[sizeof(T) - 1 - i];
+}
+
+// returns the element type if all elements of the array are of the same numeric type
+
+static Var::Type numericType(const Var& v, int n)
+{
+	Var::Type t = v[0].type();
+	if (t != Var::INT && t != Var::FLOAT && t != Var::NUMBER)
+		return Var::NONE;
+	for (int i = 1; i < n; i++)
+		if (v[i].type() != t)
+			return Var::NONE;
+	return t;
+}
+
+static void encodeItem(const Var& v, StreamBuffer& out)
+{
+	switch (v.type())
+	{
+	case Var::INT: {
+		int x = v;
+		if (x >= 0)
+			putHead(out, 0, (ULong)x);
+		else
+			putHead(out, 1, (ULong)(-1 - (Long)x));
+		break;
+	}
+	case Var::FLOAT: {
+		byte* p = grow(out, 5);
+		p[0] = 0xfa;
+		putBE(p + 1, (float)v);
+		break;
+	}
+	case Var::NUMBER: {
+		byte* p = grow(out, 9);
+		p[0] = 0xfb;
+		putBE(p + 1, (double)v);
+		break;
+	}
+	case Var::BOOL:
+		*grow(out, 1) = (bool)v ? 0xf5 : 0xf4;
+		break;
+	case Var::STRING: {
+		int n = v.length();
+		putHead(out, 3, n);
+		memcpy(grow(out, n), *v, n);
+		break;
+	}
+	case Var::ARRAY: {
+		int n = v.length();
+		Var::Type t = n == 0 ? Var::NONE : v.packedType() != Var::NONE ? v.packedType() : numericType(v, n);
+		if (t == Var::NONE)
+		{
+			putHead(out, 4, n);
+			for (int i = 0; i < n; i++)
+				encodeItem(v[i], out);
+			break;
+		}
+		int size = t == Var::NUMBER ? 8 : 4;
+		putHead(out, 6, t == Var::NUMBER ? TAG_FLOAT64LE : t == Var::FLOAT ? TAG_FLOAT32LE : TAG_INT32LE);
+		putHead(out, 2, (ULong)n * size);
+		byte* p = grow(out, n * size);
+		if (t == Var::NUMBER)
+		{
+			Array<double> x = v; // packed arrays are not copied
+			for (int i = 0; i < n; i++, p += 8)
+				putLE(p, x[i]);
+		}
+		else if (t == Var::FLOAT)
+		{
+			Array<float> x = v;
+			for (int i = 0; i < n; i++, p += 4)
+				putLE(p, x[i]);
+		}
+		else
+		{
+			Array<int> x = v;
+			for (int i = 0; i < n; i++, p += 4)
+				putLE(p, x[i]);
+		}
+		break;
+	}
+	case Var::DIC: {
+		putHead(out, 5, v.length());
+		foreach2(String& k, Var& x, v)
+		{
+			putHead(out, 3, k.length());
+			memcpy(grow(out, k.length()), *k, k.length());
+			encodeItem(x, out);
+		}
+		break;
+	}
+	case Var::NUL:
+		*grow(out, 1) = 0xf6;
+		break;
+	default:
+		*grow(out, 1) = 0xf7;
+		break;
+	}
+}
+
+void Cbor::encode(const Var& v, StreamBuffer& out)
+{
+	encodeItem(v, out);
+}
+
+Array<byte> Cbor::encode(const Var& v)
+{
+	StreamBuffer out;
+	out.reserve(256);
+	encodeItem(v, out);
+	return *out;
+}
+
+struct CborDecoder
+{
+	const byte* p;
+	const byte* end;
+	bool error;
+	int depth;
+
+	CborDecoder(const byte* p0, const byte* e) : p(p0), end(e), error(false), depth(0) {}
+
+	bool has(ULong n)
+	{
+		if ((ULong)(end - p) < n)
+			error = true;
+		return !error;
+	}
+
+	ULong readUint(int n)
+	{
+		ULong x = 0;
+		for (int i = 0; i < n; i++)
+			x = (x << 8) | p[i];
+		p += n;
+		return x;
+	}
+
+	// reads the argument of an item given its additional info; returns false on an invalid or indefinite length
+	bool argument(int info, ULong& n)
+	{
+		if (info < 24)
+			n = info;
+		else if (info < 28)
+		{
+			int k = 1 << (info - 24);
+			if (!has(k))
+				return false;
+			n = readUint(k);
+		}
+		else
+			return false;
+		return true;
+	}
+
+	Var decode();
+	Var typedArray(int tag, ULong n);
+	String text(int major, int info);
+};
+
+static Var intVar(ULong u, bool neg)
+{
+	if (!neg)
+		return u <= 0x7fffffff ? Var((int)u) : Var((double)u);
+	return u <= 0x7fffffff ? Var(-1 - (int)u) : Var(-1.0 - (double)u);
+}
+
+static float halfToFloat(unsigned h)
+{
+	int e = (h >> 10) & 0x1f, m = h & 0x3ff;
+	float x = e == 0 ? m * (1.0f / (1 << 24)) : e == 31 ? (m == 0 ? infinity() : nan()) : (float)ldexp(1024.0 + m, e - 25);
+	return (h & 0x8000) ? -x : x;
+}
+
+template<class T>
+static inline T getAs(const byte* p, bool little)
+{
+	AsBytes<T> y;
+	bool same = little ? ASL_OTHER_ENDIAN == ENDIAN_BIG : ASL_OTHER_ENDIAN == ENDIAN_LITTLE;
+	if (same)
+		memcpy(y.b, p, sizeof(T));
+	else
+		for (int i = 0; i < (int)sizeof(T); i++)
+			y.b[i] = p[sizeof(T) - 1 - i];
+	return y.x;
+}
+
+// decodes the byte string content of an RFC 8746 typed array tag (0b010_f_s_e_ll)
+
+Var CborDecoder::typedArray(int tag, ULong n)
+{
+	bool isFloat = (tag & 16) != 0, isSigned = (tag & 8) != 0, little = (tag & 4) != 0;
+	int ll = tag & 3;
+	int size = isFloat ? 2 << ll : 1 << ll;
+	if ((isFloat && ll == 3) || n % size != 0) // no float128
+	{
+		error = true;
+		return Var();
+	}
+	int count = int(n / size);
+	const byte* q = p;
+	p += n;
+	if (isFloat && size == 8)
+	{
+		Array<double> a(count);
+		for (int i = 0; i < count; i++, q += size)
+			a[i] = getAs<double>(q, little);
+		return a;
+	}
+	if (isFloat)
+	{
+		Array<float> a(count);
+		for (int i = 0; i < count; i++, q += size)
+			a[i] = size == 2 ? halfToFloat(getAs<unsigned short>(q, little)) : getAs<float>(q, little);
+		return a;
+	}
+	if (size < 4 || (size == 4 && isSigned))
+	{
+		Array<int> a(count);
+		for (int i = 0; i < count; i++, q += size)
+		{
+			if (size == 1)
+				a[i] = isSigned ? (int)(signed char)*q : (int)*q;
+			else if (size == 2)
+				a[i] = isSigned ? (int)getAs<short>(q, little) : (int)getAs<unsigned short>(q, little);
+			else
+				a[i] = getAs<int>(q, little);
+		}
+		return a;
+	}
+	Var a(Var::ARRAY); // uint32 and 64-bit ints become ints or doubles depending on their range
+	a.resize(count);
+	for (int i = 0; i < count; i++, q += size)
+	{
+		if (size == 4)
+			a[i] = intVar(getAs<unsigned>(q, little), false);
+		else
+		{
+			Long x = getAs<Long>(q, little);
+			a[i] = (!isSigned && x < 0) ? Var((double)(ULong)x) : (x >= -2147483647 - 1 && x <= 0x7fffffff) ? Var((int)x) : Var((double)x);
+		}
+	}
+	return a;
+}
+
+// reads a (possibly indefinite length) text or byte string
+
+String CborDecoder::text(int major, int info)
+{
+	ULong n;
+	if (info == 31)
+	{
+		String s;
+		while (has(1) && *p != 0xff)
+		{
+			int b = *p++;
+			if ((b >> 5) != major || (b & 31) == 31)
+			{
+				error = true;
+				return s;
+			}
+			s << text(major, b & 31);
+			if (error)
+				return s;
+		}
+		if (has(1))
+			p++;
+		return s;
+	}
+	if (!argument(info, n) || !has(n) || n > 0x7fffffff)
+	{
+		error = true;
+		return String();
+	}
+	String s((const char*)p, (int)n);
+	p += n;
+	return s;
+}
+
+Var CborDecoder::decode()
+{
+	if (!has(1) || ++depth > 1000)
+	{
+		error = true;
+		return Var();
+	}
+	int b = *p++;
+	int major = b >> 5, info = b & 31;
+	ULong n = 0;
+	Var v;
+	switch (major)
+	{
+	case 0:
+	case 1:
+		if (!argument(info, n))
+			error = true;
+		else
+			v = intVar(n, major == 1);
+		break;
+	case 2: {
+		String s = text(2, info);
+		Array<int> bytes(s.length());
+		for (int i = 0; i < s.length(); i++)
+			bytes[i] = (byte)s[i];
+		v = bytes;
+		break;
+	}
+	case 3:
+		v = text(3, info);
+		break;
+	case 4:
+		v = Var(Var::ARRAY);
+		if (info == 31)
+		{
+			while (!error && has(1) && *p != 0xff)
+				v << decode();
+			if (has(1))
+				p++;
+		}
+		else if (!argument(info, n) || !has(n))
+			error = true;
+		else
+		{
+			v.resize((int)n);
+			for (int i = 0; i < (int)n && !error; i++)
+				v[i] = decode();
+		}
+		break;
+	case 5:
+		v = Var(Var::DIC);
+		if (info == 31)
+		{
+			while (!error && has(1) && *p != 0xff)
+			{
+				Var k = decode();
+				v[k.is(Var::STRING) ? String(*k) : k.toString()] = decode();
+			}
+			if (has(1))
+				p++;
+		}
+		else if (!argument(info, n) || !has(n * 2))
+			error = true;
+		else
+			for (int i = 0; i < (int)n && !error; i++)
+			{
+				Var k = decode();
+				v[k.is(Var::STRING) ? String(*k) : k.toString()] = decode();
+			}
+		break;
+	case 6:
+		if (!argument(info, n))
+			error = true;
+		else if (n >= 64 && n <= 87 && n != 76 && has(1) && (*p >> 5) == 2 && (*p & 31) != 31)
+		{
+			ULong m;
+			info = *p++ & 31;
+			if (!argument(info, m) || !has(m))
+				error = true;
+			else
+				v = typedArray((int)n, m);
+		}
+		else
+			v = decode(); // other tags are ignored
+		break;
+	case 7:
+		switch (info)
+		{
+		case 20: v = false; break;
+		case 21: v = true; break;
+		case 22: v = Var(Var::NUL); break;
+		case 25:
+			if (has(2))
+				v = halfToFloat((unsigned)readUint(2));
+			break;
+		case 26:
+			if (has(4))
+			{
+				v = getAs<float>(p, false);
+				p += 4;
+			}
+			break;
+		case 27:
+			if (has(8))
+			{
+				v = getAs<double>(p, false);
+				p += 8;
+			}
+			break;
+		case 24:
+			if (has(1))
+				p++;
+			break;
+		default:
+			if (info >= 28)
+				error = true;
+			break; // undefined and other simple values
+		}
+		break;
+	}
+	depth--;
+	return error ? Var() : v;
+}
+
+Var Cbor::decode(StreamBufferReader& in)
+{
+	CborDecoder decoder(in.ptr(), in.end());
+	Var v = decoder.decode();
+	if (decoder.error)
+		return Var();
+	in.skip(int(decoder.p - in.ptr()));
+	return v;
+}
+
+Var Cbor::decode(const Array<byte>& data)
+{
+	StreamBufferReader in(data);
+	return decode(in);
+}
+
+Var Cbor::read(const String& file)
+{
+	return decode(File(file).content());
+}
+
+bool Cbor::write(const String& file, const Var& v)
+{
+	return File(file).put(encode(v));
+}
+
+}
@@ -1,5 +1,6 @@
 #include <asl/Directory.h>
 #include <asl/Path.h>
+#include <asl/Thread.h>
 #include <stdio.h>
 #ifdef __APPLE__
 #include <sys/syslimits.h>
@@ -12,6 +13,21 @@
 
 namespace asl {
 
+// Lists the entries of directory `dir` (ending in a separator), adding files matching `which` to `files` and
+// subdirectory paths to `subdirs`. Symbolic links are not followed: they are listed as files.
+
+static void listDir(const String& dir, const String& which, Array<File>& files, Array<String>& subdirs);
+static bool removeFile(const String& path);
+static bool removeDir(const String& path);
+
+static bool match(const String& a, const String& patt)
+{
+	int i = patt.indexOf('*');
+	if (i==-1)
+		return a==patt;
+	return a.startsWith(patt.substring(0,i)) && a.endsWith(patt.substring(i+1));
+}
+
 String Directory::name() const
 {
 	return Path(_path).name();
@@ -67,7 +83,6 @@ bool Directory::removeRecursive(const String& path)
 {
 	if (!path.ok())
 		return false;
-	bool ok = true;
 	String abs = Path(path).absolute().string().toLowerCase().replace('\\', '/');
 	if (abs.endsWith('/'))
 		abs.resize(abs.length() - 1);
@@ -75,14 +90,68 @@ bool Directory::removeRecursive(const String& path)
 		return false;
 	if (((abs.length() > 3 && abs.substr(3) == "windows") || abs.substr(3) == "program files") || abs == "")
 		return false;
-	Directory dir(path);
-	foreach(File& file, dir.files())
-		ok = ok && file.remove();
- 	foreach(File& d, dir.subdirs())
-		ok = ok && removeRecursive(d.path());
-	
-	ok = ok && remove(path);
-	return ok;
+	return removeTree(path);
+}
+
+bool Directory::removeTree(const String& path)
+{
+	Array<File> files;
+	Array<String> subdirs;
+	listDir(path.endsWith('/') || path.endsWith('\\') ? path : path + '/', "*", files, subdirs);
+	bool ok = true;
+	foreach(File& file, files)
+		ok = removeFile(file.path()) && ok;
+	foreach(String& d, subdirs)
+		ok = removeTree(d) && ok;
+	return removeDir(path) && ok;
+}
+
+static void scanTree(const String& dir, const String& which, Array<File>& files)
+{
+	Array<String> subdirs;
+	listDir(dir, which, files, subdirs);
+	foreach(String& d, subdirs)
+		scanTree(d + '/', which, files);
+}
+
+const Array<File> Directory::filesRecursive(const String& which, int nthreads)
+{
+	Array<File> files;
+	Array<String> frontier;
+	frontier << (_path == "" ? String("/") : (_path.endsWith('/') || _path.endsWith('\\')) ? _path : _path + '/');
+	nthreads = max(nthreads, 1);
+
+	// expand the top levels until there are enough subtrees to distribute among threads
+
+	for (int level = 0; level < 3 && frontier.length() > 0 && frontier.length() < 4 * nthreads; level++)
+	{
+		Array<String> next;
+		foreach(String& d, frontier)
+		{
+			Array<String> subdirs;
+			listDir(d, which, files, subdirs);
+			foreach(String& s, subdirs)
+				next << s + '/';
+		}
+		frontier = next;
+		if (nthreads == 1)
+			break;
+	}
+
+	Array<Array<File> > parts(frontier.length());
+#ifdef ASL_EXP_THREADING
+	if (nthreads > 1)
+		Thread::parallel_for(0, frontier.length(), [&](int i) {
+			scanTree(frontier[i], which, parts[i]);
+		}, nthreads);
+	else
+#endif
+	for (int i = 0; i < frontier.length(); i++)
+		scanTree(frontier[i], which, parts[i]);
+
+	foreach(Array<File>& part, parts)
+		files.append(part);
+	return files;
 }
 
 
@@ -149,6 +218,37 @@ static FileInfo infoFor(const WIN32_FIND_DATA& data)
 	return info;
 }
 
+static void listDir(const String& dir, const String& which, Array<File>& files, Array<String>& subdirs)
+{
+	WIN32_FIND_DATA data;
+	HANDLE hdir = FindFirstFile(dir + '*', &data);
+	if (hdir == INVALID_HANDLE_VALUE)
+		return;
+	bool all = which == "*";
+	do {
+		String name = (String)data.cFileName;
+		if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 && (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0)
+		{
+			if (name != "." && name != "..")
+				subdirs << dir + name;
+		}
+		else if (all || match(name, which))
+			files << File(dir + name, infoFor(data));
+	}
+	while (FindNextFile(hdir, &data));
+	FindClose(hdir);
+}
+
+static bool removeFile(const String& path)
+{
+	return DeleteFileW(path) != 0;
+}
+
+static bool removeDir(const String& path)
+{
+	return RemoveDirectoryW(path) != 0;
+}
+
 const Array<File> Directory::items(const String& which, Directory::ItemType t)
 {
 	_files.clear();
@@ -240,6 +340,10 @@ bool Directory::remove(const String& path)
 #include <unistd.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
 
 #ifndef PATH_MAX
 #define PATH_MAX 255
@@ -262,12 +366,48 @@ static FileInfo infoFor(const struct stat& data)
 	return info;
 }
 
-static bool match(const String& a, const String& patt)
+static void listDir(const String& dir, const String& which, Array<File>& files, Array<String>& subdirs)
 {
-	int i = patt.indexOf('*');
-	if (i==-1)
-		return a==patt;
-	return a.startsWith(patt.substring(0,i)) && a.endsWith(patt.substring(i+1));
+	DIR* d = opendir(dir);
+	if (!d)
+		return;
+	bool all = which == "*";
+	while (dirent* entry = readdir(d))
+	{
+		const char* n = entry->d_name;
+		if (n[0] == '.' && (n[1] == '\0' || (n[1] == '.' && n[2] == '\0')))
+			continue;
+		bool isdir = false;
+		struct stat data;
+		bool hasInfo = false;
+#ifdef DT_DIR
+		if (entry->d_type != DT_UNKNOWN)
+			isdir = entry->d_type == DT_DIR;
+		else
+#endif
+		if (fstatat(dirfd(d), n, &data, AT_SYMLINK_NOFOLLOW) == 0)
+		{
+			isdir = S_ISDIR(data.st_mode);
+			hasInfo = !S_ISLNK(data.st_mode);
+		}
+		String name = dir;
+		name += n;
+		if (isdir)
+			subdirs << name;
+		else if (all || match(n, which))
+			files << (hasInfo ? File(name, infoFor(data)) : File(name));
+	}
+	closedir(d);
+}
+
+static bool removeFile(const String& path)
+{
+	return unlink(path) == 0;
+}
+
+static bool removeDir(const String& path)
+{
+	return rmdir(path) == 0;
 }
 
 const Array<File> Directory::items(const String& which, Directory::ItemType t)
@@ -288,7 +428,18 @@ const Array<File> Directory::items(const String& which, Directory::ItemType t)
 			continue;
 		String name = dir;
 		name += (const char*)entry->d_name;
-		if(!stat(name, &data)) {
+#ifdef DT_DIR
+		if (entry->d_type == DT_DIR || entry->d_type == DT_REG)
+		{
+			// type known without stat; the File will get its info when needed
+			bool isdir = entry->d_type == DT_DIR;
+			if ((t == DIRE && !isdir) || (t == FILE && isdir))
+				continue;
+			_files << File(name);
+			continue;
+		}
+#endif
+		if(!fstatat(dirfd(d), entry->d_name, &data, 0)) {
 			if( (t==DIRE && !S_ISDIR(data.st_mode)) ||
 				(t==FILE && S_ISDIR(data.st_mode)) )
 				continue;
@@ -331,29 +482,69 @@ bool Directory::change(const String& dir)
 
 bool Directory::copy(const String& from, const String& to)
 {
-	File src(from, File::READ);
-	if(!src)
+	int src = open(from, O_RDONLY);
+	if (src < 0)
+		return false;
+	struct stat info;
+	if (fstat(src, &info) != 0)
+	{
+		close(src);
 		return false;
+	}
 	String topath = to;
 	File tofile(to);
 	if(tofile.isDirectory())
 		topath = to + '/' + File(from).name();
 
-	File dst(topath, File::WRITE);
-	if(!dst)
+	int dst = open(topath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (dst < 0)
+	{
+		close(src);
 		return false;
+	}
 
-	byte buffer[65536];
-	int n=0;
-	do {
-		n = src.read(buffer, sizeof(buffer));
-		if( n < 0)
-			return false;
-		int m = dst.write(buffer, n);
-		if( m != n)
-			return false;
-	}while (n == sizeof(buffer));
-	return true;
+	// let the kernel copy the data without passing it through user space if possible
+
+	Long left = info.st_size;
+	bool ok = true;
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 27)
+	while (left > 0)
+	{
+		ssize_t n = copy_file_range(src, 0, dst, 0, (size_t)left, 0);
+		if (n <= 0)
+			break;
+		left -= n;
+	}
+#endif
+#ifdef __linux__
+	while (left > 0)
+	{
+		ssize_t n = sendfile(dst, src, 0, (size_t)min(left, (Long)1 << 30));
+		if (n <= 0)
+			break;
+		left -= n;
+	}
+#endif
+	if (left > 0 || info.st_size == 0)
+	{
+		Array<byte> buffer(1 << 18);
+		while (1)
+		{
+			ssize_t n = read(src, buffer.ptr(), buffer.length());
+			if (n <= 0)
+			{
+				ok = n == 0;
+				break;
+			}
+			if (write(dst, buffer.ptr(), n) != n)
+			{
+				ok = false;
+				break;
+			}
+		}
+	}
+	close(src);
+	return close(dst) == 0 && ok;
 }
 
 bool Directory::move(const String& from, const String& to)
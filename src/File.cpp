@@ -19,6 +19,7 @@
 #else
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <errno.h>
 #include <utime.h>
@@ -306,6 +307,46 @@ int File::write(const void* p, int n)
 	return (int)fwrite(p, 1, n, _file);
 }
 
+Long File::writeBlocks(const StringView* blocks, int n)
+{
+	Long written = 0;
+#ifndef _WIN32
+	// bypass stdio and hand the blocks to the kernel in one call, keeping the stream position in sync
+	fflush(_file);
+	int fd = fileno(_file);
+	iovec iov[64];
+	int i = 0, k = 0;
+	while (i < n)
+	{
+		for (k = 0; k < 64 && i + k < n; k++)
+		{
+			iov[k].iov_base = (void*)blocks[i + k].data();
+			iov[k].iov_len = blocks[i + k].length();
+		}
+		ssize_t m = ::writev(fd, iov, k);
+		if (m < 0)
+			break;
+		written += m;
+		for (int j = 0; j < k && m >= (ssize_t)iov[j].iov_len; j++, i++)
+			m -= iov[j].iov_len;
+		if (m > 0) // partial block: write the rest normally
+		{
+			const StringView& b = blocks[i++];
+			if (::write(fd, b.data() + m, b.length() - m) != b.length() - m)
+				break;
+			written += b.length() - m;
+		}
+	}
+	off_t pos = lseek(fd, 0, SEEK_CUR);
+	if (pos >= 0)
+		fseeko(_file, pos, SEEK_SET);
+#else
+	for (int i = 0; i < n; i++)
+		written += fwrite(blocks[i].data(), 1, blocks[i].length(), _file);
+#endif
+	return written;
+}
+
 File File::temp(const String& ext)
 {
 	File file;
@@ -4,6 +4,8 @@
 #include <asl/IniFile.h>
 #include <asl/Http.h>
 #include <asl/JSON.h>
+#include <asl/Cbor.h>
+#include <asl/StringBuilder.h>
 #include <asl/TlsSocket.h>
 #include <ctype.h>
 
@@ -138,6 +140,8 @@ String HttpMessage::text() const
 
 Var HttpMessage::json() const
 {
+	if (header("Content-Type") == "application/cbor")
+		return Cbor::decode(_body);
 	String str = _body;
 	Var data = Json::decode(str);
 	return data.ok() ? data : Var(decodeUrlParams(str));
@@ -164,9 +168,23 @@ void HttpMessage::put(const Var& body)
 			dic[encodeUrl(k)] = encodeUrl(v);
 		put(dic.join('&', '='));
 	}
+	else if (header("Content-Type") == "application/cbor")
+	{
+		put(Cbor::encode(body));
+	}
 	else
 	{
-		put(Json::encode(body));
+		StringBuilder out;
+		Json::encode(body, out);
+		_body = Array<byte>((int)out.length());
+		byte* p = _body.ptr();
+		for (int i = 0; i < out.numBlocks(); i++)
+		{
+			StringView b = out.block(i);
+			memcpy(p, b.data(), b.length());
+			p += b.length();
+		}
+		setHeader("Content-Length", _body.length());
 		setHeader("Content-Type", "application/json");
 	}
 }
@@ -210,14 +228,14 @@ void HttpMessage::readHeaders()
 			setHeader(headerName, headerValue + line.trimmed());
 			continue;
 		}
-		line.trim();
-		int i = line.indexOf(':');
+		StringView header = line.trimmedView();
+		int i = header.indexOf(':');
 		if (i<0) {
 			_socket->close();
 			return;
 		}
-		headerName = line.substring(0, i);
-		headerValue = (i < line.length() - 1) ? line.substring(i + 2) : String();
+		headerName = header.substring(0, i);
+		headerValue = header.substring(i + 1).trimmed();
 		setHeader(headerName, headerValue);
 	}
 }
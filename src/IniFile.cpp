@@ -46,7 +46,7 @@ IniFile::IniFile(const String& name, bool shouldwrite)
 			int end = line.indexOf(']', 1);
 			if(end < 0)
 				continue;
-			String name = line.substring(1, end);
+			String name = line.view(1, end);
 			_currentTitle = name;
 			_sections[_currentTitle] = Section(_currentTitle);
 		}
@@ -67,8 +67,8 @@ IniFile::IniFile(const String& name, bool shouldwrite)
 					else
 						break;
 				}
-			String key = line.substring(0,i).trimmed();
-			String value = line.substring(i+1).trimmed();
+			String key = line.view(0, i).trimmed();
+			String value = line.view(i + 1).trimmed();
 			for(char* p=key; *p; p++)
 				if(*p == '/')
 					*p = '\\';
@@ -164,7 +164,7 @@ void IniFile::write(const String& fname)
 			int end = line.indexOf(']');
 			if (end < 0)
 				continue;
-			String name = line.substring(1, end);
+			String name = line.view(1, end);
 			_currentTitle = name;
 			section = &_sections[name];
 		}
@@ -173,8 +173,8 @@ void IniFile::write(const String& fname)
 			int i=line.indexOf('=');
 			if (i < 0)
 				continue;
-			String key = line.substring(0,i).trimmed();
-			String value0 = line.substring(i+1).trimmed();
+			String key = line.view(0, i).trimmed();
+			String value0 = line.view(i + 1).trimmed();
 			const String& value1 = (*section)[key];
 			line = _indent; line << key << '=' << value1;
 			if(value0 != value1 && value1 != "")
@@ -0,0 +1,110 @@
+#include <asl/MappedFile.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#ifdef ASL_ANSI
+#define CreateFileX CreateFileA
+#else
+#define CreateFileX CreateFileW
+#endif
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace asl {
+
+#ifdef _WIN32
+
+bool MappedFile::open(const String& name)
+{
+	close();
+	HANDLE file = CreateFileX(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || (sizeof(void*) < 8 && size.QuadPart > 0x7fffffff))
+	{
+		CloseHandle(file);
+		return false;
+	}
+	_handle = file;
+	_length = size.QuadPart;
+	if (_length > 0)
+	{
+		_mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (_mapping)
+			_data = (const byte*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!_data)
+		{
+			close();
+			return false;
+		}
+	}
+	_ok = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_handle)
+		CloseHandle(_handle);
+	_data = 0;
+	_mapping = 0;
+	_handle = 0;
+	_length = 0;
+	_ok = false;
+}
+
+#else
+
+bool MappedFile::open(const String& name)
+{
+	close();
+	int fd = ::open(name, O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (sizeof(void*) < 8 && info.st_size > 0x7fffffff))
+	{
+		::close(fd);
+		return false;
+	}
+	_length = info.st_size;
+	if (_length > 0)
+	{
+		void* p = mmap(0, (size_t)_length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+		{
+			::close(fd);
+			_length = 0;
+			return false;
+		}
+		_data = (const byte*)p;
+#ifdef MADV_SEQUENTIAL
+		madvise(p, (size_t)_length, MADV_SEQUENTIAL);
+#endif
+	}
+	::close(fd);
+	_ok = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data)
+		munmap((void*)_data, (size_t)_length);
+	_data = 0;
+	_length = 0;
+	_ok = false;
+}
+
+#endif
+
+}
@@ -0,0 +1,223 @@
+#include <asl/Matrix.h>
+#include <asl/Thread.h>
+
+#include "simd.h"
+
+namespace asl {
+
+// Matrix product with the GotoBLAS scheme: B is packed in KC x NC blocks of NR-column panels, A in MC x KC blocks
+// of MR-row panels, and a micro-kernel accumulates MR x NR tiles of C in registers.
+
+enum { GEMM_MC = 96, GEMM_KC = 256, GEMM_NC = 2048 };
+
+template<class T, int MR>
+static void packA(int mc, int kc, const T* a, int lda, T* ap)
+{
+	for (int i0 = 0; i0 < mc; i0 += MR, ap += MR * kc)
+	{
+		int mr = min(MR, mc - i0);
+		for (int p = 0; p < kc; p++)
+			for (int i = 0; i < MR; i++)
+				ap[p * MR + i] = i < mr ? a[(i0 + i) * lda + p] : T(0);
+	}
+}
+
+template<class T, int NR>
+static void packB(int kc, int nc, const T* b, int ldb, T* bp)
+{
+	for (int j0 = 0; j0 < nc; j0 += NR, bp += NR * kc)
+	{
+		int nr = min(NR, nc - j0);
+		for (int p = 0; p < kc; p++)
+		{
+			const T* bj = b + p * ldb + j0;
+			T* q = bp + p * NR;
+			for (int j = 0; j < nr; j++)
+				q[j] = bj[j];
+			for (int j = nr; j < NR; j++)
+				q[j] = T(0);
+		}
+	}
+}
+
+// Adds a computed tile to the mr x nr valid part of C
+
+template<class T, int NR>
+static inline void addTile(const T* t, T* c, int ldc, int mr, int nr)
+{
+	for (int i = 0; i < mr; i++)
+		for (int j = 0; j < nr; j++)
+			c[i * ldc + j] += t[i * NR + j];
+}
+
+template<class T, int MR, int NR>
+static void kernelScalar(int kc, const T* a, const T* b, T* c, int ldc, int mr, int nr)
+{
+	T t[MR * NR] = { 0 };
+	for (int p = 0; p < kc; p++, a += MR, b += NR)
+		for (int i = 0; i < MR; i++)
+		{
+			T ai = a[i];
+			for (int j = 0; j < NR; j++)
+				t[i * NR + j] += ai * b[j];
+		}
+	addTile<T, NR>(t, c, ldc, mr, nr);
+}
+
+#ifdef ASL_X86_AVX2
+
+ASL_TARGET_AVX2 static void kernelAvx2(int kc, const double* a, const double* b, double* c, int ldc, int mr, int nr)
+{
+	__m256d c00 = _mm256_setzero_pd(), c01 = c00, c10 = c00, c11 = c00, c20 = c00, c21 = c00,
+		c30 = c00, c31 = c00, c40 = c00, c41 = c00, c50 = c00, c51 = c00;
+	for (int p = 0; p < kc; p++, a += 6, b += 8)
+	{
+		__m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4), ai;
+		ai = _mm256_broadcast_sd(a);     c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+		ai = _mm256_broadcast_sd(a + 1); c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+		ai = _mm256_broadcast_sd(a + 2); c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+		ai = _mm256_broadcast_sd(a + 3); c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+		ai = _mm256_broadcast_sd(a + 4); c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+		ai = _mm256_broadcast_sd(a + 5); c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+	}
+	__m256d t[12] = { c00, c01, c10, c11, c20, c21, c30, c31, c40, c41, c50, c51 };
+	if (mr == 6 && nr == 8)
+	{
+		for (int i = 0; i < 6; i++, c += ldc)
+		{
+			_mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), t[2 * i]));
+			_mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), t[2 * i + 1]));
+		}
+	}
+	else
+		addTile<double, 8>((const double*)t, c, ldc, mr, nr);
+}
+
+ASL_TARGET_AVX2 static void kernelAvx2(int kc, const float* a, const float* b, float* c, int ldc, int mr, int nr)
+{
+	__m256 c00 = _mm256_setzero_ps(), c01 = c00, c10 = c00, c11 = c00, c20 = c00, c21 = c00,
+		c30 = c00, c31 = c00, c40 = c00, c41 = c00, c50 = c00, c51 = c00;
+	for (int p = 0; p < kc; p++, a += 6, b += 16)
+	{
+		__m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8), ai;
+		ai = _mm256_broadcast_ss(a);     c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+		ai = _mm256_broadcast_ss(a + 1); c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+		ai = _mm256_broadcast_ss(a + 2); c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+		ai = _mm256_broadcast_ss(a + 3); c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+		ai = _mm256_broadcast_ss(a + 4); c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+		ai = _mm256_broadcast_ss(a + 5); c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+	}
+	__m256 t[12] = { c00, c01, c10, c11, c20, c21, c30, c31, c40, c41, c50, c51 };
+	if (mr == 6 && nr == 16)
+	{
+		for (int i = 0; i < 6; i++, c += ldc)
+		{
+			_mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), t[2 * i]));
+			_mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), t[2 * i + 1]));
+		}
+	}
+	else
+		addTile<float, 16>((const float*)t, c, ldc, mr, nr);
+}
+
+#endif
+
+template<class T, int MR, int NR, void (*kernel)(int, const T*, const T*, T*, int, int, int)>
+static void gemmBlocked(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc)
+{
+	int ncMax = min((int)GEMM_NC, (n + NR - 1) / NR * NR);
+	Array<T> ap(GEMM_MC * GEMM_KC), bp(GEMM_KC * ncMax);
+	for (int jc = 0; jc < n; jc += GEMM_NC)
+	{
+		int nc = min((int)GEMM_NC, n - jc);
+		for (int pc = 0; pc < k; pc += GEMM_KC)
+		{
+			int kc = min((int)GEMM_KC, k - pc);
+			packB<T, NR>(kc, nc, b + pc * ldb + jc, ldb, bp.ptr());
+			for (int ic = 0; ic < m; ic += GEMM_MC)
+			{
+				int mc = min((int)GEMM_MC, m - ic);
+				packA<T, MR>(mc, kc, a + ic * lda + pc, lda, ap.ptr());
+				for (int jr = 0; jr < nc; jr += NR)
+					for (int ir = 0; ir < mc; ir += MR)
+						kernel(kc, ap.ptr() + ir * kc, bp.ptr() + jr * kc, c + (ic + ir) * ldc + jc + jr, ldc,
+							min(MR, mc - ir), min(NR, nc - jr));
+			}
+		}
+	}
+}
+
+// Plain row-oriented product for small matrices, where packing does not pay off
+
+template<class T>
+static void gemmSmall(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc)
+{
+	for (int i = 0; i < m; i++)
+	{
+		const T* ai = a + i * lda;
+		T* ci = c + i * ldc;
+		for (int p = 0; p < k; p++)
+		{
+			T aip = ai[p];
+			const T* bp = b + p * ldb;
+			for (int j = 0; j < n; j++)
+				ci[j] += aip * bp[j];
+		}
+	}
+}
+
+template<class T>
+static void gemmSerial(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc)
+{
+	for (int i = 0; i < m; i++)
+		for (int j = 0; j < n; j++)
+			c[i * ldc + j] = T(0);
+
+	if (n < 4 || (double)m * n * k < 32768)
+	{
+		gemmSmall(m, n, k, a, lda, b, ldb, c, ldc);
+		return;
+	}
+#ifdef ASL_X86_AVX2
+	if (hasAvx2())
+	{
+		gemmBlocked<T, 6, 32 / sizeof(T) * 2, kernelAvx2>(m, n, k, a, lda, b, ldb, c, ldc);
+		return;
+	}
+#endif
+	gemmBlocked<T, 4, 4, kernelScalar<T, 4, 4> >(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+template<class T>
+static void gemm(int m, int n, int k, const T* a, int lda, const T* b, int ldb, T* c, int ldc, int nthreads)
+{
+	if (nthreads > 1 && (double)m * n * k >= 1e6)
+		nthreads = clamp(min(nthreads, Thread::numProcessors()), 1, max(1, m / GEMM_MC));
+	if (nthreads <= 1 || (double)m * n * k < 1e6)
+	{
+		gemmSerial(m, n, k, a, lda, b, ldb, c, ldc);
+		return;
+	}
+	int rowsPerThread = (m + nthreads - 1) / nthreads;
+#ifdef ASL_EXP_THREADING
+	Thread::parallel_for(0, nthreads, [=](int t) {
+		int i0 = t * rowsPerThread, i1 = min(m, i0 + rowsPerThread);
+		if (i1 > i0)
+			gemmSerial(i1 - i0, n, k, a + i0 * lda, lda, b, ldb, c + i0 * ldc, ldc);
+	}, nthreads);
+#else
+	gemmSerial(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+}
+
+void matmul(int m, int n, int k, const float* a, int lda, const float* b, int ldb, float* c, int ldc, int nthreads)
+{
+	gemm(m, n, k, a, lda, b, ldb, c, ldc, nthreads);
+}
+
+void matmul(int m, int n, int k, const double* a, int lda, const double* b, int ldb, double* c, int ldc, int nthreads)
+{
+	gemm(m, n, k, a, lda, b, ldb, c, ldc, nthreads);
+}
+
+}
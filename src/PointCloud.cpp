@@ -0,0 +1,736 @@
+#include <asl/PointCloud.h>
+#include <asl/Thread.h>
+#include "simd.h"
+
+#ifdef ASL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace asl {
+
+// Runs f(i0, i1) on consecutive ranges of [0, n), in parallel if n is at least minSize
+
+template<class F>
+struct ChunkRunner
+{
+	const F& f;
+	int n, nth;
+	ChunkRunner(const F& f, int n, int nth) : f(f), n(n), nth(nth) {}
+	void operator()(int t) const { f(int((Long)n * t / nth), int((Long)n * (t + 1) / nth)); }
+};
+
+template<class F>
+static void forChunks(int n, int nthreads, const F& f, int minSize = 65536)
+{
+	if (nthreads > 1 && n >= minSize)
+		nthreads = min(nthreads, Thread::numProcessors());
+	if (nthreads <= 1 || n < minSize)
+	{
+		f(0, n);
+		return;
+	}
+#ifdef ASL_EXP_THREADING
+	Thread::parallel_for(0, nthreads, ChunkRunner<F>(f, n, nthreads), nthreads);
+#else
+	f(0, n);
+#endif
+}
+
+template<class T>
+static inline bool isAffine(const T* m)
+{
+	return m[12] == 0 && m[13] == 0 && m[14] == 0 && m[15] == 1;
+}
+
+template<class T>
+static void transformSoA(const T* m, const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, int i0, int i1)
+{
+	T m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3], m10 = m[4], m11 = m[5], m12 = m[6], m13 = m[7],
+		m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11], m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+	if (isAffine(m))
+	{
+		for (int i = i0; i < i1; i++)
+		{
+			T X = x[i], Y = y[i], Z = z[i];
+			ox[i] = m00 * X + m01 * Y + m02 * Z + m03;
+			oy[i] = m10 * X + m11 * Y + m12 * Z + m13;
+			oz[i] = m20 * X + m21 * Y + m22 * Z + m23;
+		}
+	}
+	else
+	{
+		for (int i = i0; i < i1; i++)
+		{
+			T X = x[i], Y = y[i], Z = z[i];
+			T w = 1 / (m30 * X + m31 * Y + m32 * Z + m33);
+			ox[i] = (m00 * X + m01 * Y + m02 * Z + m03) * w;
+			oy[i] = (m10 * X + m11 * Y + m12 * Z + m13) * w;
+			oz[i] = (m20 * X + m21 * Y + m22 * Z + m23) * w;
+		}
+	}
+}
+
+template<class T>
+static void transformAoS(const T* m, const T* in, T* out, int i0, int i1)
+{
+	T m00 = m[0], m01 = m[1], m02 = m[2], m03 = m[3], m10 = m[4], m11 = m[5], m12 = m[6], m13 = m[7],
+		m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11], m30 = m[12], m31 = m[13], m32 = m[14], m33 = m[15];
+	bool affine = isAffine(m);
+	for (int i = i0; i < i1; i++)
+	{
+		const T* p = in + 3 * i;
+		T X = p[0], Y = p[1], Z = p[2];
+		T w = affine ? T(1) : 1 / (m30 * X + m31 * Y + m32 * Z + m33);
+		T* q = out + 3 * i;
+		q[0] = (m00 * X + m01 * Y + m02 * Z + m03) * w;
+		q[1] = (m10 * X + m11 * Y + m12 * Z + m13) * w;
+		q[2] = (m20 * X + m21 * Y + m22 * Z + m23) * w;
+	}
+}
+
+#ifdef ASL_X86_AVX2
+
+// 8 floats or 4 doubles per iteration
+
+struct Avx8f
+{
+	typedef float T;
+	typedef __m256 V;
+	enum { N = 8 };
+	ASL_TARGET_AVX2 static V set1(float x) { return _mm256_set1_ps(x); }
+	ASL_TARGET_AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+	ASL_TARGET_AVX2 static void store(float* p, V x) { _mm256_storeu_ps(p, x); }
+	ASL_TARGET_AVX2 static V fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	ASL_TARGET_AVX2 static V div(V a, V b) { return _mm256_div_ps(a, b); }
+	ASL_TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+	ASL_TARGET_AVX2 static V lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	ASL_TARGET_AVX2 static V eq(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+	ASL_TARGET_AVX2 static V select(V m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+	// Loads 8 groups of 4 values (group k at p + k * s) as 4 vectors q[j] holding element j of each group
+	ASL_TARGET_AVX2 static void load4(const float* p, int s, V* q)
+	{
+		V r[4];
+		for (int k = 0; k < 4; k++)
+			r[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + k * s)), _mm_loadu_ps(p + (k + 4) * s), 1);
+		transpose4(r, q);
+	}
+	ASL_TARGET_AVX2 static void store4(float* p, int s, const V* q)
+	{
+		V r[4];
+		transpose4(q, r);
+		for (int k = 0; k < 4; k++)
+		{
+			_mm_storeu_ps(p + k * s, _mm256_castps256_ps128(r[k]));
+			_mm_storeu_ps(p + (k + 4) * s, _mm256_extractf128_ps(r[k], 1));
+		}
+	}
+	ASL_TARGET_AVX2 static void transpose4(const V* r, V* q)
+	{
+		V t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+		V t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+		q[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		q[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		q[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		q[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+};
+
+struct Avx4d
+{
+	typedef double T;
+	typedef __m256d V;
+	enum { N = 4 };
+	ASL_TARGET_AVX2 static V set1(double x) { return _mm256_set1_pd(x); }
+	ASL_TARGET_AVX2 static V load(const double* p) { return _mm256_loadu_pd(p); }
+	ASL_TARGET_AVX2 static void store(double* p, V x) { _mm256_storeu_pd(p, x); }
+	ASL_TARGET_AVX2 static V fma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+	ASL_TARGET_AVX2 static V add(V a, V b) { return _mm256_add_pd(a, b); }
+	ASL_TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+	ASL_TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+	ASL_TARGET_AVX2 static V div(V a, V b) { return _mm256_div_pd(a, b); }
+	ASL_TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+	ASL_TARGET_AVX2 static V lt(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	ASL_TARGET_AVX2 static V eq(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+	ASL_TARGET_AVX2 static V select(V m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+	ASL_TARGET_AVX2 static void load4(const double* p, int s, V* q)
+	{
+		V r[4];
+		for (int k = 0; k < 4; k++)
+			r[k] = _mm256_loadu_pd(p + k * s);
+		transpose4(r, q);
+	}
+	ASL_TARGET_AVX2 static void store4(double* p, int s, const V* q)
+	{
+		V r[4];
+		transpose4(q, r);
+		for (int k = 0; k < 4; k++)
+			_mm256_storeu_pd(p + k * s, r[k]);
+	}
+	ASL_TARGET_AVX2 static void transpose4(const V* r, V* q)
+	{
+		V t0 = _mm256_unpacklo_pd(r[0], r[1]), t1 = _mm256_unpackhi_pd(r[0], r[1]);
+		V t2 = _mm256_unpacklo_pd(r[2], r[3]), t3 = _mm256_unpackhi_pd(r[2], r[3]);
+		q[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+		q[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+		q[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+		q[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+	}
+};
+
+template<class T> struct AvxOf;
+template<> struct AvxOf<float> { typedef Avx8f Type; };
+template<> struct AvxOf<double> { typedef Avx4d Type; };
+
+template<class S, class T>
+ASL_TARGET_AVX2 static void transformSoAAvx(const T* m, const T* x, const T* y, const T* z, T* ox, T* oy, T* oz, int i0, int i1)
+{
+	typedef typename S::V V;
+	V m00 = S::set1(m[0]), m01 = S::set1(m[1]), m02 = S::set1(m[2]), m03 = S::set1(m[3]),
+		m10 = S::set1(m[4]), m11 = S::set1(m[5]), m12 = S::set1(m[6]), m13 = S::set1(m[7]),
+		m20 = S::set1(m[8]), m21 = S::set1(m[9]), m22 = S::set1(m[10]), m23 = S::set1(m[11]),
+		m30 = S::set1(m[12]), m31 = S::set1(m[13]), m32 = S::set1(m[14]), m33 = S::set1(m[15]), one = S::set1(1);
+	bool affine = isAffine(m);
+	int i = i0;
+	for (; i + S::N <= i1; i += S::N)
+	{
+		V X = S::load(x + i), Y = S::load(y + i), Z = S::load(z + i);
+		V rx = S::fma(m00, X, S::fma(m01, Y, S::fma(m02, Z, m03)));
+		V ry = S::fma(m10, X, S::fma(m11, Y, S::fma(m12, Z, m13)));
+		V rz = S::fma(m20, X, S::fma(m21, Y, S::fma(m22, Z, m23)));
+		if (!affine)
+		{
+			V w = S::div(one, S::fma(m30, X, S::fma(m31, Y, S::fma(m32, Z, m33))));
+			rx = S::mul(rx, w);
+			ry = S::mul(ry, w);
+			rz = S::mul(rz, w);
+		}
+		S::store(ox + i, rx);
+		S::store(oy + i, ry);
+		S::store(oz + i, rz);
+	}
+	transformSoA(m, x, y, z, ox, oy, oz, i, i1);
+}
+
+// AoS with AVX2: 3 loads hold 8 float (or 4 double) points; blending them gives each coordinate in a fixed
+// scrambled order, which one permutation sorts. The same blends and permutations put the results back.
+
+ASL_TARGET_AVX2 static void transformAoSAvx(const float* m, const float* in, float* out, int i0, int i1)
+{
+	__m256 m00 = _mm256_set1_ps(m[0]), m01 = _mm256_set1_ps(m[1]), m02 = _mm256_set1_ps(m[2]), m03 = _mm256_set1_ps(m[3]),
+		m10 = _mm256_set1_ps(m[4]), m11 = _mm256_set1_ps(m[5]), m12 = _mm256_set1_ps(m[6]), m13 = _mm256_set1_ps(m[7]),
+		m20 = _mm256_set1_ps(m[8]), m21 = _mm256_set1_ps(m[9]), m22 = _mm256_set1_ps(m[10]), m23 = _mm256_set1_ps(m[11]),
+		m30 = _mm256_set1_ps(m[12]), m31 = _mm256_set1_ps(m[13]), m32 = _mm256_set1_ps(m[14]), m33 = _mm256_set1_ps(m[15]),
+		one = _mm256_set1_ps(1.0f);
+	__m256i px = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5), py = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6),
+		pyr = _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2), pz = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+	bool affine = isAffine(m);
+	int i = i0;
+	for (; i + 8 <= i1; i += 8)
+	{
+		const float* p = in + 3 * i;
+		__m256 a = _mm256_loadu_ps(p), b = _mm256_loadu_ps(p + 8), c = _mm256_loadu_ps(p + 16);
+		__m256 X = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(a, b, 0x92), c, 0x24), px);
+		__m256 Y = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(c, a, 0x92), b, 0x24), py);
+		__m256 Z = _mm256_permutevar8x32_ps(_mm256_blend_ps(_mm256_blend_ps(b, c, 0x92), a, 0x24), pz);
+		__m256 rx = _mm256_fmadd_ps(m00, X, _mm256_fmadd_ps(m01, Y, _mm256_fmadd_ps(m02, Z, m03)));
+		__m256 ry = _mm256_fmadd_ps(m10, X, _mm256_fmadd_ps(m11, Y, _mm256_fmadd_ps(m12, Z, m13)));
+		__m256 rz = _mm256_fmadd_ps(m20, X, _mm256_fmadd_ps(m21, Y, _mm256_fmadd_ps(m22, Z, m23)));
+		if (!affine)
+		{
+			__m256 w = _mm256_div_ps(one, _mm256_fmadd_ps(m30, X, _mm256_fmadd_ps(m31, Y, _mm256_fmadd_ps(m32, Z, m33))));
+			rx = _mm256_mul_ps(rx, w);
+			ry = _mm256_mul_ps(ry, w);
+			rz = _mm256_mul_ps(rz, w);
+		}
+		rx = _mm256_permutevar8x32_ps(rx, px);
+		ry = _mm256_permutevar8x32_ps(ry, pyr);
+		rz = _mm256_permutevar8x32_ps(rz, pz);
+		float* q = out + 3 * i;
+		_mm256_storeu_ps(q, _mm256_blend_ps(_mm256_blend_ps(rx, ry, 0x92), rz, 0x24));
+		_mm256_storeu_ps(q + 8, _mm256_blend_ps(_mm256_blend_ps(rz, rx, 0x92), ry, 0x24));
+		_mm256_storeu_ps(q + 16, _mm256_blend_ps(_mm256_blend_ps(ry, rz, 0x92), rx, 0x24));
+	}
+	transformAoS(m, in, out, i, i1);
+}
+
+ASL_TARGET_AVX2 static void transformAoSAvx(const double* m, const double* in, double* out, int i0, int i1)
+{
+	__m256d m00 = _mm256_set1_pd(m[0]), m01 = _mm256_set1_pd(m[1]), m02 = _mm256_set1_pd(m[2]), m03 = _mm256_set1_pd(m[3]),
+		m10 = _mm256_set1_pd(m[4]), m11 = _mm256_set1_pd(m[5]), m12 = _mm256_set1_pd(m[6]), m13 = _mm256_set1_pd(m[7]),
+		m20 = _mm256_set1_pd(m[8]), m21 = _mm256_set1_pd(m[9]), m22 = _mm256_set1_pd(m[10]), m23 = _mm256_set1_pd(m[11]),
+		m30 = _mm256_set1_pd(m[12]), m31 = _mm256_set1_pd(m[13]), m32 = _mm256_set1_pd(m[14]), m33 = _mm256_set1_pd(m[15]),
+		one = _mm256_set1_pd(1.0);
+	bool affine = isAffine(m);
+	int i = i0;
+	for (; i + 4 <= i1; i += 4)
+	{
+		const double* p = in + 3 * i;
+		__m256d a = _mm256_loadu_pd(p), b = _mm256_loadu_pd(p + 4), c = _mm256_loadu_pd(p + 8);
+		__m256d X = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(a, b, 4), c, 2), _MM_SHUFFLE(1, 2, 3, 0));
+		__m256d Y = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(b, a, 2), c, 4), _MM_SHUFFLE(2, 3, 0, 1));
+		__m256d Z = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(c, a, 4), b, 2), _MM_SHUFFLE(3, 0, 1, 2));
+		__m256d rx = _mm256_fmadd_pd(m00, X, _mm256_fmadd_pd(m01, Y, _mm256_fmadd_pd(m02, Z, m03)));
+		__m256d ry = _mm256_fmadd_pd(m10, X, _mm256_fmadd_pd(m11, Y, _mm256_fmadd_pd(m12, Z, m13)));
+		__m256d rz = _mm256_fmadd_pd(m20, X, _mm256_fmadd_pd(m21, Y, _mm256_fmadd_pd(m22, Z, m23)));
+		if (!affine)
+		{
+			__m256d w = _mm256_div_pd(one, _mm256_fmadd_pd(m30, X, _mm256_fmadd_pd(m31, Y, _mm256_fmadd_pd(m32, Z, m33))));
+			rx = _mm256_mul_pd(rx, w);
+			ry = _mm256_mul_pd(ry, w);
+			rz = _mm256_mul_pd(rz, w);
+		}
+		rx = _mm256_permute4x64_pd(rx, _MM_SHUFFLE(1, 2, 3, 0));
+		ry = _mm256_permute4x64_pd(ry, _MM_SHUFFLE(2, 3, 0, 1));
+		rz = _mm256_permute4x64_pd(rz, _MM_SHUFFLE(3, 0, 1, 2));
+		double* q = out + 3 * i;
+		_mm256_storeu_pd(q, _mm256_blend_pd(_mm256_blend_pd(rx, ry, 2), rz, 4));
+		_mm256_storeu_pd(q + 4, _mm256_blend_pd(_mm256_blend_pd(ry, rz, 2), rx, 4));
+		_mm256_storeu_pd(q + 8, _mm256_blend_pd(_mm256_blend_pd(rz, rx, 2), ry, 4));
+	}
+	transformAoS(m, in, out, i, i1);
+}
+
+#endif
+
+#ifdef ASL_HAVE_SSE2
+
+#define ASL_SHUF(a, b, i0, i1, j0, j1) _mm_shuffle_ps(a, b, _MM_SHUFFLE(j1, j0, i1, i0))
+
+// 4 points per iteration: 3 loads give x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, which are shuffled into x, y, z
+// vectors, transformed, and shuffled back
+
+static void transformAoSSse(const float* m, const float* in, float* out, int i0, int i1)
+{
+	__m128 m00 = _mm_set1_ps(m[0]), m01 = _mm_set1_ps(m[1]), m02 = _mm_set1_ps(m[2]), m03 = _mm_set1_ps(m[3]),
+		m10 = _mm_set1_ps(m[4]), m11 = _mm_set1_ps(m[5]), m12 = _mm_set1_ps(m[6]), m13 = _mm_set1_ps(m[7]),
+		m20 = _mm_set1_ps(m[8]), m21 = _mm_set1_ps(m[9]), m22 = _mm_set1_ps(m[10]), m23 = _mm_set1_ps(m[11]),
+		m30 = _mm_set1_ps(m[12]), m31 = _mm_set1_ps(m[13]), m32 = _mm_set1_ps(m[14]), m33 = _mm_set1_ps(m[15]),
+		one = _mm_set1_ps(1.0f);
+	bool affine = isAffine(m);
+	int i = i0;
+	for (; i + 4 <= i1; i += 4)
+	{
+		const float* p = in + 3 * i;
+		__m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+		__m128 X = ASL_SHUF(a, ASL_SHUF(b, c, 2, 0, 1, 0), 0, 3, 0, 2);
+		__m128 Y = ASL_SHUF(ASL_SHUF(a, b, 1, 0, 0, 0), ASL_SHUF(b, c, 3, 0, 2, 0), 0, 2, 0, 2);
+		__m128 Z = ASL_SHUF(ASL_SHUF(a, b, 2, 0, 1, 0), ASL_SHUF(c, c, 0, 0, 3, 0), 0, 2, 0, 2);
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, X), _mm_mul_ps(m01, Y)), _mm_add_ps(_mm_mul_ps(m02, Z), m03));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, X), _mm_mul_ps(m11, Y)), _mm_add_ps(_mm_mul_ps(m12, Z), m13));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, X), _mm_mul_ps(m21, Y)), _mm_add_ps(_mm_mul_ps(m22, Z), m23));
+		if (!affine)
+		{
+			__m128 w = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m30, X), _mm_mul_ps(m31, Y)), _mm_add_ps(_mm_mul_ps(m32, Z), m33));
+			w = _mm_div_ps(one, w);
+			rx = _mm_mul_ps(rx, w);
+			ry = _mm_mul_ps(ry, w);
+			rz = _mm_mul_ps(rz, w);
+		}
+		float* q = out + 3 * i;
+		_mm_storeu_ps(q, ASL_SHUF(ASL_SHUF(rx, ry, 0, 0, 0, 0), ASL_SHUF(rz, rx, 0, 0, 1, 0), 0, 2, 0, 2));
+		_mm_storeu_ps(q + 4, ASL_SHUF(ASL_SHUF(ry, rz, 1, 0, 1, 0), ASL_SHUF(rx, ry, 2, 0, 2, 0), 0, 2, 0, 2));
+		_mm_storeu_ps(q + 8, ASL_SHUF(ASL_SHUF(rz, rx, 2, 0, 3, 0), ASL_SHUF(ry, rz, 3, 0, 3, 0), 0, 2, 0, 2));
+	}
+	transformAoS(m, in, out, i, i1);
+}
+
+#endif
+
+template<class T>
+static void transformAoSFallback(const T* m, const T* in, T* out, int i0, int i1)
+{
+	transformAoS(m, in, out, i0, i1);
+}
+
+#ifdef ASL_HAVE_SSE2
+static void transformAoSFallback(const float* m, const float* in, float* out, int i0, int i1)
+{
+	transformAoSSse(m, in, out, i0, i1);
+}
+#endif
+
+template<class T>
+struct SoAKernel
+{
+	const T *m, *x, *y, *z;
+	T *ox, *oy, *oz;
+	void operator()(int i0, int i1) const
+	{
+#ifdef ASL_X86_AVX2
+		if (hasAvx2())
+		{
+			transformSoAAvx<typename AvxOf<T>::Type>(m, x, y, z, ox, oy, oz, i0, i1);
+			return;
+		}
+#endif
+		transformSoA(m, x, y, z, ox, oy, oz, i0, i1);
+	}
+};
+
+template<class T>
+struct AoSKernel
+{
+	const T* m;
+	const T* in;
+	T* out;
+	void operator()(int i0, int i1) const
+	{
+#ifdef ASL_X86_AVX2
+		if (hasAvx2())
+		{
+			transformAoSAvx(m, in, out, i0, i1);
+			return;
+		}
+#endif
+		transformAoSFallback(m, in, out, i0, i1);
+	}
+};
+
+void transformPoints(const float* m, const float* in, float* out, int n, int nthreads)
+{
+	AoSKernel<float> k = { m, in, out };
+	forChunks(n, nthreads, k);
+}
+
+void transformPoints(const double* m, const double* in, double* out, int n, int nthreads)
+{
+	AoSKernel<double> k = { m, in, out };
+	forChunks(n, nthreads, k);
+}
+
+void transformPoints(const float* m, const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, int n, int nthreads)
+{
+	SoAKernel<float> k = { m, x, y, z, ox, oy, oz };
+	forChunks(n, nthreads, k);
+}
+
+void transformPoints(const double* m, const double* x, const double* y, const double* z, double* ox, double* oy, double* oz, int n, int nthreads)
+{
+	SoAKernel<double> k = { m, x, y, z, ox, oy, oz };
+	forChunks(n, nthreads, k);
+}
+
+// Batch quaternion and pose operations. Quaternions are (w, x, y, z) quadruples and poses are a position followed
+// by a quaternion (7 values). The SIMD versions load 8 (float) or 4 (double) of them and transpose them to SoA.
+
+template<class T>
+static inline Quaternion_<T> loadQuaternion(const T* p) { return Quaternion_<T>(p[0], p[1], p[2], p[3]); }
+
+template<class T>
+static inline void storeQuaternion(T* p, const Quaternion_<T>& q)
+{
+	p[0] = q.w;
+	p[1] = q.x;
+	p[2] = q.y;
+	p[3] = q.z;
+}
+
+template<class T>
+static inline Pose_<T> loadPose(const T* p) { return Pose_<T>(Vec3_<T>(p[0], p[1], p[2]), loadQuaternion(p + 3)); }
+
+template<class T>
+static inline void storePose(T* p, const Pose_<T>& a)
+{
+	const Vec3_<T>& v = a.position();
+	p[0] = v.x;
+	p[1] = v.y;
+	p[2] = v.z;
+	storeQuaternion(p + 3, a.orientation());
+}
+
+template<class T>
+static void slerpScalar(const T* a, const T* b, const T* t, T* out, int i0, int i1)
+{
+	for (int i = i0; i < i1; i++)
+		storeQuaternion(out + 4 * i, loadQuaternion(a + 4 * i).slerp(loadQuaternion(b + 4 * i), t[i]));
+}
+
+template<class T>
+static void composeScalar(const T* a, const T* b, T* out, int i0, int i1)
+{
+	for (int i = i0; i < i1; i++)
+		storePose(out + 7 * i, loadPose(a + 7 * i) * loadPose(b + 7 * i));
+}
+
+template<class T>
+static void invertScalar(const T* a, T* out, int i0, int i1)
+{
+	for (int i = i0; i < i1; i++)
+		storePose(out + 7 * i, loadPose(a + 7 * i).inverse());
+}
+
+template<class T>
+static void interpolateScalar(const T* a, const T* b, const T* t, T* out, int i0, int i1)
+{
+	for (int i = i0; i < i1; i++)
+		storePose(out + 7 * i, loadPose(a + 7 * i).interpolate(loadPose(b + 7 * i), t[i]));
+}
+
+#ifdef ASL_X86_AVX2
+
+// Slerp uses theta = 2 atan(|a - b| / |a + b|), which stays accurate for small angles, with truncated Taylor series
+// of atan(x) for |x| <= tan(pi/8) and of sin(x) for x in [0, pi/2]; the number of terms gives the precision of T
+
+template<class T> struct SlerpTerms;
+template<> struct SlerpTerms<float> { enum { ATAN = 8, SIN = 7 }; };
+template<> struct SlerpTerms<double> { enum { ATAN = 19, SIN = 11 }; };
+
+static const double sinTaylor[] = { 1.0, -1.0 / 6, 1.0 / 120, -1.0 / 5040, 1.0 / 362880, -1.0 / 39916800,
+	1.0 / 6227020800.0, -1.0 / 1307674368000.0, 1.0 / 355687428096000.0, -1.0 / 121645100408832000.0,
+	1.0 / 51090942171709440000.0 };
+
+template<class S>
+ASL_TARGET_AVX2 static inline typename S::V atanPoly(typename S::V x)
+{
+	typedef typename S::T T;
+	typedef typename S::V V;
+	const int n = SlerpTerms<T>::ATAN;
+	V one = S::set1(1);
+	V big = S::lt(S::set1(T(0.41421356237309503)), x);
+	V y = S::select(big, S::div(S::sub(x, one), S::add(x, one)), x), y2 = S::mul(y, y);
+	V p = S::set1(T((n % 2 ? 1.0 : -1.0) / (2 * n - 1)));
+	for (int k = n - 2; k >= 0; k--)
+		p = S::fma(p, y2, S::set1(T((k % 2 ? -1.0 : 1.0) / (2 * k + 1))));
+	p = S::mul(p, y);
+	return S::select(big, S::add(p, S::set1(T(0.78539816339744831))), p);
+}
+
+template<class S>
+ASL_TARGET_AVX2 static inline typename S::V sinPoly(typename S::V x)
+{
+	typedef typename S::T T;
+	typedef typename S::V V;
+	const int n = SlerpTerms<T>::SIN;
+	V x2 = S::mul(x, x);
+	V p = S::set1(T(sinTaylor[n - 1]));
+	for (int k = n - 2; k >= 0; k--)
+		p = S::fma(p, x2, S::set1(T(sinTaylor[k])));
+	return S::mul(p, x);
+}
+
+template<class S>
+ASL_TARGET_AVX2 static inline void slerpSoA(typename S::V* a, const typename S::V* b, typename S::V t, typename S::V* q)
+{
+	typedef typename S::V V;
+	V zero = S::set1(0), one = S::set1(1);
+	V d = S::mul(a[0], b[0]);
+	for (int j = 1; j < 4; j++)
+		d = S::fma(a[j], b[j], d);
+	V neg = S::lt(d, zero), ss = zero, sd = zero;
+	for (int j = 0; j < 4; j++)
+	{
+		a[j] = S::select(neg, S::sub(zero, a[j]), a[j]);
+		V s = S::add(a[j], b[j]), e = S::sub(a[j], b[j]);
+		ss = S::fma(s, s, ss);
+		sd = S::fma(e, e, sd);
+	}
+	V r = S::sqrt(S::div(sd, ss)), h = atanPoly<S>(r), theta = S::add(h, h);
+	V isin = S::div(S::fma(r, r, one), S::add(r, r)); // 1 / sin(theta)
+	V wa = S::mul(sinPoly<S>(S::mul(S::sub(one, t), theta)), isin), wb = S::mul(sinPoly<S>(S::mul(t, theta)), isin);
+	V same = S::eq(r, zero);
+	wa = S::select(same, S::sub(one, t), wa);
+	wb = S::select(same, t, wb);
+	for (int j = 0; j < 4; j++)
+		q[j] = S::fma(wa, a[j], S::mul(wb, b[j]));
+}
+
+// Rotates v by the unit quaternion q: t = 2 q.xyz x v, v' = v + q.w t + q.xyz x t
+
+template<class S>
+ASL_TARGET_AVX2 static inline void rotateSoA(const typename S::V* q, const typename S::V* v, typename S::V* r)
+{
+	typedef typename S::V V;
+	V two = S::set1(2);
+	V tx = S::mul(two, S::sub(S::mul(q[2], v[2]), S::mul(q[3], v[1])));
+	V ty = S::mul(two, S::sub(S::mul(q[3], v[0]), S::mul(q[1], v[2])));
+	V tz = S::mul(two, S::sub(S::mul(q[1], v[1]), S::mul(q[2], v[0])));
+	r[0] = S::add(S::fma(q[0], tx, v[0]), S::sub(S::mul(q[2], tz), S::mul(q[3], ty)));
+	r[1] = S::add(S::fma(q[0], ty, v[1]), S::sub(S::mul(q[3], tx), S::mul(q[1], tz)));
+	r[2] = S::add(S::fma(q[0], tz, v[2]), S::sub(S::mul(q[1], ty), S::mul(q[2], tx)));
+}
+
+template<class S>
+ASL_TARGET_AVX2 static inline void multiplySoA(const typename S::V* a, const typename S::V* b, typename S::V* q)
+{
+	q[0] = S::sub(S::fma(a[0], b[0], S::set1(0)), S::fma(a[1], b[1], S::fma(a[2], b[2], S::mul(a[3], b[3]))));
+	q[1] = S::sub(S::fma(a[0], b[1], S::fma(a[1], b[0], S::mul(a[2], b[3]))), S::mul(a[3], b[2]));
+	q[2] = S::sub(S::fma(a[0], b[2], S::fma(a[2], b[0], S::mul(a[3], b[1]))), S::mul(a[1], b[3]));
+	q[3] = S::sub(S::fma(a[0], b[3], S::fma(a[1], b[2], S::mul(a[3], b[0]))), S::mul(a[2], b[1]));
+}
+
+template<class S, class T>
+ASL_TARGET_AVX2 static void slerpAvx(const T* a, const T* b, const T* t, T* out, int i0, int i1)
+{
+	typedef typename S::V V;
+	int i = i0;
+	for (; i + S::N <= i1; i += S::N)
+	{
+		V qa[4], qb[4], q[4];
+		S::load4(a + 4 * i, 4, qa);
+		S::load4(b + 4 * i, 4, qb);
+		slerpSoA<S>(qa, qb, S::load(t + i), q);
+		S::store4(out + 4 * i, 4, q);
+	}
+	slerpScalar(a, b, t, out, i, i1);
+}
+
+// A pose is loaded as two groups of 4: (x, y, z, w) at offset 0 and the quaternion at offset 3. Storing the
+// positions first lets the quaternions overwrite the extra element.
+
+template<class S, class T>
+ASL_TARGET_AVX2 static void composeAvx(const T* a, const T* b, T* out, int i0, int i1)
+{
+	typedef typename S::V V;
+	int i = i0;
+	for (; i + S::N <= i1; i += S::N)
+	{
+		V pa[4], qa[4], pb[4], qb[4], p[4], q[4];
+		S::load4(a + 7 * i, 7, pa);
+		S::load4(a + 7 * i + 3, 7, qa);
+		S::load4(b + 7 * i, 7, pb);
+		S::load4(b + 7 * i + 3, 7, qb);
+		rotateSoA<S>(qa, pb, p);
+		for (int j = 0; j < 3; j++)
+			p[j] = S::add(p[j], pa[j]);
+		p[3] = qa[0];
+		multiplySoA<S>(qa, qb, q);
+		S::store4(out + 7 * i, 7, p);
+		S::store4(out + 7 * i + 3, 7, q);
+	}
+	composeScalar(a, b, out, i, i1);
+}
+
+template<class S, class T>
+ASL_TARGET_AVX2 static void invertAvx(const T* a, T* out, int i0, int i1)
+{
+	typedef typename S::V V;
+	V zero = S::set1(0);
+	int i = i0;
+	for (; i + S::N <= i1; i += S::N)
+	{
+		V pa[4], q[4], p[4];
+		S::load4(a + 7 * i, 7, pa);
+		S::load4(a + 7 * i + 3, 7, q);
+		for (int j = 1; j < 4; j++)
+			q[j] = S::sub(zero, q[j]);
+		rotateSoA<S>(q, pa, p);
+		for (int j = 0; j < 3; j++)
+			p[j] = S::sub(zero, p[j]);
+		p[3] = q[0];
+		S::store4(out + 7 * i, 7, p);
+		S::store4(out + 7 * i + 3, 7, q);
+	}
+	invertScalar(a, out, i, i1);
+}
+
+template<class S, class T>
+ASL_TARGET_AVX2 static void interpolateAvx(const T* a, const T* b, const T* t, T* out, int i0, int i1)
+{
+	typedef typename S::V V;
+	int i = i0;
+	for (; i + S::N <= i1; i += S::N)
+	{
+		V pa[4], qa[4], pb[4], qb[4], q[4];
+		S::load4(a + 7 * i, 7, pa);
+		S::load4(a + 7 * i + 3, 7, qa);
+		S::load4(b + 7 * i, 7, pb);
+		S::load4(b + 7 * i + 3, 7, qb);
+		V tt = S::load(t + i);
+		for (int j = 0; j < 3; j++)
+			pa[j] = S::fma(tt, S::sub(pb[j], pa[j]), pa[j]);
+		slerpSoA<S>(qa, qb, tt, q);
+		pa[3] = q[0];
+		S::store4(out + 7 * i, 7, pa);
+		S::store4(out + 7 * i + 3, 7, q);
+	}
+	interpolateScalar(a, b, t, out, i, i1);
+}
+
+#endif
+
+enum PoseOp { SLERP, COMPOSE, INVERT, INTERPOLATE };
+
+template<class T>
+struct PoseKernel
+{
+	PoseOp op;
+	const T *a, *b, *t;
+	T* out;
+	void operator()(int i0, int i1) const
+	{
+#ifdef ASL_X86_AVX2
+		if (hasAvx2())
+		{
+			typedef typename AvxOf<T>::Type S;
+			switch (op)
+			{
+			case SLERP: slerpAvx<S>(a, b, t, out, i0, i1); break;
+			case COMPOSE: composeAvx<S>(a, b, out, i0, i1); break;
+			case INVERT: invertAvx<S>(a, out, i0, i1); break;
+			case INTERPOLATE: interpolateAvx<S>(a, b, t, out, i0, i1); break;
+			}
+			return;
+		}
+#endif
+		switch (op)
+		{
+		case SLERP: slerpScalar(a, b, t, out, i0, i1); break;
+		case COMPOSE: composeScalar(a, b, out, i0, i1); break;
+		case INVERT: invertScalar(a, out, i0, i1); break;
+		case INTERPOLATE: interpolateScalar(a, b, t, out, i0, i1); break;
+		}
+	}
+};
+
+void slerpQuaternions(const float* a, const float* b, const float* t, float* out, int n, int nthreads)
+{
+	PoseKernel<float> k = { SLERP, a, b, t, out };
+	forChunks(n, nthreads, k, 4096);
+}
+
+void slerpQuaternions(const double* a, const double* b, const double* t, double* out, int n, int nthreads)
+{
+	PoseKernel<double> k = { SLERP, a, b, t, out };
+	forChunks(n, nthreads, k, 4096);
+}
+
+void composePoses(const float* a, const float* b, float* out, int n, int nthreads)
+{
+	PoseKernel<float> k = { COMPOSE, a, b, 0, out };
+	forChunks(n, nthreads, k, 16384);
+}
+
+void composePoses(const double* a, const double* b, double* out, int n, int nthreads)
+{
+	PoseKernel<double> k = { COMPOSE, a, b, 0, out };
+	forChunks(n, nthreads, k, 16384);
+}
+
+void invertPoses(const float* a, float* out, int n, int nthreads)
+{
+	PoseKernel<float> k = { INVERT, a, 0, 0, out };
+	forChunks(n, nthreads, k, 16384);
+}
+
+void invertPoses(const double* a, double* out, int n, int nthreads)
+{
+	PoseKernel<double> k = { INVERT, a, 0, 0, out };
+	forChunks(n, nthreads, k, 16384);
+}
+
+void interpolatePoses(const float* a, const float* b, const float* t, float* out, int n, int nthreads)
+{
+	PoseKernel<float> k = { INTERPOLATE, a, b, t, out };
+	forChunks(n, nthreads, k, 4096);
+}
+
+void interpolatePoses(const double* a, const double* b, const double* t, double* out, int n, int nthreads)
+{
+	PoseKernel<double> k = { INTERPOLATE, a, b, t, out };
+	forChunks(n, nthreads, k, 4096);
+}
+
+}
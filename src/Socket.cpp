@@ -14,6 +14,7 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <netinet/in.h>
 #include <netdb.h>
@@ -641,7 +642,7 @@ int Socket_::read(void* data, int size)
 		data = (char*)data + n;
 		s += n;
 		size -= n;
-	} while (s < size);
+	} while (size > 0);
 	return s;
 	}
 	else {
@@ -667,6 +668,53 @@ int Socket_::write(const void* data, int n)
 #endif
 }
 
+Long Socket_::writeBlocks(const StringView* blocks, int n)
+{
+	Long written = 0;
+#ifndef _WIN32
+	iovec iov[64];
+	int i = 0;
+	while (i < n)
+	{
+		int k = 0;
+		for (; k < 64 && i + k < n; k++)
+		{
+			iov[k].iov_base = (void*)blocks[i + k].data();
+			iov[k].iov_len = blocks[i + k].length();
+		}
+		msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = k;
+		ssize_t m = ::sendmsg(_handle, &msg, MSG_NOSIGNAL);
+		if (m < 0)
+			break;
+		written += m;
+		for (int j = 0; j < k && m >= (ssize_t)iov[j].iov_len; j++, i++)
+			m -= iov[j].iov_len;
+		if (m > 0) // partial block: send the rest normally
+		{
+			const StringView& b = blocks[i++];
+			int r = write(b.data() + m, b.length() - (int)m);
+			if (r != b.length() - (int)m)
+				break;
+			written += r;
+		}
+	}
+#else
+	for (int i = 0; i < n; i++)
+	{
+		int m = write(blocks[i].data(), blocks[i].length());
+		if (m <= 0)
+			break;
+		written += m;
+		if (m < blocks[i].length())
+			break;
+	}
+#endif
+	return written;
+}
+
 Array<byte> Socket_::read(int n)
 {
 	Array<byte> a((n < 0) ? available() : n);
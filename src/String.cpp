@@ -6,6 +6,11 @@
 #include <asl/String.h>
 #include <asl/Array.h>
 #include <asl/Map.h>
+#include "simd.h"
+
+#ifdef ASL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
 
 #ifdef _WIN32
 #define vsnprintf _vsnprintf
@@ -426,15 +431,15 @@ String::String(unsigned x)
 String::String(float x)
 {
 	alloc(15);
-	_len = sprintf(str(), "%.7g", x);
+	_len = myftoa(x, str());
 }
 
 String::String(double x)
 {
 	char s[32];
-	_len = sprintf(s, "%.15g", x);
+	_len = myftoa(x, s);
 	alloc(_len);
-	strcpy(str(), s);
+	memcpy(str(), s, _len + 1);
 }
 
 String::String(bool x)
@@ -514,29 +519,309 @@ String String::substr(int i, int n) const
 	return s;
 }
 
+// Length-aware searches. Substrings are located by comparing the first, middle and last characters of the pattern at
+// 16 (SSE2) or 32 (AVX2) positions at once, and only positions where all three match are compared fully.
+
+static const char* findStringScalar(const char* p, int n, const char* s, int m)
+{
+	for (const char* end = p + n - m + 1; p < end; p++)
+	{
+		p = (const char*)memchr(p, s[0], end - p);
+		if (!p)
+			return 0;
+		if (memcmp(p + 1, s + 1, m - 1) == 0)
+			return p;
+	}
+	return 0;
+}
+
+#ifdef ASL_HAVE_SSE2
+
+// These need at least 16 (or 32) candidate positions; the last block overlaps the previous one instead of falling
+// back to a scalar loop, and `skip` masks out the positions already checked.
+
+static inline const char* checkCandidates(const char* p, int i, unsigned mask, const char* s, int m)
+{
+	for (; mask != 0; mask &= mask - 1)
+	{
+		int k = i + trailingZeros(mask);
+		if (memcmp(p + k + 1, s + 1, m - 2) == 0)
+			return p + k;
+	}
+	return 0;
+}
+
+static inline unsigned matchMaskSse(const char* p, __m128i first, __m128i mid, __m128i last, int m)
+{
+	__m128i a = _mm_loadu_si128((const __m128i*)p), b = _mm_loadu_si128((const __m128i*)(p + m - 1));
+	__m128i c = _mm_loadu_si128((const __m128i*)(p + m / 2));
+	return _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)),
+		_mm_cmpeq_epi8(c, mid)));
+}
+
+static const char* findStringSse(const char* p, int n, const char* s, int m)
+{
+	const __m128i first = _mm_set1_epi8(s[0]), mid = _mm_set1_epi8(s[m / 2]), last = _mm_set1_epi8(s[m - 1]);
+	const int end = n - m + 1;
+	int i = 0;
+	for (; i + 16 <= end; i += 16)
+	{
+		unsigned mask = matchMaskSse(p + i, first, mid, last, m);
+		if (mask != 0)
+		{
+			if (const char* q = checkCandidates(p, i, mask, s, m))
+				return q;
+		}
+	}
+	if (i == end)
+		return 0;
+	int skip = i - (end - 16);
+	i = end - 16;
+	return checkCandidates(p, i, matchMaskSse(p + i, first, mid, last, m) & (0xffffu << skip), s, m);
+}
+
+#endif
+
+#ifdef ASL_X86_AVX2
+
+ASL_TARGET_AVX2 static inline unsigned matchMaskAvx(const char* p, __m256i first, __m256i mid, __m256i last, int m)
+{
+	__m256i a = _mm256_loadu_si256((const __m256i*)p), b = _mm256_loadu_si256((const __m256i*)(p + m - 1));
+	__m256i c = _mm256_loadu_si256((const __m256i*)(p + m / 2));
+	return (unsigned)_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+		_mm256_cmpeq_epi8(b, last)), _mm256_cmpeq_epi8(c, mid)));
+}
+
+ASL_TARGET_AVX2 static const char* findStringAvx(const char* p, int n, const char* s, int m)
+{
+	const __m256i first = _mm256_set1_epi8(s[0]), mid = _mm256_set1_epi8(s[m / 2]), last = _mm256_set1_epi8(s[m - 1]);
+	const int end = n - m + 1;
+	int i = 0;
+	for (; i + 32 <= end; i += 32)
+	{
+		unsigned mask = matchMaskAvx(p + i, first, mid, last, m);
+		if (mask != 0)
+		{
+			if (const char* q = checkCandidates(p, i, mask, s, m))
+				return q;
+		}
+	}
+	if (i == end)
+		return 0;
+	int skip = i - (end - 32);
+	i = end - 32;
+	return checkCandidates(p, i, matchMaskAvx(p + i, first, mid, last, m) & (0xffffffffu << skip), s, m);
+}
+
+#endif
+
+// Returns a pointer to the first occurrence of [s, s + m) in [p, p + n), or null if not found
+
+static const char* findString(const char* p, int n, const char* s, int m)
+{
+	if (m == 0)
+		return p;
+	if (m > n)
+		return 0;
+	if (m == 1)
+		return (const char*)memchr(p, s[0], n);
+#ifdef ASL_X86_AVX2
+	if (n - m >= 31 && hasAvx2())
+		return findStringAvx(p, n, s, m);
+#endif
+#ifdef ASL_HAVE_SSE2
+	if (n - m >= 15)
+		return findStringSse(p, n, s, m);
+#endif
+	return findStringScalar(p, n, s, m);
+}
+
+// Like findString but with both [p, p + n) and [s, s + m) followed by a '\0' and s free of '\0'. Long scans use
+// libc strstr, which is faster than the code above on recent glibc. A miss is only trusted if the text has no
+// embedded '\0' (where strstr would have stopped).
+
+static const char* findStringZ(const char* p, int n, const char* s, int m)
+{
+	if (n >= 256 && m > 1)
+	{
+		const char* q = strstr(p, s);
+		if (q || !memchr(p, 0, n))
+			return q;
+	}
+	return findString(p, n, s, m);
+}
+
+// Appends to `pos` the offsets of the non-overlapping occurrences of [s, s + m) in [p, p + n), m > 0
+
+static void findAll(const char* p, int n, const char* s, int m, Array<int>& pos)
+{
+#ifdef ASL_HAVE_SSE2
+	if (m == 1)
+	{
+		const __m128i c = _mm_set1_epi8(s[0]);
+		int i = 0;
+		for (; i + 16 <= n; i += 16)
+		{
+			unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), c));
+			for (; mask != 0; mask &= mask - 1)
+				pos << i + trailingZeros(mask);
+		}
+		for (; i < n; i++)
+			if (p[i] == s[0])
+				pos << i;
+		return;
+	}
+#endif
+	for (const char* q = p; (q = findString(q, int(p + n - q), s, m)) != 0; q += m)
+		pos << int(q - p);
+}
+
+// Returns a pointer to the last occurrence of [s, s + m) in [p, p + n), or null if not found. Blocks are scanned
+// from the end, so the cost depends on the distance from the end, not on the number of earlier occurrences.
+
+static const char* findLastString(const char* p, int n, const char* s, int m)
+{
+	if (m == 0)
+		return p + n;
+	int i = n - m + 1; // candidate positions are [0, i)
+#ifdef ASL_HAVE_SSE2
+	const __m128i first = _mm_set1_epi8(s[0]), last = _mm_set1_epi8(s[m - 1]);
+	while (i >= 16)
+	{
+		i -= 16;
+		__m128i a = _mm_loadu_si128((const __m128i*)(p + i)), b = _mm_loadu_si128((const __m128i*)(p + i + m - 1));
+		unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+		while (mask != 0)
+		{
+			int k = highestBit(mask);
+			if (memcmp(p + i + k + 1, s + 1, m - 1) == 0)
+				return p + i + k;
+			mask &= ~(1u << k);
+		}
+	}
+#endif
+	while (--i >= 0)
+		if (p[i] == s[0] && memcmp(p + i + 1, s + 1, m - 1) == 0)
+			return p + i;
+	return 0;
+}
+
+static const char* findLastChar(const char* p, int n, char c)
+{
+	int i = n;
+#ifdef ASL_HAVE_SSE2
+	const __m128i vc = _mm_set1_epi8(c);
+	while (i >= 16)
+	{
+		i -= 16;
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(p + i)), vc));
+		if (mask != 0)
+			return p + i + highestBit(mask);
+	}
+#endif
+	while (--i >= 0)
+		if (p[i] == c)
+			return p + i;
+	return 0;
+}
+
+// Converts ASCII letters in [p, p + n) to upper case (if `from` is 'a') or lower case (if `from` is 'A'), 16 or 32
+// bytes per step, until a block with a non-ASCII byte is found. Returns the number of bytes converted.
+
+#ifdef ASL_HAVE_SSE2
+
+static int mapCaseAsciiSse(const char* p, char* out, int n, char from)
+{
+	const __m128i lo = _mm_set1_epi8(from), span = _mm_set1_epi8(25), bit = _mm_set1_epi8(0x20);
+	int i = 0;
+	for (; i + 16 <= n; i += 16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+		if (_mm_movemask_epi8(x) != 0)
+			break;
+		__m128i d = _mm_sub_epi8(x, lo);
+		__m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(d, span), d);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(x, _mm_and_si128(letter, bit)));
+	}
+	return i;
+}
+
+#endif
+
+#ifdef ASL_X86_AVX2
+
+ASL_TARGET_AVX2 static int mapCaseAsciiAvx(const char* p, char* out, int n, char from)
+{
+	const __m256i lo = _mm256_set1_epi8(from), span = _mm256_set1_epi8(25), bit = _mm256_set1_epi8(0x20);
+	int i = 0;
+	for (; i + 32 <= n; i += 32)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+		if (_mm256_movemask_epi8(x) != 0)
+			break;
+		__m256i d = _mm256_sub_epi8(x, lo);
+		__m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(d, span), d);
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(x, _mm256_and_si256(letter, bit)));
+	}
+	return i;
+}
+
+#endif
+
+static int mapCaseAscii(const char* p, char* out, int n, char from)
+{
+	int i = 0;
+#ifdef ASL_X86_AVX2
+	if (hasAvx2())
+		i = mapCaseAsciiAvx(p, out, n, from);
+#endif
+#ifdef ASL_HAVE_SSE2
+	i += mapCaseAsciiSse(p + i, out + i, n - i, from);
+#endif
+	return i;
+}
+
 int String::indexOf(char c, int i0) const
 {
-	char* p = str();
-	char* ch = strchr(p+i0,c);
-	return (!ch)? -1 : int(ch - p);
+	if (i0 > _len)
+		return -1;
+	const char* p = str();
+	const char* q = (const char*)memchr(p + i0, c, _len + 1 - i0); // includes the terminator, like strchr
+	return q ? int(q - p) : -1;
 }
 
 int String::indexOf(const char* s, int i0) const
 {
-	char* p = str();
-	char* c = strstr(p+i0,s);
-	return (!c)? -1 : int(c - p);
+	if (i0 > _len)
+		return -1;
+	const char* p = str();
+	const char* q = findStringZ(p + i0, _len - i0, s, (int)strlen(s));
+	return q ? int(q - p) : -1;
+}
+
+int String::indexOf(const String& s, int i0) const
+{
+	if (i0 > _len)
+		return -1;
+	if (memchr(*s, 0, s._len))
+		return view().indexOf(s.view(), i0);
+	const char* p = str();
+	const char* q = findStringZ(p + i0, _len - i0, *s, s._len);
+	return q ? int(q - p) : -1;
+}
+
+int String::lastIndexOf(char c) const
+{
+	if (c == '\0')
+		return _len;
+	const char* q = findLastChar(str(), _len, c);
+	return q ? int(q - str()) : -1;
 }
 
 int String::lastIndexOf(const char* s) const
 {
-	int i = 0, j = -1;
-	while((i = indexOf(s, i)) >= 0)
-	{
-		j = i;
-		i++;
-	}
-	return j;
+	const char* q = findLastString(str(), _len, s, (int)strlen(s));
+	return q ? int(q - str()) : -1;
 }
 
 extern char toUppercaseU8[];
@@ -552,7 +837,9 @@ String String::toUpperCase() const
 #else
 	unsigned char* p = (unsigned char*)str();
 	char* p2 = s.str();
-	for(int i=0; i<_len; i++)
+	int k = mapCaseAscii(str(), p2, _len, 'a');
+	p2 += k;
+	for(int i=k; i<_len; i++)
 	{
 		int code = (unsigned char)p[i];
 		if((code & 0x80) == 0) {}
@@ -588,7 +875,9 @@ String String::toLowerCase() const
 #else
 	unsigned char* p = (unsigned char*)str();
 	char* p2 = s.str();
-	for(int i=0; i<_len; i++)
+	int k = mapCaseAscii(str(), p2, _len, 'A');
+	p2 += k;
+	for(int i=k; i<_len; i++)
 	{
 		int code = (unsigned char)p[i];
 		if((code & 0x80) == 0) {}
@@ -641,20 +930,27 @@ String& String::trim()
 
 String String::replace(const String& a, const String& b) const
 {
-	String out;
-	int j=0, m=a.length();
-	j = indexOf(a);
-	if(j==-1) {
-		out = *this;
-		return out;
-	}
-	out << substring(0, j);
-	for(int i=j+m; i<=length(); i=j+m)
+	const char* p = str();
+	int m = a._len;
+	if (m == 0)
+		return *this;
+	Array<int> pos;
+	findAll(p, _len, a.str(), m, pos);
+	if (pos.length() == 0)
+		return *this;
+	int n = _len + pos.length() * (b._len - m);
+	String out(n, n);
+	char* o = out.str();
+	int i = 0;
+	for (int k = 0; k < pos.length(); k++)
 	{
-		j = indexOf(a, i);
-		if(j==-1) j=length();
-		out << b << substring(i, j);
+		memcpy(o, p + i, pos[k] - i);
+		o += pos[k] - i;
+		memcpy(o, b.str(), b._len);
+		o += b._len;
+		i = pos[k] + m;
 	}
+	memcpy(o, p + i, _len - i);
 	return out;
 }
 
@@ -715,6 +1011,94 @@ Dic<String> String::split(const String& sep1, const String& sep2) const
 	return dic;
 }
 
+bool StringView::equalsNocase(const StringView& s) const
+{
+	if (_n != s._n)
+		return false;
+	for (int i = 0; i < _n; i++)
+		if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s._s[i]))
+			return false;
+	return true;
+}
+
+int StringView::indexOf(const StringView& s, int i0) const
+{
+	if (i0 > _n)
+		return -1;
+	const char* p = findString(_s + i0, _n - i0, s._s, s._n);
+	return p ? int(p - _s) : -1;
+}
+
+int StringView::lastIndexOf(char c) const
+{
+	const char* p = findLastChar(_s, _n, c);
+	return p ? int(p - _s) : -1;
+}
+
+int StringView::lastIndexOf(const StringView& s) const
+{
+	const char* p = findLastString(_s, _n, s._s, s._n);
+	return p ? int(p - _s) : -1;
+}
+
+void StringView::split(const StringView& sep, Array<StringView>& out) const
+{
+	out.clear();
+	if (sep._n == 0)
+	{
+		out << *this;
+		return;
+	}
+	int j = 0, m = sep._n;
+	for (int i = 0; i <= _n; i = j + m)
+	{
+		j = (m == 1) ? indexOf(sep._s[0], i) : indexOf(sep, i);
+		if (j == -1)
+			j = _n;
+		out << StringView(_s + i, j - i);
+	}
+}
+
+Array<StringView> StringView::split(const StringView& sep) const
+{
+	Array<StringView> a;
+	split(sep, a);
+	return a;
+}
+
+Array<StringView> StringView::split() const
+{
+	Array<StringView> a;
+	for (int i = 0; i < _n; i++)
+	{
+		if (myisspace(_s[i]))
+			continue;
+		int j = i + 1;
+		while (j < _n && !myisspace(_s[j]))
+			j++;
+		a << StringView(_s + i, j - i);
+		i = j;
+	}
+	return a;
+}
+
+int StringView::toInt() const
+{
+	int i = 0, y = 0, sgn = 1;
+	while (i < _n && myisspace(_s[i]))
+		i++;
+	if (i < _n && (_s[i] == '-' || _s[i] == '+'))
+		sgn = (_s[i++] == '-') ? -1 : 1;
+	for (; i < _n && unsigned(_s[i] - '0') < 10; i++)
+		y = 10 * y + (_s[i] - '0');
+	return sgn * y;
+}
+
+double StringView::toDouble() const
+{
+	return myatof(_s, _s + _n);
+}
+
 int myatoi(const char* s)
 {
 	int y = 0, sgn = 1;
@@ -748,76 +1132,6 @@ Long myatol(const char* s)
 	return y*sgn;
 }
 
-/*
-double myatof(const char* s)
-{
-double y = 0;
-double m = 1;
-int exp = 0;
-if (s[0] == '-') { m = -1; s++; }
-const char* p = strchr(s, '.');
-if(p) {
-p++;
-while (*p != '\0' && *p!='e' && *p!='E') {
-exp--;
-p++;
-}
-p--;
-}
-if (!p) p = s;
-while(*p++)
-if(*p == 'e' || *p == 'E'){
-if(*(p+1) == '+')
-p++;
-exp += myatoiz(p+1);
-break;
-}
-while(int c=*s++)
-{
-if(c=='.') continue;
-if(c=='E' || c=='e') break;
-y = 10.0*y + (c-'0');
-}
-if(exp != 0)
-y *= pow(10.0, exp);
-return y * m;
-}
-*/
-
-double myatof(const char* s)
-{
-	double y = 0;
-	double m = 1;
-	int exp = 0;
-	if (s[0] == '-') { m = -1; s++; }
-	const char* p = strchr(s, '.');
-	if (p) {
-		p++;
-		while (*p != '\0' && *p != 'e' && *p != 'E') {
-			exp--;
-			p++;
-		}
-		p--;
-	}
-	if (!p) p = s;
-	while (*p++)
-		if (*p == 'e' || *p == 'E'){
-			if (*(p + 1) == '+')
-				p++;
-			exp += myatoiz(p + 1);
-			break;
-		}
-	long long y1 = 0;
-	while (int c = *s++)
-	{
-		if (c == '.') continue;
-		if (c == 'E' || c == 'e') break;
-		y1 = 10 * y1 + (c - '0');
-	}
-	y = double(y1) * pow(10.0, exp);
-	return y * m;
-}
-
 int myitoa(int x, char* s)
 {
 	char ss[16];
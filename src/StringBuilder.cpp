@@ -0,0 +1,140 @@
+#include <asl/StringBuilder.h>
+#include <asl/File.h>
+#include <asl/Socket.h>
+#include <stdlib.h>
+
+namespace asl {
+
+StringBuilder::StringBuilder(int blockSize)
+{
+	init(blockSize);
+}
+
+StringBuilder::StringBuilder(File& file, int flushSize)
+{
+	init(flushSize);
+	_file = &file;
+}
+
+StringBuilder::StringBuilder(Socket& socket, int flushSize)
+{
+	init(flushSize);
+	_socket = &socket;
+}
+
+void StringBuilder::init(int blockSize)
+{
+	_block = _p = _end = 0;
+	_full = 0;
+	_blockSize = max(blockSize, 64);
+	_file = 0;
+	_socket = 0;
+	_error = false;
+}
+
+StringBuilder::~StringBuilder()
+{
+	flush();
+	clear();
+}
+
+void StringBuilder::clear()
+{
+	for (int i = 0; i < _blocks.length(); i++)
+		free((void*)_blocks[i].data());
+	free(_block);
+	_blocks.clear();
+	_block = _p = _end = 0;
+	_full = 0;
+}
+
+void StringBuilder::flush()
+{
+	if ((!_file && !_socket) || _p == _block)
+		return;
+	StringView b(_block, int(_p - _block));
+	Long n = _file ? _file->writeBlocks(&b, 1) : _socket->writeBlocks(&b, 1);
+	if (n < b.length())
+		_error = true;
+	_full += b.length();
+	_p = _block;
+}
+
+// closes the current block and starts a new one with room for at least n chars (with a sink the
+// block is flushed and reused)
+
+void StringBuilder::newBlock(int n)
+{
+	if (_file || _socket)
+	{
+		flush();
+		if (_end - _p >= n)
+			return;
+		free(_block);
+	}
+	else if (_p > _block)
+	{
+		_blocks << StringView(_block, int(_p - _block));
+		_full += _p - _block;
+	}
+	else
+		free(_block);
+	int size = (_file || _socket) ? _blockSize : (int)min((Long)_blockSize, max(_full, (Long)256)); // small outputs start with small blocks
+	size = max(size, n);
+	_block = _p = (char*)malloc(size);
+	if (!_block)
+		ASL_BAD_ALLOC();
+	_end = _block + size;
+}
+
+void StringBuilder::appendLong(const char* s, int n)
+{
+	int k = int(_end - _p);
+	if (k > 0)
+	{
+		memcpy(_p, s, k);
+		_p += k;
+	}
+	newBlock(n - k);
+	memcpy(_p, s + k, n - k);
+	_p += n - k;
+}
+
+Array<StringView> StringBuilder::blockList() const
+{
+	Array<StringView> list = _blocks.clone();
+	if (_p > _block)
+		list << StringView(_block, int(_p - _block));
+	return list;
+}
+
+String StringBuilder::string() const
+{
+	int n = int(_p - _block);
+	for (int i = 0; i < _blocks.length(); i++)
+		n += _blocks[i].length();
+	String s(n, n);
+	char* p = s;
+	for (int i = 0; i < _blocks.length(); i++)
+	{
+		memcpy(p, _blocks[i].data(), _blocks[i].length());
+		p += _blocks[i].length();
+	}
+	if (_p > _block)
+		memcpy(p, _block, _p - _block);
+	return s;
+}
+
+Long StringBuilder::writeTo(File& file) const
+{
+	Array<StringView> list = blockList();
+	return file.writeBlocks(list.ptr(), list.length());
+}
+
+Long StringBuilder::writeTo(Socket& socket) const
+{
+	Array<StringView> list = blockList();
+	return socket.writeBlocks(list.ptr(), list.length());
+}
+
+}
@@ -1,6 +1,12 @@
 #include <asl/TabularDataFile.h>
+#include <asl/Thread.h>
+#include <asl/Mutex.h>
 #include <ctype.h>
 
+#ifdef ASL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace asl {
 
 void TabularDataFile::init()
@@ -13,6 +19,8 @@ void TabularDataFile::init()
 	_flushEvery = 0;
 	_rowIndex = 0;
 	_quoteStrings = false;
+	_bufferUsed = 0;
+	_bufferSize = 0;
 }
 
 TabularDataFile::TabularDataFile()
@@ -124,17 +132,236 @@ TabularDataFile& TabularDataFile::operator<<(const Var& x)
 			if(quote)
 				row << _quote;
 		}
-		row << '\n';
-		_file << *row;
-		if(++_rowIndex == _flushEvery)
+		write(*row, row.length());
+		endRow();
+		_row.clear();
+	}
+	return *this;
+}
+
+// Buffered writing
+
+struct TabularDataWriter : public Thread
+{
+	File* file;
+	Mutex mutex;
+	Semaphore pending;
+	Semaphore drained;
+	Array<Array<char> > queue;
+	Array<Array<char> > spare;
+	bool stopped;
+	bool draining;
+
+	TabularDataWriter(File* f) : file(f), stopped(false), draining(false) {}
+
+	// Queues a filled buffer for writing and returns an empty one
+	Array<char> swap(const Array<char>& buffer)
+	{
+		Array<char> empty;
 		{
-			_file.flush();
-			_rowIndex = 0;
+			Lock _(mutex);
+			queue << buffer;
+			if (spare.length() > 0)
+			{
+				empty = spare.last();
+				spare.resize(spare.length() - 1);
+			}
 		}
-		_row.clear();
+		pending.post();
+		return empty;
+	}
+
+	// Waits until all queued buffers have been written and flushed
+	void drain()
+	{
+		{
+			Lock _(mutex);
+			draining = true;
+		}
+		pending.post();
+		drained.wait();
+	}
+
+	void stop()
+	{
+		{
+			Lock _(mutex);
+			stopped = true;
+		}
+		pending.post();
+		join();
+	}
+
+	void run()
+	{
+		while (1)
+		{
+			pending.wait();
+			Array<char> buffer;
+			{
+				Lock _(mutex);
+				if (queue.length() == 0)
+				{
+					if (draining)
+					{
+						draining = false;
+						drained.post();
+					}
+					if (stopped)
+						break;
+					continue;
+				}
+				buffer = queue[0];
+				queue.remove(0);
+			}
+			file->write(buffer.ptr(), buffer.length());
+			file->flush();
+			Lock _(mutex);
+			spare << buffer;
+		}
+	}
+};
+
+TabularDataFile::~TabularDataFile()
+{
+	writePending();
+	if (!_writer)
+		return;
+	((TabularDataWriter*)(Thread*)_writer)->stop();
+}
+
+void TabularDataFile::useBuffer(int size, bool background)
+{
+	writePending();
+	_bufferSize = max(size, 0);
+	if (background && !_writer)
+	{
+		TabularDataWriter* writer = new TabularDataWriter(&_file);
+		_writer = writer;
+		writer->start();
+	}
+}
+
+void TabularDataFile::write(const char* p, int n)
+{
+	if (_bufferUsed + n > _buffer.length())
+		_buffer.resize(max(_bufferUsed + n, max(2 * _buffer.length(), _bufferSize + 1024)));
+	memcpy(_buffer.ptr() + _bufferUsed, p, n);
+	_bufferUsed += n;
+}
+
+void TabularDataFile::writePending()
+{
+	if (_bufferUsed == 0)
+		return;
+	if (!_file && !_file.open(_name, File::APPEND))
+		return;
+	if (_writer)
+	{
+		_buffer.resize(_bufferUsed);
+		_buffer = ((TabularDataWriter*)(Thread*)_writer)->swap(_buffer);
+	}
+	else
+		_file.File::write(_buffer.ptr(), _bufferUsed);
+	_bufferUsed = 0;
+}
+
+void TabularDataFile::flush()
+{
+	writePending();
+	if (_writer)
+		((TabularDataWriter*)(Thread*)_writer)->drain();
+	else if (_file)
+		_file.flush();
+}
+
+static char* formatInt(char* s, int x)
+{
+	char digits[12];
+	unsigned y = x < 0 ? 0u - (unsigned)x : (unsigned)x;
+	int n = 0;
+	do {
+		digits[n++] = char('0' + y % 10);
+		y /= 10;
+	} while (y != 0);
+	if (x < 0)
+		*s++ = '-';
+	while (n > 0)
+		*s++ = digits[--n];
+	return s;
+}
+
+void TabularDataFile::put(double x)
+{
+	char s[40], *p = s;
+	if (_currCol++ > 0)
+		*p++ = _separator;
+	else if (!_dataStarted)
+	{
+		*p++ = '\n';
+		_dataStarted = true;
+	}
+	char* q = p;
+	p += myftoa(x, p);
+	if (_decimal != '.')
+		for (; q < p; q++)
+			if (*q == '.')
+				*q = _decimal;
+	write(s, int(p - s));
+}
+
+void TabularDataFile::put(int x)
+{
+	char s[16], *p = s;
+	if (_currCol++ > 0)
+		*p++ = _separator;
+	else if (!_dataStarted)
+	{
+		*p++ = '\n';
+		_dataStarted = true;
+	}
+	p = formatInt(p, x);
+	write(s, int(p - s));
+}
+
+void TabularDataFile::put(const char* x, int n)
+{
+	char s[2], *p = s;
+	if (_currCol++ > 0)
+		*p++ = _separator;
+	else if (!_dataStarted)
+	{
+		*p++ = '\n';
+		_dataStarted = true;
+	}
+	if (_quoteStrings)
+		*p++ = _quote;
+	write(s, int(p - s));
+	write(x, n);
+	if (_quoteStrings)
+		write(&_quote, 1);
+}
+
+TabularDataFile& TabularDataFile::endRow()
+{
+	write("\n", 1);
+	_currCol = 0;
+	if (_bufferUsed >= _bufferSize)
+		writePending();
+	if (++_rowIndex == _flushEvery)
+	{
+		flush();
+		_rowIndex = 0;
 	}
 	return *this;
 }
+
+TabularDataFile& TabularDataFile::append(const double* x, int n)
+{
+	for (int i = 0; i < n; i++)
+		put(x[i]);
+	return endRow();
+}
 	
 Array<Array<Var> > TabularDataFile::data()
 {
@@ -198,6 +425,17 @@ bool TabularDataFile::readHeader()
 	return true;
 }
 
+// Number parsers of the fast column reader below, which need no null-terminated copy of each field
+
+static double parseNumber(const char* p, const char* end, char decimal);
+static int parseInt(const char* p, const char* end);
+static int parseHex(const char* p, const char* end);
+
+static inline double toNumber(const StringView& v, char decimal)
+{
+	return parseNumber(v.begin(), v.end(), decimal);
+}
+
 bool TabularDataFile::nextRow()
 {
 	String& line = _currentLine;
@@ -210,16 +448,16 @@ bool TabularDataFile::nextRow()
 		return false;
 	if(!_file.readLine(line)) 
 		return false;
-	Array<String>& row = _currentRowParts;
-	line.split(_separator, row);
+	Array<StringView>& row = _currentRowParts;
+	line.splitViews(StringView(&_separator, 1), row);
 	_row.clear();
 	char decimal = _decimal;
 	int ntypes = _types.length();
 	
-	foreach2(int i, String& v, row)
+	foreach2(int i, StringView& v, row)
 	{
 		bool isstring = false;
-		if(v[0] == '\"' && v[v.length()-1] == '\"')
+		if(v.length() > 1 && v[0] == '\"' && v[v.length()-1] == '\"')
 		{
 			v=v.substring(1, v.length()-1);
 			isstring = true;
@@ -228,30 +466,368 @@ bool TabularDataFile::nextRow()
 		{
 			switch(_types[i])
 			{
-			case 'n': if(decimal!='.') v.replaceme(decimal, '.'); _row << myatof(*v); break;
-			case 's': _row << v; break;
-			case 'i': _row << myatoi(*v); break;
-			case 'h': _row << v.hexToInt(); break;
+			case 'n': _row << toNumber(v, decimal); break;
+			case 's': _row << String(v); break;
+			case 'i': _row << parseInt(v.begin(), v.end()); break;
+			case 'h': _row << parseHex(v.begin(), v.end()); break;
 			}
 		}
 		else {
-			bool isnum = !isstring && (myisdigit(v[0]) || (v[0] == '-' && myisdigit(v[1])));
+			bool isnum = !isstring && v.ok() && (myisdigit(v[0]) || (v[0] == '-' && v.length() > 1 && myisdigit(v[1])));
 			if(isnum)
-			{
-				if(decimal!='.') v.replaceme(decimal, '.');
-				//if(v.contains('.') || v.contains('e'))
-					_row << myatof(*v);
-				/*else
-					_row << myatoi(*v);*/
-			}
+				_row << toNumber(v, decimal);
 			else
-				_row << v;
+				_row << String(v);
 		}
 	}
 
 	return true;
 }
 
+// Fast column reader
+
+// Returns a pointer to the first occurrence of any of a, b or c in [p, end), or end if none is found
+
+static inline const char* findAny(const char* p, const char* end, char a, char b, char c)
+{
+#ifdef ASL_HAVE_SSE2
+	const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+	for (; end - p >= 16; p += 16)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)p);
+		int m = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)), _mm_cmpeq_epi8(x, vc)));
+		if (m != 0)
+			return p + trailingZeros(m);
+	}
+#endif
+	for (; p < end; p++)
+		if (*p == a || *p == b || *p == c)
+			return p;
+	return end;
+}
+
+static int countChar(const char* p, const char* end, char c)
+{
+	int n = 0;
+#ifdef ASL_HAVE_SSE2
+	const __m128i vc = _mm_set1_epi8(c), zero = _mm_setzero_si128();
+	while (end - p >= 16)
+	{
+		__m128i acc = zero;
+		for (int k = 0; k < 255 && end - p >= 16; k++, p += 16)
+			acc = _mm_sub_epi8(acc, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), vc));
+		__m128i s = _mm_sad_epu8(acc, zero);
+		n += _mm_cvtsi128_si32(s) + _mm_cvtsi128_si32(_mm_srli_si128(s, 8));
+	}
+#endif
+	for (; p < end; p++)
+		n += (*p == c);
+	return n;
+}
+
+// Returns the start of the next record after `from`, given the number of quotes `q` since the start of the current record
+
+static const char* nextRecord(const char* from, const char* end, int q)
+{
+	const char* p = from;
+	while ((p = findAny(p, end, '\n', '\"', '\"')) < end)
+	{
+		if (*p == '\"')
+			q++;
+		else if ((q & 1) == 0)
+			return p + 1;
+		p++;
+	}
+	return end;
+}
+
+// Returns the end of the last complete record in [p, end), or p if there is none
+
+static const char* lastRecordEnd(const char* p, const char* end)
+{
+	int q = countChar(p, end, '\"');
+	for (const char* e = end; e > p; e--)
+	{
+		char c = e[-1];
+		if (c == '\"')
+			q--;
+		else if (c == '\n' && (q & 1) == 0)
+			return e;
+	}
+	return p;
+}
+
+// Scans a field starting at p, sets [f, fe) to its contents (unquoted, in `buf` if it had escaped quotes), and returns
+// the position of the character that ended it (separator, line end or end)
+
+static const char* scanField(const char* p, const char* end, char sep, const char*& f, const char*& fe, String& buf, bool& quoted)
+{
+	quoted = p < end && *p == '\"';
+	if (!quoted)
+	{
+		f = p;
+		fe = p = findAny(p, end, sep, '\n', '\r');
+		return p;
+	}
+	f = ++p;
+	const char* seg = p;
+	bool escaped = false;
+	while (1)
+	{
+		const char* q = (const char*)memchr(p, '\"', end - p);
+		if (!q)
+			q = end;
+		if (q + 1 < end && q[1] == '\"')
+		{
+			if (!escaped) {
+				buf.clear();
+				escaped = true;
+			}
+			buf.append(seg, int(q + 1 - seg));
+			p = seg = q + 2;
+			continue;
+		}
+		if (escaped) {
+			buf.append(seg, int(q - seg));
+			f = *buf;
+			fe = f + buf.length();
+		}
+		else
+			fe = q;
+		p = (q < end) ? q + 1 : end;
+		break;
+	}
+	return findAny(p, end, sep, '\n', '\r');
+}
+
+// Parses a number in [p, end) without requiring a terminating null; returns 0 if there are no digits, like myatof()
+
+static double parseNumber(const char* p, const char* end, char decimal)
+{
+	const char* next;
+	double y = myatof(p, end, &next, decimal);
+	return next != p ? y : 0.0;
+}
+
+static int parseInt(const char* p, const char* end)
+{
+	while (p < end && *p == ' ')
+		p++;
+	int sgn = 1, y = 0;
+	if (p < end && (*p == '-' || *p == '+'))
+		sgn = (*p++ == '-') ? -1 : 1;
+	for (; p < end && unsigned(*p - '0') < 10; p++)
+		y = 10 * y + (*p - '0');
+	return sgn * y;
+}
+
+static int parseHex(const char* p, const char* end)
+{
+	unsigned y = 0;
+	for (; p < end; p++)
+	{
+		char c = *p;
+		int d = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+		if (d < 0) {
+			if (y == 0 && (c == 'x' || c == 'X' || c == ' '))
+				continue;
+			break;
+		}
+		y = (y << 4) | d;
+	}
+	return (int)y;
+}
+
+static inline void store(TabularDataColumn& col, const char* p, const char* end, char decimal)
+{
+	switch (col.type)
+	{
+	case 'n': col.numbers << parseNumber(p, end, decimal); break;
+	case 'i': col.ints << parseInt(p, end); break;
+	case 'h': col.ints << parseHex(p, end); break;
+	default: col.strings << String(p, int(end - p)); break;
+	}
+}
+
+static inline bool looksNumeric(const String& f)
+{
+	return myisdigit(f[0]) || ((f[0] == '-' || f[0] == '.') && myisdigit(f[1]));
+}
+
+// Splits the record starting at p into fields and returns the start of the next record
+
+static const char* splitRecord(const char* p, const char* end, char sep, Array<String>& fields, Array<bool>& quoted)
+{
+	String buf;
+	fields.clear();
+	quoted.clear();
+	while (1)
+	{
+		const char *f, *fe;
+		bool q;
+		p = scanField(p, end, sep, f, fe, buf, q);
+		fields << String(f, int(fe - f));
+		quoted << q;
+		if (p >= end || *p != sep)
+			break;
+		p++;
+	}
+	while (p < end && *p != '\n')
+		p++;
+	return p < end ? p + 1 : end;
+}
+
+// Parses all records in [p, end) appending their values to the columns
+
+static void parseRecords(const char* p, const char* end, char sep, char decimal, Array<TabularDataColumn>& cols)
+{
+	int ncols = cols.length();
+	String buf;
+	while (p < end)
+	{
+		if (*p == '\n' || *p == '\r') {
+			p++;
+			continue;
+		}
+		int j = 0;
+		while (1)
+		{
+			const char *f, *fe;
+			bool quoted;
+			p = scanField(p, end, sep, f, fe, buf, quoted);
+			if (j < ncols)
+				store(cols[j], f, fe, decimal);
+			j++;
+			if (p >= end || *p != sep)
+				break;
+			p++;
+		}
+		for (; j < ncols; j++)
+			store(cols[j], p, p, decimal);
+		while (p < end && *p != '\n')
+			p++;
+		p++;
+	}
+}
+
+Array<TabularDataColumn> TabularDataFile::readColumns(int nthreads)
+{
+	Array<TabularDataColumn> cols;
+	File file(_name, File::READ);
+	if (!file)
+		return cols;
+	nthreads = clamp(nthreads, 1, max(Thread::numProcessors(), 1));
+	Array<char> buffer((1 << 22) * nthreads);
+	int carry = 0;
+	bool started = false;
+	while (1)
+	{
+		int space = buffer.length() - carry;
+		int n = file.read(buffer.ptr() + carry, space);
+		bool last = n < space;
+		const char* p = buffer.ptr();
+		const char* end = p + carry + max(n, 0);
+		const char* recEnd = last ? end : lastRecordEnd(p, end);
+		if (recEnd == p && !last)
+		{
+			carry = int(end - p);
+			buffer.resize(2 * buffer.length());
+			continue;
+		}
+
+		if (!started)
+		{
+			started = true;
+			if (end - p >= 3 && (byte)p[0] == 0xef && (byte)p[1] == 0xbb && (byte)p[2] == 0xbf)
+				p += 3;
+			const char* eol = findAny(p, recEnd, '\n', '\n', '\n');
+			if (findAny(p, eol, ';', ';', ';') < eol) {
+				_separator = ';';
+				_decimal = ',';
+			}
+			else if (findAny(p, eol, ',', ',', ',') < eol)
+				_separator = ',';
+			else if (findAny(p, eol, '\t', '\t', '\t') < eol)
+				_separator = '\t';
+
+			Array<String> fields;
+			Array<bool> quoted;
+			const char* next = splitRecord(p, recEnd, _separator, fields, quoted);
+			bool header = true;
+			for (int i = 0; i < fields.length(); i++)
+				if (!quoted[i] && looksNumeric(fields[i]))
+					header = false;
+			_columnNames.clear();
+			for (int i = 0; i < fields.length(); i++)
+				_columnNames << (header ? fields[i] : String(i));
+			if (header)
+			{
+				p = next;
+				while (p < recEnd && (*p == '\n' || *p == '\r'))
+					p++;
+				fields.clear();
+				if (p < recEnd)
+					splitRecord(p, recEnd, _separator, fields, quoted);
+			}
+			cols.resize(_columnNames.length());
+			for (int i = 0; i < cols.length(); i++)
+			{
+				cols[i].name = _columnNames[i];
+				if (i < _types.length())
+					cols[i].type = _types[i];
+				else if (i < fields.length())
+					cols[i].type = (!quoted[i] && looksNumeric(fields[i])) ? 'n' : 's';
+			}
+		}
+
+		if (nthreads == 1 || recEnd - p < (1 << 16))
+			parseRecords(p, recEnd, _separator, _decimal, cols);
+		else
+		{
+			Array<const char*> bounds;
+			bounds << p;
+			for (int i = 1; i < nthreads; i++)
+			{
+				const char* b = bounds.last();
+				const char* target = max(b, p + (recEnd - p) * i / nthreads);
+				bounds << nextRecord(target, recEnd, countChar(b, target, '\"'));
+			}
+			bounds << recEnd;
+			Array<Array<TabularDataColumn> > parts(nthreads);
+			for (int i = 0; i < nthreads; i++)
+			{
+				parts[i].resize(cols.length());
+				for (int j = 0; j < cols.length(); j++)
+					parts[i][j].type = cols[j].type;
+			}
+			char sep = _separator, decimal = _decimal;
+#ifdef ASL_EXP_THREADING
+			Thread::parallel_for(0, nthreads, [&](int i) {
+				parseRecords(bounds[i], bounds[i + 1], sep, decimal, parts[i]);
+			}, nthreads);
+#else
+			for (int i = 0; i < nthreads; i++)
+				parseRecords(bounds[i], bounds[i + 1], sep, decimal, parts[i]);
+#endif
+			for (int i = 0; i < nthreads; i++)
+				for (int j = 0; j < cols.length(); j++)
+				{
+					TabularDataColumn& c = cols[j];
+					const TabularDataColumn& part = parts[i][j];
+					c.numbers.append(part.numbers);
+					c.ints.append(part.ints);
+					c.strings.append(part.strings);
+				}
+		}
+
+		if (last)
+			break;
+		carry = int(end - recEnd);
+		memmove(buffer.ptr(), recEnd, carry);
+	}
+	return cols;
+}
+
 Var TabularDataFile::operator[](int i) const
 {
 	if(i>=_row.length() || i < 0)
@@ -1,4 +1,5 @@
 #include <asl/TextFile.h>
+#include <asl/MappedFile.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -102,6 +103,27 @@ bool TextFile::readLine(String& s)
 Array<String> TextFile::lines()
 {
 	Array<String> lines;
+	if (!_file)
+	{
+		MappedFile mapped(_path);
+		if (mapped)
+		{
+			const char* p = mapped.ptr();
+			const char* end = p + mapped.length();
+			while (1)
+			{
+				const char* q = p < end ? (const char*)memchr(p, '\n', end - p) : 0;
+				if (!q)
+				{
+					lines << String(p, int(end - p));
+					break;
+				}
+				lines << String(p, int((q > p && q[-1] == '\r') ? q - 1 - p : q - p));
+				p = q + 1;
+			}
+			return lines;
+		}
+	}
 	if(!_file && !open(_path, READ))
 		return lines;
 	while (!end()) {
@@ -111,6 +133,57 @@ Array<String> TextFile::lines()
 	return lines;
 }
 
+TextFile::LineEnumerator::LineEnumerator(FILE* f, const String& path) : _s(new State), _more(true)
+{
+	State& s = *_s;
+	if (!f && s.file.open(path, File::READ))
+		f = s.file.stdio();
+	s.f = f;
+	s.buffer.resize(1 << 20);
+	s.begin = s.end = 0;
+	s.eof = (f == 0);
+	++(*this);
+}
+
+void TextFile::LineEnumerator::operator++()
+{
+	State& s = *_s;
+	while (1)
+	{
+		const char* p = s.buffer.ptr() + s.begin;
+		int n = s.end - s.begin;
+		const char* q = (const char*)memchr(p, '\n', n);
+		if (q)
+		{
+			_line = StringView(p, int((q > p && q[-1] == '\r') ? q - 1 - p : q - p));
+			s.begin += int(q - p) + 1;
+			return;
+		}
+		if (s.eof)
+		{
+			_more = n > 0;
+			_line = StringView(p, n);
+			s.begin = s.end;
+			return;
+		}
+		if (s.begin > 0)
+			memmove(s.buffer.ptr(), p, n);
+		s.begin = 0;
+		s.end = n;
+		if (n == s.buffer.length())
+			s.buffer.resize(2 * n);
+		int m = (int)fread(s.buffer.ptr() + n, 1, s.buffer.length() - n, s.f);
+		s.end += m;
+		if (m == 0)
+			s.eof = true;
+	}
+}
+
+TextFile::LineEnumerator TextFile::lineViews()
+{
+	return LineEnumerator(_file, _path);
+}
+
 String TextFile::text()
 {
 	int n = (int)(size() & 0x7fffffff); // truncate
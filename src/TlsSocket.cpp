@@ -461,6 +461,19 @@ int TlsSocket_::write(const void* data, int n)
 	return written;
 }
 
+Long TlsSocket_::writeBlocks(const StringView* blocks, int n)
+{
+	Long written = 0;
+	for (int i = 0; i < n; i++)
+	{
+		int m = write(blocks[i].data(), blocks[i].length());
+		written += m;
+		if (m < blocks[i].length())
+			break;
+	}
+	return written;
+}
+
 bool TlsSocket_::waitInput(double t)
 {
 	if (available() != 0)
@@ -5,19 +5,26 @@ namespace asl {
 #ifndef ASL_VAR_STATIC
 #define NEW_ARRAY(a) (a) = new Array<Var>
 #define NEW_ARRAYC(a, x) (a) = new Array<Var>(x)
+#define NEW_ARRAYA(a, arena) (a) = new Array<Var>(arena)
 #define DEL_ARRAY(a) delete (a)
 #define NEW_DIC(d) (d) = new HDic<Var>
 #define NEW_DICC(d, x) (d) = new HDic<Var>(x)
 #define DEL_DIC(d) delete (d)
+#define NEW_STRING(s) (s) = new asl::Array<char>
+#define NEW_STRINGC(s, n) (s) = new asl::Array<char>(n)
+#define NEW_STRINGA(s, arena, n) (s) = new asl::Array<char>(arena, n)
+#define DEL_STRING(s) delete (s)
 #else
 #define NEW_ARRAY(a) (a).construct()
 #define NEW_ARRAYC(a, x) (a).construct(x)
+#define NEW_ARRAYA(a, arena) (a).construct(asl::Array<Var>(arena))
 #define DEL_ARRAY(a) (a).destroy()
 #define NEW_DIC(d) (d).construct()
 #define NEW_DICC(d, x) (d).construct(x)
 #define DEL_DIC(d) (d).destroy()
 #define NEW_STRING(s) (s).construct()
 #define NEW_STRINGC(s, n) (s).construct(asl::Array<char>(n))
+#define NEW_STRINGA(s, arena, n) (s).construct(asl::Array<char>(arena, n))
 #define DEL_STRING(s) (s).destroy()
 #endif
 
@@ -31,6 +38,10 @@ Var::Var(Type t)
 	case STRING: NEW_STRING(s); break;
 	case ARRAY: NEW_ARRAY(a); break;
 	case DIC: NEW_DIC(o); break;
+	case INT_ARRAY: ai.construct(); box(); break;
+	case FLOAT_ARRAY: af.construct(); box(); break;
+	case PACKED: _type = DOUBLE_ARRAY; ad.construct(); box(); break;
+	case DOUBLE_ARRAY: ad.construct(); box(); break;
 	default: break;
 	}
 }
@@ -48,10 +59,64 @@ void Var::copy(const Var& v)
 	case DIC:
 		NEW_DICC(o, *v.o);
 		break;
+	case PACKED:
+		NEW_ARRAYC(a, *v.a);
+		break;
+	case INT_ARRAY:
+		ai.construct(*v.ai);
+		break;
+	case FLOAT_ARRAY:
+		af.construct(*v.af);
+		break;
+	case DOUBLE_ARRAY:
+		ad.construct(*v.ad);
+		break;
 	default: break;
 	}
 }
 
+// constructs a string, allocated in an arena if not null
+
+Var::Var(const char* x, int n, Arena* arena)
+{
+	if (n < VAR_SSPACE) {
+		_type = SSTRING;
+		memcpy(ss, x, n);
+		ss[n] = '\0';
+	}
+	else {
+		_type = STRING;
+		if (arena)
+			NEW_STRINGA(s, *arena, n + 1);
+		else
+			NEW_STRINGC(s, n + 1);
+		memcpy(s->ptr(), x, n);
+		(*s)[n] = '\0';
+	}
+}
+
+// makes this var an empty array, object or packed array, allocated in an arena if not null
+
+void Var::init(Type t, Arena* arena)
+{
+	free();
+	if (!arena)
+	{
+		Var v(t);
+		swap(*this, v);
+		return;
+	}
+	_type = t;
+	switch (t) {
+	case ARRAY: NEW_ARRAYA(a, *arena); break;
+	case DIC: NEW_DIC(o); o->kv() = Array<Map<String, Var>::KeyVal>(*arena); break;
+	case INT_ARRAY: ai.construct(Array<int>(*arena)); box(arena); break;
+	case FLOAT_ARRAY: af.construct(Array<float>(*arena)); box(arena); break;
+	case DOUBLE_ARRAY: ad.construct(Array<double>(*arena)); box(arena); break;
+	default: _type = NONE; break;
+	}
+}
+
 Var::Var(unsigned y)
 {
 	if (y < 2147483648u) {
@@ -127,9 +192,9 @@ Var::operator double() const
 	case INT:
 		return i;
 	case STRING:
-		return atof(s->ptr());
+		return myatof(s->ptr());
 	case SSTRING:
-		return atof(ss);
+		return myatof(ss);
 	case NUL:
 		return nan();
 	default:
@@ -147,9 +212,9 @@ Var::operator float() const
 	case INT:
 		return (float)i;
 	case STRING:
-		return (float)atof(s->ptr());
+		return (float)myatof(s->ptr());
 	case SSTRING:
-		return (float)atof(ss);
+		return (float)myatof(ss);
 	case NUL:
 		return nan();
 	default: break;
@@ -229,6 +294,10 @@ Var::operator bool() const
 		return d != 0;
 	case ARRAY:
 	case DIC:
+	case INT_ARRAY:
+	case FLOAT_ARRAY:
+	case DOUBLE_ARRAY:
+	case PACKED:
 		return true;
 	case STRING:
 		return s->length() > 1;
@@ -255,6 +324,10 @@ Var::operator const char*() const
 	case SSTRING:
 		return ss; break;
 	case ARRAY:
+	case INT_ARRAY:
+	case FLOAT_ARRAY:
+	case DOUBLE_ARRAY:
+	case PACKED:
 		return "[?]"; break;
 	case DIC:
 		return "{?}"; break;
@@ -273,11 +346,11 @@ String Var::toString() const
 		break;
 	case FLOAT:
 		r.resize(16);
-		r.fix(sprintf(r, "%.7g", d));
+		r.fix(myftoa((float)d, r));
 		break;
 	case NUMBER:
 		r.resize(29);
-		r.fix(sprintf(r, "%.15g", d));
+		r.fix(myftoa(d, r));
 		break;
 	case BOOL:
 		r=b?"true":"false";
@@ -295,6 +368,22 @@ String Var::toString() const
 	case DIC:
 		r = '{' + o->join(',', '=') + '}';
 		break;
+	case PACKED:
+		r = (*a)[0].toString();
+		break;
+	case INT_ARRAY:
+	case FLOAT_ARRAY:
+	case DOUBLE_ARRAY: {
+		r = '[';
+		for (int j = 0, n = length(); j < n; j++)
+		{
+			if (j > 0)
+				r << ',';
+			r << item(j).toString();
+		}
+		r << ']';
+		break;
+	}
 	case NUL:
 		r="null";
 		break;
@@ -311,11 +400,233 @@ void Var::free()
 	case STRING: DEL_STRING(s); break;
 	case ARRAY: DEL_ARRAY(a); break;
 	case DIC: DEL_DIC(o); break;
+	case PACKED: DEL_ARRAY(a); break;
+	case INT_ARRAY: ai.destroy(); break;
+	case FLOAT_ARRAY: af.destroy(); break;
+	case DOUBLE_ARRAY: ad.destroy(); break;
 	default: break;
 	}
 	_type=NONE;
 }
 
+// a packed var holds its numbers in a shared single-element array (the box), so that converting them into a regular
+// array of Vars when an element is modified is seen by all copies; this makes a var with the numbers boxed
+
+void Var::box(Arena* arena)
+{
+	Var r;
+	memcpy(&r, this, sizeof(Var));
+	_type = PACKED;
+	if (arena)
+		NEW_ARRAYA(a, *arena);
+	else
+		NEW_ARRAY(a);
+	a->resize(1);
+	swap((*a)[0], r);
+}
+
+// converts the numbers in a box into a regular array of Vars
+
+void Var::unpack()
+{
+	int n = length();
+	Array<Var> b(n);
+	for (int j = 0; j < n; j++)
+		b[j] = item(j);
+	free();
+	_type = ARRAY;
+	NEW_ARRAYC(a, b);
+}
+
+Var Var::item(int j) const
+{
+	switch (_type) {
+	case PACKED: return (*a)[0].item(j);
+	case INT_ARRAY: return (*ai)[j];
+	case FLOAT_ARRAY: return (*af)[j];
+	case DOUBLE_ARRAY: return (*ad)[j];
+	case ARRAY: return (*a)[j];
+	default: return Var();
+	}
+}
+
+bool Var::pack(Type t)
+{
+	if (_type == PACKED)
+	{
+		Var& r = (*a)[0];
+		if (!r.pack(t))
+			return false;
+		if (r._type == PACKED) // it was unpacked, so take the numbers out of their new box
+		{
+			Var b;
+			swap(b, r);
+			swap(r, (*b.a)[0]);
+		}
+		return true;
+	}
+	if (type() != ARRAY)
+		return false;
+	int n = length();
+	if (t == NONE)
+	{
+		t = packedType();
+		if (t == NONE)
+		{
+			for (int j = 0; j < n; j++)
+			{
+				Type tj = (*a)[j]._type;
+				if (tj != INT && tj != FLOAT && tj != NUMBER)
+					return false;
+				t = (j == 0 || tj == t) ? tj : NUMBER;
+			}
+			if (n == 0)
+				return false;
+		}
+	}
+	if (t == packedType())
+		return true;
+	if (_type == ARRAY)
+	{
+		for (int j = 0; j < n; j++)
+			if (!(*a)[j].is(NUMBER))
+				return false;
+	}
+	Var v;
+	switch (t) {
+	case INT: {
+		Array<int> b;
+		packedTo(b);
+		v._type = INT_ARRAY;
+		v.ai.construct(b);
+		break;
+	}
+	case FLOAT: {
+		Array<float> b;
+		packedTo(b);
+		v._type = FLOAT_ARRAY;
+		v.af.construct(b);
+		break;
+	}
+	case NUMBER: {
+		Array<double> b;
+		packedTo(b);
+		v._type = DOUBLE_ARRAY;
+		v.ad.construct(b);
+		break;
+	}
+	default:
+		return false;
+	}
+	bool boxed = _type > DIC;
+	free();
+	memcpy(this, &v, sizeof(v));
+	v._type = NONE;
+	if (!boxed)
+		box();
+	return true;
+}
+
+Var Var::packed(const Array<int>& a)
+{
+	Var v;
+	v._type = INT_ARRAY;
+	v.ai.construct(a.clone());
+	v.box();
+	return v;
+}
+
+Var Var::packed(const Array<float>& a)
+{
+	Var v;
+	v._type = FLOAT_ARRAY;
+	v.af.construct(a.clone());
+	v.box();
+	return v;
+}
+
+Var Var::packed(const Array<double>& a)
+{
+	Var v;
+	v._type = DOUBLE_ARRAY;
+	v.ad.construct(a.clone());
+	v.box();
+	return v;
+}
+
+void Var::packedTo(Array<int>& b) const
+{
+	switch (_type) {
+	case PACKED: (*a)[0].packedTo(b); break;
+	case INT_ARRAY: b = *ai; break;
+	case FLOAT_ARRAY: b = af->with<int>(); break;
+	case DOUBLE_ARRAY: b = ad->with<int>(); break;
+	default: packedTo<int>(b); break;
+	}
+}
+
+void Var::packedTo(Array<float>& b) const
+{
+	switch (_type) {
+	case PACKED: (*a)[0].packedTo(b); break;
+	case INT_ARRAY: b = ai->with<float>(); break;
+	case FLOAT_ARRAY: b = *af; break;
+	case DOUBLE_ARRAY: b = ad->with<float>(); break;
+	default: packedTo<float>(b); break;
+	}
+}
+
+void Var::packedTo(Array<double>& b) const
+{
+	switch (_type) {
+	case PACKED: (*a)[0].packedTo(b); break;
+	case INT_ARRAY: b = ai->with<double>(); break;
+	case FLOAT_ARRAY: b = af->with<double>(); break;
+	case DOUBLE_ARRAY: b = *ad; break;
+	default: packedTo<double>(b); break;
+	}
+}
+
+bool Var::equals(const Var& other) const
+{
+	if (_type == PACKED)
+		return (*a)[0].equals(other);
+	if (other._type == PACKED)
+		return equals((*other.a)[0]);
+	if (type() != ARRAY || other.type() != ARRAY)
+		return false;
+	int n = length();
+	if (other.length() != n)
+		return false;
+	if (_type == other._type)
+	{
+		switch (_type) {
+		case INT_ARRAY: return *ai == *other.ai;
+		case FLOAT_ARRAY: return *af == *other.af;
+		case DOUBLE_ARRAY: return *ad == *other.ad;
+		default: break;
+		}
+	}
+	for (int j = 0; j < n; j++)
+		if (item(j) != other.item(j))
+			return false;
+	return true;
+}
+
+bool Var::contains(const Var& x) const
+{
+	if (_type == ARRAY)
+		return a->contains(x);
+	if (_type == PACKED)
+		return (*a)[0].contains(x);
+	if (_type < INT_ARRAY || !x.is(NUMBER))
+		return false;
+	for (int j = 0, n = length(); j < n; j++)
+		if (item(j) == x)
+			return true;
+	return false;
+}
+
 void Var::operator=(const Var& v)
 {
 	if(_type == STRING && v._type == STRING) {
@@ -332,6 +643,10 @@ void Var::operator=(const Var& v)
 		(*o) = (*v.o);
 		return;
 	}
+	if (_type == PACKED && v._type == PACKED) {
+		(*a) = (*v.a);
+		return;
+	}
 	//if(_type!=NONE)
 	if(!isPod())
 		free();
@@ -348,6 +663,18 @@ void Var::operator=(const Var& v)
 	case DIC:
 		NEW_DICC(o, *v.o);
 		break;
+	case PACKED:
+		NEW_ARRAYC(a, *v.a);
+		break;
+	case INT_ARRAY:
+		ai.construct(*v.ai);
+		break;
+	case FLOAT_ARRAY:
+		af.construct(*v.af);
+		break;
+	case DOUBLE_ARRAY:
+		ad.construct(*v.ad);
+		break;
 	default: break;
 	}
 }
@@ -475,8 +802,10 @@ void Var::operator=(const String& x)
 	}
 }
 
-const Var& Var::operator[](int i) const
+Var Var::operator[](int i) const
 {
+	if (_type > DIC)
+		return item(i);
 	if(_type==ARRAY)
 	{
 		return (*a)[i];
@@ -492,6 +821,15 @@ const Var& Var::operator[](int i) const
 
 Var& Var::operator[](int i)
 {
+	if (_type == PACKED)
+	{
+		Var& r = (*a)[0];
+		if (r._type > DIC)
+			r.unpack();
+		return r[i];
+	}
+	if (_type > DIC)
+		unpack();
 	if(_type==ARRAY)
 	{
 		if(i >= a->length())
@@ -551,6 +889,14 @@ int Var::length() const
 		return s->length()-1; break;
 	case SSTRING:
 		return (int)strlen(ss); break;
+	case PACKED:
+		return (*a)[0].length();
+	case INT_ARRAY:
+		return ai->length();
+	case FLOAT_ARRAY:
+		return af->length();
+	case DOUBLE_ARRAY:
+		return ad->length();
 	default:
 		break;
 	}
@@ -559,6 +905,24 @@ int Var::length() const
 
 Var& Var::operator<<(const Var& x)
 {
+	if (_type == PACKED)
+	{
+		(*a)[0] << x;
+		return *this;
+	}
+	if (_type > DIC)
+	{
+		if (x._type == packedType())
+		{
+			switch (_type) {
+			case INT_ARRAY: (*ai) << x.i; break;
+			case FLOAT_ARRAY: (*af) << (float)x.d; break;
+			default: (*ad) << x.d; break;
+			}
+			return *this;
+		}
+		unpack();
+	}
 	if(_type==ARRAY)
 		(*a) << x;
 	else if(_type==NONE)
@@ -588,6 +952,19 @@ Var Var::clone() const
 		foreach(Var& x, *v.o)
 			x = x.clone();
 		break;
+	case PACKED:
+		v.a->dup();
+		(*v.a)[0] = (*a)[0].clone();
+		break;
+	case INT_ARRAY:
+		v.ai->dup();
+		break;
+	case FLOAT_ARRAY:
+		v.af->dup();
+		break;
+	case DOUBLE_ARRAY:
+		v.ad->dup();
+		break;
 	default:
 		break;
 	}
@@ -6,6 +6,7 @@
 #include <asl/util.h>
 #include <asl/Http.h>
 #include <asl/JSON.h>
+#include <asl/StringBuilder.h>
 #ifdef ASL_TLS
 #include <asl/TlsSocket.h>
 #endif
@@ -343,31 +344,40 @@ WebSocketMsg WebSocket::receive()
 
 void WebSocket::send(const Var& v)
 {
-	send(Json::encode(v));
+	StringBuilder out;
+	Json::encode(v, out);
+	send(out);
 }
 
-void WebSocket::send(const byte* p, int length, FrameType type)
+static void putFrameHeader(StreamBuffer& buf, WebSocket::FrameType type, Long len, unsigned mask)
 {
-	if (length <= 0 || _closed)
-		return;
-	byte opcode = (type == FRAME_TEXT) ? 1 : (type == FRAME_BINARY) ? 2 : (type == FRAME_PONG) ? 10 : (type == FRAME_PING) ? 9 : 8;
+	byte opcode = (type == WebSocket::FRAME_TEXT) ? 1 : (type == WebSocket::FRAME_BINARY) ? 2 :
+		(type == WebSocket::FRAME_PONG) ? 10 : (type == WebSocket::FRAME_PING) ? 9 : 8;
 	byte b0 = 0x80 | opcode;
-	byte masked = _isClient ? 0x80 : 0;
-	StreamBuffer buf(ENDIAN_BIG);
+	byte masked = mask != 0 ? 0x80 : 0;
 	buf << b0;
-	Long len = length;
 	if (len < 126)
 		buf << byte(masked | (byte)len);
 	else if (len < (1 << 16))
 		buf << byte(masked | (byte)126) << (unsigned short)len;
 	else
 		buf << byte(masked | (byte)127) << len;
+	if (mask != 0)
+		buf << mask;
+}
 
+void WebSocket::send(const byte* p, int length, FrameType type)
+{
+	if (length <= 0 || _closed)
+		return;
+	StreamBuffer buf(ENDIAN_BIG);
 	unsigned mask = 0;
 	if (_isClient) {
 		mask = _random.get();
-		buf << mask;
+		if (mask == 0)
+			mask = 1;
 	}
+	putFrameHeader(buf, type, length, mask);
 	Array<byte> data(p, length);
 	if (mask != 0){
 		swapBytes(mask);
@@ -383,6 +393,45 @@ void WebSocket::send(const byte* p, int length, FrameType type)
 		_socket << *buf << data;
 }
 
+void WebSocket::send(const StringBuilder& m, FrameType type)
+{
+	Long length = 0; // only the blocks still held (a builder with a sink may have flushed some)
+	for (int i = 0; i < m.numBlocks(); i++)
+		length += m.block(i).length();
+	if (length <= 0 || _closed)
+		return;
+	StreamBuffer buf(ENDIAN_BIG);
+	unsigned mask = 0;
+	if (_isClient) {
+		mask = _random.get();
+		if (mask == 0)
+			mask = 1;
+	}
+	putFrameHeader(buf, type, length, mask);
+	// the header and the blocks go out in one gather write; client frames need masked copies of the blocks
+	Array<StringView> parts;
+	Array<Array<byte> > masked;
+	parts << StringView((const char*)buf.ptr(), buf.length());
+	byte key[4] = { byte(mask >> 24), byte(mask >> 16), byte(mask >> 8), byte(mask) };
+	Long offset = 0;
+	for (int i = 0; i < m.numBlocks(); i++)
+	{
+		StringView b = m.block(i);
+		if (mask != 0)
+		{
+			Array<byte> data((const byte*)b.data(), b.length());
+			for (int j = 0; j < data.length(); j++)
+				data[j] ^= key[(offset + j) & 3];
+			masked << data;
+			b = StringView((const char*)data.ptr(), data.length());
+		}
+		offset += b.length();
+		parts << b;
+	}
+	if (!_closed || _socket.disconnected())
+		_socket.writeBlocks(parts.ptr(), parts.length());
+}
+
 bool WebSocket::wait(double timeout)
 {
 	return _socket.waitInput(timeout);
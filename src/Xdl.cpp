@@ -1,19 +1,13 @@
 #include <asl/Xdl.h>
 #include <asl/TextFile.h>
+#include <asl/MappedFile.h>
 #include <stdio.h>
 #include <ctype.h>
-#include <locale.h>
 
 #if defined(_MSC_VER) && _MSC_VER < 1800
 #include <float.h>
 #endif
 
-#ifdef ASL_FAST_JSON
-#define ASL_ATOF myatof
-#else
-#define ASL_ATOF atof
-#endif
-
 namespace asl {
 
 enum StateN {
@@ -38,6 +32,30 @@ Var Json::decode(const String& json)
 	return parser.decode(json);
 }
 
+Var Xdl::decode(const String& xdl, int mode)
+{
+	XdlParser parser;
+	parser.setPacked((mode & Json::PACKED) != 0);
+	return parser.decode(xdl);
+}
+
+Var Json::decode(const String& json, Mode mode)
+{
+	return Xdl::decode(json, mode);
+}
+
+Var Xdl::decode(const String& xdl, Arena& arena, int mode)
+{
+	XdlParser parser(arena);
+	parser.setPacked((mode & Json::PACKED) != 0);
+	return parser.decode(xdl);
+}
+
+Var Json::decode(const String& json, Arena& arena, Mode mode)
+{
+	return Xdl::decode(json, arena, mode);
+}
+
 String Xdl::encode(const Var& data, int mode)
 {
 	XdlEncoder encoder;
@@ -49,9 +67,37 @@ String Json::encode(const Var& data, Json::Mode mode)
 	return Xdl::encode(data, mode | Json::JSON);
 }
 
+void Xdl::encode(const Var& data, StringBuilder& out, int mode)
+{
+	XdlEncoder encoder(out);
+	encoder.append(data, Json::Mode(mode));
+}
+
+void Json::encode(const Var& data, StringBuilder& out, Json::Mode mode)
+{
+	Xdl::encode(data, out, mode | Json::JSON);
+}
+
 Var Xdl::read(const String& file)
 {
 	XdlParser parser;
+	MappedFile mapped(file);
+	if (mapped)
+	{
+		const char* p = mapped.ptr();
+		Long n = mapped.length();
+		if (n >= 3 && p[0] == '\xef' && p[1] == '\xbb' && p[2] == '\xbf')
+		{
+			p += 3;
+			n -= 3;
+		}
+		if (n == 0)
+			return Var();
+		for (Long i = 0; i < n; i += 1 << 30)
+			parser.parse(p + i, (int)min(n - i, (Long)1 << 30));
+		parser.parse(" ");
+		return parser.value();
+	}
 	TextFile tfile(file, File::READ);
 	if (!tfile)
 		return Var();
@@ -74,7 +120,13 @@ Var Xdl::read(const String& file)
 
 bool Xdl::write(const String& file, const Var& v, int mode)
 {
-	return TextFile(file).put(Xdl::encode(v, mode));
+	TextFile tfile(file, File::WRITE);
+	if (!tfile)
+		return false;
+	StringBuilder out(tfile);
+	Xdl::encode(v, out, mode);
+	out.flush();
+	return !out.error();
 }
 
 Var Json::read(const String& file)
@@ -85,7 +137,7 @@ Var Json::read(const String& file)
 
 bool Json::write(const String& file, const Var& v, Json::Mode mode)
 {
-	return TextFile(file).put(Json::encode(v, mode));
+	return Xdl::write(file, v, mode | Json::JSON);
 }
 
 
@@ -104,11 +156,18 @@ void XdlParser::reset()
 }
 
 void XdlParser::parse(const char* s)
+{
+	parse(s, (int)strlen(s));
+}
+
+void XdlParser::parse(const char* s, int n)
 {
 	if(_state == ERR)
 		return;
-	while(char c=*s++)
+	const char* end = s + n;
+	while(s < end)
 	{
+		char c = *s++;
 		Context ctx = _context.top();
 		if(!_inComment)
 		{
@@ -209,7 +268,7 @@ void XdlParser::parse(const char* s)
 					return;
 
 				if (_buffer.length() > 9) // check better if it fits in an int32
-					new_number(ASL_ATOF(_buffer));
+					new_number(myatof(*_buffer, *_buffer + _buffer.length()));
 				else
 					new_number(myatoiz(_buffer));
 				value_end();
@@ -269,15 +328,7 @@ void XdlParser::parse(const char* s)
 			}
 			else if (c == ',' || myisspace(c) || c == ']' || c == '}')
 			{
-#ifndef ASL_FAST_JSON
-				for (char* p = _buffer; *p; p++)
-					if (*p == '.')
-					{
-						*p = _ldp;
-						break;
-					}
-#endif
-				new_number(ASL_ATOF(_buffer));
+				new_number(myatof(*_buffer, *_buffer + _buffer.length()));
 				value_end();
 				s--;
 			}
@@ -299,15 +350,7 @@ void XdlParser::parse(const char* s)
 			}
 			else if(c == ',' || myisspace(c) || c == ']' || c == '}')
 			{
-#ifndef ASL_FAST_JSON
-				for(char* p = _buffer; *p; p++)
-					if (*p == '.')
-					{
-						*p = _ldp;
-						break;
-					}
-#endif
-				new_number(ASL_ATOF(_buffer));
+				new_number(myatof(*_buffer, *_buffer + _buffer.length()));
 				value_end();
 				s--;
 			}
@@ -529,7 +572,8 @@ void XdlParser::parse(const char* s)
 				}
 				else if(_buffer=="null")
 				{
-					put(Var::NUL);
+					Var v(Var::NUL);
+					put(v);
 					value_end();
 				}
 				else
@@ -569,11 +613,21 @@ void XdlParser::parse(const char* s)
 
 XdlParser::XdlParser()
 {
-	lconv* loc = localeconv();
-	_ldp = *loc->decimal_point;
 	_context << ROOT;
 	_state = WAIT_VALUE;
 	_inComment = false;
+	_arena = 0;
+	_packed = false;
+	_lists << Var(Var::ARRAY);
+}
+
+XdlParser::XdlParser(Arena& arena)
+{
+	_context << ROOT;
+	_state = WAIT_VALUE;
+	_inComment = false;
+	_arena = &arena;
+	_packed = false;
 	_lists << Var(Var::ARRAY);
 }
 
@@ -601,30 +655,64 @@ Var XdlParser::decode(const char* s)
 	return value();
 }
 
+// values are moved (not copied) into their parent container, which avoids copying strings
 
 void XdlParser::begin_array()
 {
-	_lists << Var::ARRAY;
+	_lists << Var();
+	_lists.top().init(Var::ARRAY, _arena);
 }
 
 void XdlParser::end_array()
 {
-	Var v = _lists.top();
+	Var v;
+	swap(v, _lists.top());
 	_lists.pop();
 	put(v);
 }
 
+// objects in an array usually have the same keys as the previous one, so their key-value list is created with those
+// keys already in place (then properties are found instead of inserted, and keys that did not appear are removed);
+// and as keys usually come in the same order, the position of each one is first tried where it was in the previous
+// object at the same level. Keys are still copied into each object: those longer than 15 chars (not stored inline in
+// String) take a heap block per object, as there is no shared key store
+
 void XdlParser::begin_object(const char* _class)
 {
-	_lists << Var(Var::DIC);
+	_lists << Var();
+	Var& obj = _lists.top();
+	obj.init(Var::DIC, _arena);
+	int level = _lists.length() - 1;
+	if (_keyCount.length() <= level)
+	{
+		_keyCount.resize(level + 1);
+		_keyOrder.resize(level + 1);
+	}
+	_keyCount[level] = 0;
+	const Var& parent = _lists[_lists.length() - 2];
+	int n = parent._type == Var::ARRAY ? parent.a->length() : 0;
+	if (n > 0 && (*parent.a)[n - 1]._type == Var::DIC)
+	{
+		typedef Map<String, Var>::KeyVal KeyVal;
+		const Array<KeyVal>& shape = (*parent.a)[n - 1].o->kv();
+		Array<KeyVal> kv = _arena ? Array<KeyVal>(*_arena, shape.length()) : Array<KeyVal>(shape.length());
+		for (int i = 0; i < kv.length(); i++)
+			kv[i].key = shape[i].key;
+		obj.o->kv() = kv;
+	}
 	if(_class[0] != '\0')
-		_lists.top()[ASL_XDLCLASS] = _class;
+		obj[ASL_XDLCLASS] = _class;
 }
 
 void XdlParser::end_object()
 {
-	Var v = _lists.top();
+	Var v;
+	swap(v, _lists.top());
 	_lists.pop();
+	Array<Map<String, Var>::KeyVal>& kv = v.o->kv();
+	for (int i = kv.length() - 1; i >= 0; i--)
+		if (kv[i].value._type == Var::NONE)
+			kv.remove(i);
 	put(v);
 }
 
@@ -633,16 +721,52 @@ void XdlParser::new_property(const String& name)
 	_props << name;
 }
 
-void XdlParser::put(const Var& x)
+void XdlParser::put(Var& x)
 {
 	Var& top = _lists.top();
 	switch(top.type())
 	{
 	case Var::ARRAY:
-		top << x;
+		// arrays of numbers can be kept packed (integers are widened to doubles if other numbers follow)
+		if (_packed && (x._type == Var::INT || x._type == Var::NUMBER) && _lists.length() > 1)
+		{
+			Var::Type t = top.packedType();
+			if (top._type == Var::ARRAY && top.a->length() == 0)
+				top.init((t = x._type) == Var::INT ? Var::INT_ARRAY : Var::DOUBLE_ARRAY, _arena);
+			if (t == Var::INT && x._type == Var::NUMBER)
+				top.pack(t = Var::NUMBER);
+			if (t == Var::NUMBER && x._type == Var::INT)
+			{
+				top << Var((double)x.i);
+				break;
+			}
+		}
+		if (top._type == Var::ARRAY)
+		{
+			Array<Var>& items = *top.a;
+			items.resize(items.length() + 1);
+			swap(items[items.length() - 1], x);
+		}
+		else
+			top << x;
 		break;
 	case Var::DIC: {
-		top[_props.top()] = x;
+		typedef Map<String, Var>::KeyVal KeyVal;
+		Array<KeyVal>& kv = top.o->kv();
+		const String& key = _props.top();
+		int level = _lists.length() - 1;
+		int k = _keyCount[level]++;
+		Array<int>& order = _keyOrder[level];
+		int i = k < order.length() ? order[k] : -1;
+		if (i < 0 || i >= kv.length() || kv[i].key != key)
+		{
+			Var& value = top[key];
+			i = int(((char*)&value - (char*)kv.ptr()) / sizeof(KeyVal)); // the slot where it was found or inserted
+		}
+		if (k >= order.length())
+			order.resize(k + 1);
+		order[k] = i;
+		swap(kv[i].value, x);
 		_props.pop();
 		break;
 	}
@@ -650,32 +774,49 @@ void XdlParser::put(const Var& x)
 	}
 }
 
-XdlEncoder::XdlEncoder()
+XdlEncoder::XdlEncoder() : _out(_buffer)
 {
 	_level = 0;
 	_pretty = false;
 	_json = false;
-	_out.resize(512);
 	_sep1 = ',';
 	_sep2 = ',';
 }
 
-String XdlEncoder::encode(const Var& v, Json::Mode mode)
+XdlEncoder::XdlEncoder(StringBuilder& out) : _out(out)
+{
+	_level = 0;
+	_pretty = false;
+	_json = false;
+	_sep1 = ',';
+	_sep2 = ',';
+}
+
+void XdlEncoder::setMode(Json::Mode mode)
 {
 	_pretty = (mode & Json::PRETTY) != 0;
 	_json = (mode & Json::JSON) != 0;
 	_simple = (mode & Json::SIMPLE) != 0;
-	_fmtF = _simple ? "%.7g" : "%.9g";
-	_fmtD = _simple ? "%.15g" : "%.17g";
-	if (_pretty)
-		_sep1 = ", ";
-	if (!_json && _pretty)
-		_sep2 = "";
+	_digitsF = _simple ? 7 : 9;
+	_digitsD = _simple ? 15 : 17;
+	_sep1 = _pretty ? ", " : ",";
+	_sep2 = (!_json && _pretty) ? "" : ",";
+}
+
+String XdlEncoder::encode(const Var& v, Json::Mode mode)
+{
+	setMode(mode);
 	reset();
 	_encode(v);
 	return data();
 }
 
+void XdlEncoder::append(const Var& v, Json::Mode mode)
+{
+	setMode(mode);
+	_encode(v);
+}
+
 
 void XdlEncoder::_encode(const Var& v)
 {
@@ -702,12 +843,13 @@ void XdlEncoder::_encode(const Var& v)
 	case Var::ARRAY: {
 		begin_array();
 		int n = v.length();
-		const Var& v0 = n>0? v[0] : v;
+		const Array<Var>& items = *v.a;
+		const Var& v0 = n>0? items[0] : v;
 		bool multi = (_pretty && (n > 10 || (n>0  && (v0.is(Var::ARRAY) || v0.is(Var::DIC)))));
 		if (!multi && v0.is(Var::STRING))
 		{
 			for(int i = 0; i < n; i++)
-				if (v[i].length() > 10)
+				if (items[i].length() > 10)
 				{
 					multi = true;
 					break;
@@ -727,7 +869,7 @@ void XdlEncoder::_encode(const Var& v)
 				else
 					_out << _sep1;
 			}
-			_encode(v[i]);
+			_encode(items[i]);
 		}
 		if(multi) {
 			_indent = String(INDENT_CHAR, --_level);
@@ -736,6 +878,14 @@ void XdlEncoder::_encode(const Var& v)
 		end_array();
 		break;
 		}
+	case Var::PACKED:
+		_encode((*v.a)[0]);
+		break;
+	case Var::INT_ARRAY:
+	case Var::FLOAT_ARRAY:
+	case Var::DOUBLE_ARRAY:
+		encodePacked(v);
+		break;
 	case Var::DIC: {
 		bool hasclass = !_json && v.has(ASL_XDLCLASS);
 		if(hasclass)
@@ -743,7 +893,9 @@ void XdlEncoder::_encode(const Var& v)
 		else
 			begin_object("");
 		int k = (hasclass && _json)?1:0;
-		_indent = String(INDENT_CHAR, ++_level);
+		_level++;
+		if (_pretty)
+			_indent = String(INDENT_CHAR, _level);
 		foreach2(String& name, Var& value, v)
 		{
 			if(value.ok() && (_json || name != ASL_XDLCLASS))
@@ -757,8 +909,9 @@ void XdlEncoder::_encode(const Var& v)
 				_encode(value);
 			}
 		}
+		_level--;
 		if(_pretty) {
-			_indent = String(INDENT_CHAR, --_level);
+			_indent = String(INDENT_CHAR, _level);
 			_out << '\n' << _indent;
 		}
 		end_object();
@@ -773,6 +926,40 @@ void XdlEncoder::_encode(const Var& v)
 	}
 }
 
+// writes a packed numeric array directly from its elements, with the same layout as a Var array of numbers
+
+void XdlEncoder::encodePacked(const Var& v)
+{
+	begin_array();
+	int n = v.length();
+	bool multi = _pretty && n > 10;
+	if (multi)
+	{
+		_indent = String(INDENT_CHAR, ++_level);
+		_out << '\n' << _indent;
+	}
+	for (int i = 0; i < n; i++)
+	{
+		if (i > 0) {
+			if (multi && (i % 16) == 0)
+				_out << _sep2 << '\n' << _indent;
+			else
+				_out << _sep1;
+		}
+		switch (v._type)
+		{
+		case Var::INT_ARRAY: new_number((*v.ai)[i]); break;
+		case Var::FLOAT_ARRAY: new_number((*v.af)[i]); break;
+		default: new_number((*v.ad)[i]); break;
+		}
+	}
+	if (multi) {
+		_indent = String(INDENT_CHAR, --_level);
+		_out << '\n' << _indent;
+	}
+	end_array();
+}
+
 void XdlEncoder::put_separator()
 {
 	_out << ',';
@@ -780,19 +967,16 @@ void XdlEncoder::put_separator()
 
 void XdlEncoder::reset()
 {
-	_out = "";
+	_out.clear();
 }
 
 void XdlEncoder::new_number(int x)
 {
-	int n = _out.length();
-	_out.resize(n+11);
-	_out.fix(n + myitoa(x, &_out[n]));
+	_out << x;
 }
 
 void XdlEncoder::new_number(double x)
 {
-	int n = _out.length();
 #if defined(_MSC_VER) && _MSC_VER < 1800
 	if (!_finite(x))
 #else
@@ -805,26 +989,11 @@ void XdlEncoder::new_number(double x)
 			_out << ((x < 0)? "-1e400" : "1e400");
 		return;
 	}
-	_out.resize(n+26);
-	_out.fix(n + sprintf(&_out[n], _fmtD, x));
-
-	// Fix decimal comma of some locales
-#ifndef ASL_NO_FIX_DOT
-	char* p = &_out[n];
-	while (*p)
-	{
-		if (*p == ',') {
-			*p = '.';
-			break;
-		}
-		p++;
-	}
-#endif
+	_out.commit(myftoa(x, _out.reserve(26), _digitsD));
 }
 
 void XdlEncoder::new_number(float x)
 {
-	int n = _out.length();
 #if defined(_MSC_VER) && _MSC_VER < 1800
 	if (!_finite(x))
 #else
@@ -837,29 +1006,23 @@ void XdlEncoder::new_number(float x)
 			_out << ((x < 0) ? "-1e400" : "1e400");
 		return;
 	}
-	_out.resize(n + 16);
-	_out.fix(n + sprintf(&_out[n], _fmtF, x));
-
-	// Fix decimal comma of some locales
-#ifndef ASL_NO_FIX_DOT
-	char* p = &_out[n];
-	while (*p)
-	{
-		if (*p == ',') {
-			*p = '.';
-			break;
-		}
-		p++;
-	}
-#endif
+	_out.commit(myftoa(x, _out.reserve(16), _digitsF));
 }
 
 void XdlEncoder::new_string(const char* x)
 {
 	_out << '\"';
 	const char* p = x;
-	while(char c = *p++) // optimizable: not appending chars directly
+	while (1)
 	{
+		const char* p0 = p;
+		while (*p != '\\' && *p != '\"' && (byte)*p >= 32)
+			p++;
+		if (p > p0)
+			_out.append(p0, int(p - p0));
+		char c = *p++;
+		if (c == 0)
+			break;
 		if(c=='\\')
 			_out << "\\\\";
 		else if (c == '\"')
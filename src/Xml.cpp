@@ -1,6 +1,7 @@
 #include <asl/Xml.h>
 #include <asl/Stack.h>
 #include <asl/TextFile.h>
+#include <asl/MappedFile.h>
 #include <stdio.h>
 
 #define INDENT_CHAR '\t'
@@ -9,6 +10,20 @@ namespace asl {
 
 Xml Xml::read(const String& file)
 {
+	MappedFile mapped(file);
+	if (mapped && mapped.length() < 0x7fffffff)
+	{
+		const char* p = mapped.ptr();
+		int n = (int)mapped.length();
+		if (n >= 2 && (((byte)p[0] == 0xff && (byte)p[1] == 0xfe) || ((byte)p[0] == 0xfe && (byte)p[1] == 0xff)))
+			return Xml::decode(TextFile(file).text());
+		if (n >= 3 && p[0] == '\xef' && p[1] == '\xbb' && p[2] == '\xbf')
+		{
+			p += 3;
+			n -= 3;
+		}
+		return Xml::decode(p, n);
+	}
 	return Xml::decode(TextFile(file).text());
 }
 
@@ -17,8 +32,13 @@ bool Xml::write(const String& path, const Xml& e)
 	TextFile file(path, File::WRITE);
 	if (!file)
 		return false;
-	file << "<?xml version=\"1.0\"?>\n" << Xml::encode(e, true) << "\n";
-	return true;
+	StringBuilder out(file);
+	out << "<?xml version=\"1.0\"?>\n";
+	XmlCodec c(out);
+	c.encode(e);
+	out << '\n';
+	out.flush();
+	return !out.error();
 }
 
 Xml::Xml(const String& tag, const String& val) : NodeBase(new _Xml(tag))
@@ -116,7 +136,12 @@ Xml& Xml::operator<<(const String& t)
 
 Xml Xml::decode(const String& x)
 {
-	if (x == "")
+	return decode(*x, x.length());
+}
+
+Xml Xml::decode(const char* x, int n)
+{
+	if (n == 0)
 		return Xml(0);
 	Dic<char> entities;
 	entities["amp"] = '&';
@@ -135,16 +160,26 @@ Xml Xml::decode(const String& x)
 	};
 	State state = FREE;
 	State lastState = FREE;
-	char* p = x;
+	const char* p = x;
+	const char* end = x + n;
 	int anglecount = 0;
 	
-	if (x.startsWith("<?xml"))
-		p += x.indexOf("?>") + 2;
+	if (n >= 5 && memcmp(x, "<?xml", 5) == 0)
+	{
+		const char* q = p + 5;
+		while (q + 1 < end && !(q[0] == '?' && q[1] == '>'))
+			q++;
+		if (q + 1 < end)
+			p = q + 2;
+	}
 
 	// markupdecl: <!DOCTYPE, <!ENTITY, <!ATTLIST, <?PI
 		
-	while (char c = *p++)
+	while (p < end)
 	{
+		char c = *p++;
+		if (!c)
+			break;
 		//printf("[%c]: ", c);
 
 		switch (state)
@@ -430,9 +465,17 @@ Xml Xml::decode(const String& x)
 
 void XmlCodec::escape(const String& s)
 {
-	char* p = s;
-	while (char c = *p++)
+	const char* p = s;
+	while (1)
 	{
+		const char* p0 = p;
+		while (*p && *p != '&' && *p != '<' && *p != '>' && *p != '\'' && *p != '\"')
+			p++;
+		if (p > p0)
+			_xml.append(p0, int(p - p0));
+		char c = *p++;
+		if (c == 0)
+			break;
 		switch (c)
 		{
 		case '&': _xml << "&amp;"; break;
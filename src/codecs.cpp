@@ -0,0 +1,409 @@
+#include <asl/util.h>
+#include <asl/StringBuilder.h>
+#include "simd.h"
+
+#ifdef ASL_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace asl {
+
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char base64url_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// value of each char in both base64 alphabets, or B64_SPACE, B64_PAD ('=') or B64_BAD
+
+enum { B64_SPACE = 128, B64_PAD = 129, B64_BAD = 255 };
+
+static const byte base64_values[256] = {
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 128, 128, 255, 255, 128, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	128, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255,  62, 255,  63,
+	 52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 129, 255, 255,
+	255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+	 15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255,  63,
+	255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,
+	 41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+	255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+#ifdef ASL_X86_AVX2
+
+// Base64 with AVX2 (W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding Using AVX2 Instructions", 2018):
+// each 32-bit lane holds one group of 3 bytes / 4 chars. Both return the number of input bytes (or chars) processed.
+
+ASL_TARGET_AVX2 static int encodeBase64Avx(const byte* s, int n, char* d, bool url)
+{
+	const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const char c62 = url ? '-' - 62 : '+' - 62, c63 = url ? '_' - 63 : '/' - 63;
+	const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, c62, c63, 'A', 0, 0);
+	int i = 0;
+	for (; i + 28 <= n; i += 24, d += 32) // 24 bytes are used, but 28 are read
+	{
+		__m128i lo = _mm_loadu_si128((const __m128i*)(s + i)), hi = _mm_loadu_si128((const __m128i*)(s + i + 12));
+		__m256i x = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuffle);
+		__m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(x, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+		__m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(x, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+		__m256i v = _mm256_or_si256(t0, t1); // 6-bit values
+		__m256i k = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+		k = _mm256_or_si256(k, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v), _mm256_set1_epi8(13)));
+		_mm256_storeu_si256((__m256i*)d, _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets, k)));
+	}
+	return i;
+}
+
+ASL_TARGET_AVX2 static inline __m256i inRange(__m256i c, char a, char b)
+{
+	return _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(a - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(b + 1), c));
+}
+
+ASL_TARGET_AVX2 static inline __m256i masked(__m256i mask, char x)
+{
+	return _mm256_and_si256(mask, _mm256_set1_epi8(x));
+}
+
+// decodes blocks of 32 chars of any of both alphabets until one has other chars (whitespace, padding or invalid);
+// writes 8 bytes past the output
+
+ASL_TARGET_AVX2 static int decodeBase64Avx(const byte* s, int n, byte* d)
+{
+	int i = 0;
+	for (; i + 32 <= n; i += 32, d += 24)
+	{
+		__m256i c = _mm256_loadu_si256((const __m256i*)(s + i));
+		__m256i upper = inRange(c, 'A', 'Z'), lower = inRange(c, 'a', 'z'), digit = inRange(c, '0', '9');
+		__m256i plus = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+')), minus = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-'));
+		__m256i slash = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/')), under = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+		__m256i valid = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, plus)),
+			_mm256_or_si256(_mm256_or_si256(minus, slash), under));
+		if (_mm256_movemask_epi8(valid) != -1)
+			break;
+		__m256i offset = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(masked(upper, -65), masked(lower, -71)),
+			_mm256_or_si256(masked(digit, 4), masked(plus, 19))), _mm256_or_si256(_mm256_or_si256(masked(minus, 17),
+			masked(slash, 16)), masked(under, -32)));
+		__m256i v = _mm256_add_epi8(c, offset);
+		__m256i x = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		x = _mm256_madd_epi16(x, _mm256_set1_epi32(0x00011000));
+		x = _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+		x = _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+		_mm256_storeu_si256((__m256i*)d, x);
+	}
+	return i;
+}
+
+#endif
+
+// encodes n bytes (a multiple of 3)
+
+static char* encodeGroups(const byte* s, int n, char* d, const char* chars)
+{
+#ifdef ASL_X86_AVX2
+	if (n >= 28 && hasAvx2())
+	{
+		int k = encodeBase64Avx(s, n, d, chars == base64url_chars);
+		s += k;
+		d += k / 3 * 4;
+		n -= k;
+	}
+#endif
+	for (; n >= 3; n -= 3, s += 3, d += 4)
+	{
+		unsigned u = (s[0] << 16) | (s[1] << 8) | s[2];
+		d[0] = chars[u >> 18];
+		d[1] = chars[(u >> 12) & 0x3f];
+		d[2] = chars[(u >> 6) & 0x3f];
+		d[3] = chars[u & 0x3f];
+	}
+	return d;
+}
+
+// encodes the last 1 or 2 bytes
+
+static char* encodeTail(const byte* s, int n, char* d, const char* chars, bool pad)
+{
+	unsigned u = (s[0] << 16) | (n > 1 ? s[1] << 8 : 0);
+	*d++ = chars[u >> 18];
+	*d++ = chars[(u >> 12) & 0x3f];
+	if (n > 1)
+		*d++ = chars[(u >> 6) & 0x3f];
+	else if (pad)
+		*d++ = '=';
+	if (pad)
+		*d++ = '=';
+	return d;
+}
+
+// decodes groups of 4 valid chars until one has other chars, returns the number of chars used
+
+static int decodeGroups(const byte* s, int n, byte* d)
+{
+	int i = 0;
+#ifdef ASL_X86_AVX2
+	if (n >= 32 && hasAvx2())
+	{
+		i = decodeBase64Avx(s, n, d);
+		d += i / 4 * 3;
+	}
+#endif
+	for (; i + 4 <= n; i += 4, d += 3)
+	{
+		unsigned a = base64_values[s[i]], b = base64_values[s[i + 1]], c = base64_values[s[i + 2]],
+			e = base64_values[s[i + 3]];
+		if ((a | b | c | e) & 0x80)
+			break;
+		unsigned u = (a << 18) | (b << 12) | (c << 6) | e;
+		d[0] = byte(u >> 16);
+		d[1] = byte(u >> 8);
+		d[2] = byte(u);
+	}
+	return i;
+}
+
+String encodeBase64(const byte* data, int n)
+{
+	int len = 4 * ((n + 2) / 3);
+	String output(len, len);
+	char* d = encodeGroups(data, n / 3 * 3, &output[0], base64_chars);
+	if (n % 3 != 0)
+		encodeTail(data + n / 3 * 3, n % 3, d, base64_chars, true);
+	return output;
+}
+
+String encodeBase64Url(const byte* data, int n)
+{
+	int len = n / 3 * 4 + (n % 3 != 0 ? n % 3 + 1 : 0);
+	String output(len, len);
+	char* d = encodeGroups(data, n / 3 * 3, &output[0], base64url_chars);
+	if (n % 3 != 0)
+		encodeTail(data + n / 3 * 3, n % 3, d, base64url_chars, false);
+	return output;
+}
+
+Array<byte> decodeBase64(const char* src, int n)
+{
+	Array<byte> output;
+	Base64Decoder decoder;
+	if (!decoder.decode(src, n < 0 ? (int)strlen(src) : n, output) || !decoder.finish(output))
+		output.clear();
+	return output;
+}
+
+Base64Encoder::Base64Encoder(bool url)
+{
+	_n = 0;
+	_url = url;
+}
+
+void Base64Encoder::encode(const byte* data, int n, StringBuilder& out)
+{
+	const char* chars = _url ? base64url_chars : base64_chars;
+	if (_n > 0)
+	{
+		while (_n < 3 && n > 0)
+		{
+			_rest[_n++] = *data++;
+			n--;
+		}
+		if (_n < 3)
+			return;
+		char* d = out.reserve(4);
+		out.commit(int(encodeGroups(_rest, 3, d, chars) - d));
+		_n = 0;
+	}
+	while (n >= 3)
+	{
+		int k = min(n / 3, 16384) * 3; // the builder is given up to 64 KB at a time
+		char* d = out.reserve(k / 3 * 4);
+		out.commit(int(encodeGroups(data, k, d, chars) - d));
+		data += k;
+		n -= k;
+	}
+	while (n > 0)
+	{
+		_rest[_n++] = *data++;
+		n--;
+	}
+}
+
+void Base64Encoder::finish(StringBuilder& out)
+{
+	if (_n == 0)
+		return;
+	char* d = out.reserve(4);
+	out.commit(int(encodeTail(_rest, _n, d, _url ? base64url_chars : base64_chars, !_url) - d));
+	_n = 0;
+}
+
+Base64Decoder::Base64Decoder()
+{
+	_n = 0;
+	_pad = 0;
+	_error = false;
+}
+
+bool Base64Decoder::decode(const char* src, int n, Array<byte>& out)
+{
+	int n0 = out.length();
+	out.resize(n0 + (n + _n) / 4 * 3 + 32); // room for the SIMD stores
+	const byte* s = (const byte*)src;
+	const byte* end = s + n;
+	byte* d = out.ptr() + n0;
+	while (s < end && !_error)
+	{
+		if (_n == 0 && _pad == 0)
+		{
+			int k = decodeGroups(s, int(end - s), d);
+			s += k;
+			d += k / 4 * 3;
+			if (s == end)
+				break;
+		}
+		int v = base64_values[*s++];
+		if (v < 64)
+		{
+			if (_pad > 0)
+				_error = true;
+			_k[_n++] = (byte)v;
+			if (_n == 4)
+			{
+				unsigned u = (_k[0] << 18) | (_k[1] << 12) | (_k[2] << 6) | _k[3];
+				*d++ = byte(u >> 16);
+				*d++ = byte(u >> 8);
+				*d++ = byte(u);
+				_n = 0;
+			}
+		}
+		else if (v == B64_PAD)
+		{
+			if (_n < 2 || _n + ++_pad > 4)
+				_error = true;
+		}
+		else if (v != B64_SPACE)
+			_error = true;
+	}
+	out.resize(int(d - out.ptr()));
+	return !_error;
+}
+
+bool Base64Decoder::finish(Array<byte>& out)
+{
+	bool ok = !_error && _n != 1;
+	if (ok && _n > 1)
+	{
+		unsigned u = (_k[0] << 18) | (_k[1] << 12) | (_n > 2 ? _k[2] << 6 : 0);
+		out << byte(u >> 16);
+		if (_n > 2)
+			out << byte(u >> 8);
+	}
+	_n = 0;
+	_pad = 0;
+	_error = false;
+	return ok;
+}
+
+static const char hex_chars[] = "0123456789abcdef";
+
+static inline int hexValue(byte c)
+{
+	if (unsigned(c - '0') < 10u)
+		return c - '0';
+	c |= 0x20;
+	if (unsigned(c - 'a') < 6u)
+		return c - 'a' + 10;
+	return -1;
+}
+
+#ifdef ASL_HAVE_SSE2
+
+static inline __m128i hexChars(__m128i v)
+{
+	__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+	return _mm_add_epi8(_mm_add_epi8(v, _mm_set1_epi8('0')), letters);
+}
+
+// converts 16 hex digits to their values, returns false if any is not a hex digit
+
+static inline bool hexValues(__m128i c, __m128i& v)
+{
+	__m128i lc = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+	__m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lc, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lc));
+	if (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) != 0xffff)
+		return false;
+	v = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+		_mm_and_si128(alpha, _mm_sub_epi8(lc, _mm_set1_epi8('a' - 10))));
+	return true;
+}
+
+// joins pairs of digit values (the first in the low byte of each 16-bit lane) into bytes
+
+static inline __m128i hexPairs(__m128i v)
+{
+	return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0xff)), 4), _mm_srli_epi16(v, 8));
+}
+
+#endif
+
+String encodeHex(const byte* data, int n)
+{
+	String h(2 * n, 2 * n);
+	char* d = &h[0];
+	int i = 0;
+#ifdef ASL_HAVE_SSE2
+	for (; i + 16 <= n; i += 16, d += 32)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x0f)), lo = _mm_and_si128(x, _mm_set1_epi8(0x0f));
+		_mm_storeu_si128((__m128i*)d, hexChars(_mm_unpacklo_epi8(hi, lo)));
+		_mm_storeu_si128((__m128i*)(d + 16), hexChars(_mm_unpackhi_epi8(hi, lo)));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		*d++ = hex_chars[data[i] >> 4];
+		*d++ = hex_chars[data[i] & 15];
+	}
+	return h;
+}
+
+Array<byte> decodeHex(const char* src, int n)
+{
+	if (n < 0)
+		n = (int)strlen(src);
+	if (n & 1)
+		return Array<byte>();
+	Array<byte> a(n / 2);
+	const byte* s = (const byte*)src;
+	byte* d = a.ptr();
+	int i = 0;
+#ifdef ASL_HAVE_SSE2
+	for (; i + 32 <= n; i += 32, d += 16)
+	{
+		__m128i v0, v1;
+		if (!hexValues(_mm_loadu_si128((const __m128i*)(s + i)), v0) || !hexValues(_mm_loadu_si128((const __m128i*)(s + i + 16)), v1))
+			break;
+		_mm_storeu_si128((__m128i*)d, _mm_packus_epi16(hexPairs(v0), hexPairs(v1)));
+	}
+#endif
+	for (; i < n; i += 2)
+	{
+		int hi = hexValue(s[i]), lo = hexValue(s[i + 1]);
+		if ((hi | lo) < 0)
+			return Array<byte>();
+		*d++ = byte((hi << 4) | lo);
+	}
+	return a;
+}
+
+}
@@ -0,0 +1,59 @@
+// Copyright(c) 1999-2022 aslze
+// Licensed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Internal helpers for code paths that use AVX2 when the CPU supports it (checked at run time)
+
+#ifndef ASL_SIMD_H
+#define ASL_SIMD_H
+
+#include <asl/defs.h>
+
+#if !defined(ASL_NO_SIMD) && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#define ASL_X86_AVX2
+#define ASL_TARGET_AVX2
+#elif (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || defined(__clang__)
+#include <immintrin.h>
+#define ASL_X86_AVX2
+#define ASL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+#ifdef ASL_X86_AVX2
+
+namespace asl {
+
+inline bool checkAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	bool fma = (info[2] & (1 << 12)) != 0, osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+	if (!fma || !osxsave || !avx || (_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+// Returns true if AVX2 and FMA instructions can be used
+
+inline bool hasAvx2()
+{
+	static bool avx2 = checkAvx2();
+	return avx2;
+}
+
+}
+
+#endif
+
+#endif
@@ -2,12 +2,16 @@
 #include <asl/Map.h>
 #include <asl/Var.h>
 #include <asl/Xdl.h>
+#include <asl/Cbor.h>
 #include <asl/CmdArgs.h>
 #include <asl/TabularDataFile.h>
 #include <asl/IniFile.h>
 #include <asl/File.h>
 #include <asl/TextFile.h>
+#include <asl/Directory.h>
+#include <asl/MappedFile.h>
 #include <asl/util.h>
+#include <asl/StringBuilder.h>
 #include <stdio.h>
 #include <asl/testing.h>
 
@@ -49,6 +53,71 @@ ASL_TEST(File)
 	Array<String> lines = TextFile("lines.txt").lines();
 	ASL_ASSERT(lines[0] == line1);
 	ASL_ASSERT(lines[1] == line2);
+
+	TextFile("lines.txt").put("a\r\n\nbc\r\nd");
+	lines = TextFile("lines.txt").lines();
+	ASL_ASSERT(lines.length() == 4 && lines[0] == "a" && lines[1] == "" && lines[2] == "bc" && lines[3] == "d");
+
+	Array<String> lines2;
+	for (TextFile::LineEnumerator line = TextFile("lines.txt").lineViews(); line; ++line)
+		lines2 << *line;
+	ASL_ASSERT(lines2.length() == 4 && lines2[0] == "a" && lines2[1] == "" && lines2[2] == "bc" && lines2[3] == "d");
+#ifdef ASL_HAVE_RANGEFOR
+	int k = 0;
+	for (StringView line : TextFile("lines.txt").lineViews())
+		ASL_ASSERT(line == lines2[k++]);
+	ASL_ASSERT(k == 4);
+#endif
+	TextFile("lines.txt").put(String('x', 3000000) + "\nabc\n");
+	lines2.clear();
+	for (TextFile::LineEnumerator line = TextFile("lines.txt").lineViews(); line; ++line)
+		lines2 << *line;
+	ASL_ASSERT(lines2.length() == 2 && lines2[0].length() == 3000000 && lines2[1] == "abc");
+
+	MappedFile mapped("file.bin");
+	ASL_ASSERT(mapped && mapped.length() == 12);
+	ASL_ASSERT(mapped.data()[0] == 0xfd && mapped.data()[11] == 0x40);
+	ASL_ASSERT(!MappedFile("nonexistent.bin"));
+
+	Var data = Var("a", 1.5)("b", array<Var>("x", true));
+	Json::write("data.json", data);
+	ASL_ASSERT(Json::read("data.json") == data);
+}
+
+ASL_TEST(Directory)
+{
+	String root = Directory::createTemp();
+	ASL_ASSERT(Directory(root).exists());
+	Directory::create(root + "/a/b/c");
+	Directory::create(root + "/d");
+	TextFile(root + "/x.txt").put("x");
+	TextFile(root + "/a/y.txt").put("yy");
+	TextFile(root + "/a/b/c/z.txt").put("zzz");
+	TextFile(root + "/d/w.dat").put("w");
+
+	ASL_ASSERT(Directory(root).files().length() == 1);
+	ASL_ASSERT(Directory(root).subdirs().length() == 2);
+	ASL_ASSERT(Directory(root + "/a").files()[0].size() == 2);
+
+	for (int nth = 1; nth <= 4; nth += 3)
+	{
+		Array<File> files = Directory(root).filesRecursive("*", nth);
+		ASL_ASSERT(files.length() == 4);
+		Array<File> txt = Directory(root).filesRecursive("*.txt", nth);
+		ASL_ASSERT(txt.length() == 3);
+		int size = 0;
+		foreach(File& f, txt)
+			size += (int)f.size();
+		ASL_ASSERT(size == 6);
+	}
+
+	String big = String('q', 300000);
+	TextFile(root + "/big.txt").put(big);
+	ASL_ASSERT(Directory::copy(root + "/big.txt", root + "/d"));
+	ASL_ASSERT(TextFile(root + "/d/big.txt").text() == big);
+
+	ASL_ASSERT(Directory::removeRecursive(root));
+	ASL_ASSERT(!Directory(root).exists());
 }
 
 ASL_TEST(IniFile)
@@ -147,6 +216,83 @@ ASL_TEST(TabularDataFile)
 		}
 		//double t2 = now();
 	}
+
+	for (int nth = 1; nth <= 4; nth += 3)
+	{
+		TabularDataFile file("data.csv");
+		Array<TabularDataColumn> cols = file.readColumns(nth);
+		ASL_ASSERT(cols.length() == 4);
+		ASL_ASSERT(cols[0].name == "i" && cols[3].name == "sign");
+		ASL_ASSERT(cols[0].type == 'n' && cols[1].type == 'n' && cols[3].type == 's');
+		ASL_ASSERT(cols[0].length() == N && cols[3].length() == N);
+		for (int i = 0; i < N; i++)
+		{
+			ASL_ASSERT(cols[0].numbers[i] == i);
+			ASL_ASSERT(cols[1].numbers[i] == 0.5);
+			ASL_ASSERT(cols[2].numbers[i] == -3.0 * i);
+			ASL_ASSERT(cols[3].strings[i] == "neg");
+		}
+	}
+
+	TextFile("data2.csv").put("name;value;code\r\n\"a;b\";1,25;ff\n\"say \"\"hi\"\"\";-2e3;0x10\n\nc;;\n");
+	{
+		TabularDataFile file("data2.csv");
+		file.readAs("snh");
+		Array<TabularDataColumn> cols = file.readColumns();
+		ASL_ASSERT(cols.length() == 3 && cols[1].name == "value");
+		ASL_ASSERT(cols[0].length() == 3 && cols[1].length() == 3 && cols[2].length() == 3);
+		ASL_CHECK(cols[0].strings[0], ==, "a;b");
+		ASL_CHECK(cols[0].strings[1], ==, "say \"hi\"");
+		ASL_CHECK(cols[1].numbers[0], ==, 1.25);
+		ASL_CHECK(cols[1].numbers[1], ==, -2000.0);
+		ASL_CHECK(cols[1].numbers[2], ==, 0.0);
+		ASL_CHECK(cols[2].ints[0], ==, 255);
+		ASL_CHECK(cols[2].ints[1], ==, 16);
+	}
+	{
+		TabularDataFile file("data2.csv");
+		file.readAs("snh");
+		Array<Var> last;
+		while (file.nextRow())
+			if (file.row().length() == 3)
+				last = file.row().clone();
+		ASL_ASSERT(last[0] == "c" && last[1].is(Var::NUMBER) && last[1] == 0.0);
+	}
+
+	for (int background = 0; background < 2; background++)
+	{
+		{
+			TabularDataFile file("data3.csv");
+			file.columns("i,x,y,name");
+			file.useBuffer(1000, background == 1);
+			for (int i = 0; i < N; i++)
+			{
+				if (i % 2 == 0)
+					file.appendRow(i, 0.1 * i, -1e-20 / (i + 1), "a");
+				else
+					file << i << 0.1 * i << -1e-20 / (i + 1) << "b";
+			}
+			double x[4] = { 1.5, 2, 3, 4 };
+			file.append(x, 4);
+			file.flush();
+			ASL_ASSERT(TabularDataFile("data3.csv").readColumns()[0].length() == N + 1);
+		}
+		TabularDataFile file("data3.csv");
+		Array<TabularDataColumn> cols = file.readColumns();
+		ASL_ASSERT(cols.length() == 4 && cols[3].name == "name");
+		ASL_ASSERT(cols[0].length() == N + 1);
+		for (int i = 0; i < N; i++)
+		{
+			ASL_ASSERT(cols[0].numbers[i] == i);
+			ASL_ASSERT(cols[3].strings[i] == (i % 2 == 0 ? "a" : "b"));
+			if (i % 2 == 0)
+			{
+				ASL_CHECK(cols[1].numbers[i], ==, 0.1 * i);
+				ASL_CHECK(cols[2].numbers[i], ==, -1e-20 / (i + 1));
+			}
+		}
+		ASL_CHECK(cols[0].numbers[N], ==, 1.5);
+	}
 }
 
 ASL_TEST(CmdArgs)
@@ -386,6 +532,244 @@ ASL_TEST(String)
 	ASL_ASSERT((x2 | 123) == "a");
 }
 
+ASL_TEST(StringView)
+{
+	String line = "  Name, 12 ,-3.5e2,, last  ";
+	StringView v = line.trimmedView();
+	ASL_ASSERT(v == "Name, 12 ,-3.5e2,, last" && v.data() == *line + 2);
+	ASL_ASSERT(v.indexOf(',') == 4 && v.indexOf(',', 5) == 9 && v.indexOf(", ") == 4 && v.indexOf(",,") == 16);
+	ASL_ASSERT(v.indexOf('x') < 0 && v.indexOf("lastx") < 0 && v.lastIndexOf(',') == 17 && v.indexOf('N', 30) < 0);
+	ASL_ASSERT(v.startsWith("Name") && v.startsWith('N') && v.endsWith("last") && !v.endsWith("Name"));
+	ASL_ASSERT(v.contains("-3.5") && !v.contains(';') && v.substring(6, 8) == "12" && v.substring(19) == "last");
+	ASL_ASSERT(StringView("NaMe").equalsNocase("name") && !StringView("name").equalsNocase("names"));
+	ASL_ASSERT(StringView("abc") < StringView("abd") && StringView("ab") < StringView("abc") && !(v < v));
+
+	Array<StringView> parts;
+	line.splitViews(",", parts);
+	ASL_ASSERT(parts.length() == 5 && parts[0] == "  Name" && parts[3] == "" && !parts[3].ok());
+	ASL_ASSERT(parts[1].trimmed() == "12" && parts[1].toInt() == 12 && parts[2].toDouble() == -350);
+	ASL_ASSERT(StringView("-42x").toInt() == -42 && StringView("7").toDouble() == 7);
+	const char* base = *line;
+	for (int i = 0; i < parts.length(); i++)
+		ASL_ASSERT(parts[i].data() >= base && parts[i].data() <= base + line.length());
+	ASL_ASSERT(String("a::b::").splitViews("::").length() == 3 && String("a::b::").splitViews("::")[1] == "b");
+	ASL_ASSERT(String(" \rmy  taylor\n\tis rich\r\n").splitViews().length() == 4);
+	ASL_ASSERT(String("my  taylor").splitViews()[1] == "taylor" && String("x").splitViews("").length() == 1);
+
+	String name = parts[0].trimmed();
+	ASL_ASSERT(name == "Name" && name == StringView("Name") && name != StringView("Nam"));
+	name << StringView("abc", 2) << '!';
+	ASL_ASSERT(name == "Nameab!");
+	name = name.view(4, 6);
+	ASL_ASSERT(name == "ab");
+	name += name.view(1);
+	ASL_ASSERT(name == "abb");
+	name = line.view(2, 6);
+	ASL_ASSERT(name == "Name" && line.view(24) == "t  " && line.view() == line);
+}
+
+static int naiveIndexOf(const String& s, const String& a, int i0)
+{
+	for (int i = i0; i <= s.length() - a.length(); i++)
+		if (memcmp(*s + i, *a, a.length()) == 0)
+			return i;
+	return -1;
+}
+
+static String repeated(const char* s, int n)
+{
+	String r;
+	for (int i = 0; i < n; i++)
+		r << s;
+	return r;
+}
+
+static int naiveLastIndexOf(const String& s, const String& a)
+{
+	for (int i = s.length() - a.length(); i >= 0; i--)
+		if (memcmp(*s + i, *a, a.length()) == 0)
+			return i;
+	return -1;
+}
+
+ASL_TEST(StringSearch)
+{
+	// long strings with matches around the 16/32 byte block boundaries
+
+	for (int n = 1; n < 100; n += 7)
+	{
+		String s(n, n);
+		for (int i = 0; i < n; i++)
+			s[i] = 'a' + (i * 7 + i / 5) % 3;
+		const char* patterns[] = { "a", "c", "ab", "ca", "abc", "cab", "aabca", "bcabcabca", "cccccccccccccccccccccc", "x" };
+		for (int k = 0; k < (int)(sizeof(patterns) / sizeof(patterns[0])); k++)
+		{
+			String a = patterns[k];
+			for (int i0 = 0; i0 <= n; i0 += 3)
+				ASL_CHECK(s.indexOf(a, i0), ==, naiveIndexOf(s, a, i0));
+			ASL_CHECK(s.lastIndexOf(a), ==, naiveLastIndexOf(s, a));
+			ASL_CHECK(s.view().lastIndexOf(a.view()), ==, naiveLastIndexOf(s, a));
+			if (a.length() == 1)
+				ASL_CHECK(s.lastIndexOf(a[0]), ==, naiveLastIndexOf(s, a));
+		}
+	}
+
+	String text = repeated("0123456789", 10) + "needle" + String::repeat('-', 40) + "needle" + "!";
+	ASL_ASSERT(text.indexOf("needle") == 100 && text.indexOf("needle", 101) == 146 && text.indexOf("needle", 147) == -1);
+	ASL_ASSERT(text.lastIndexOf("needle") == 146 && text.lastIndexOf('!') == 152 && text.lastIndexOf('0') == 90);
+	ASL_ASSERT(text.indexOf('!') == 152 && text.indexOf('\0') == 153 && text.indexOf('x', 200) == -1);
+	ASL_ASSERT(text.indexOf("") == 0 && text.indexOf("needle!") == 146 && text.indexOf("needle!!") == -1);
+	ASL_ASSERT(text.contains("9needle-") && !text.contains("needlE"));
+
+	// long texts, also with embedded '\0' in the text or the pattern
+
+	String big = repeated("0123456789", 40) + "needle" + String::repeat('-', 300) + "needle";
+	ASL_ASSERT(big.indexOf("needle") == 400 && big.indexOf(String("needle"), 401) == 706 && big.indexOf("needle", 707) == -1);
+	big[5] = '\0';
+	ASL_ASSERT(big.indexOf("needle") == 400 && big.indexOf(String("needle"), 401) == 706);
+	String zpattern = "-";
+	zpattern << '\0' << "x";
+	String ztext = big + zpattern;
+	ASL_ASSERT(ztext.indexOf(zpattern) == 712 && big.indexOf(zpattern) == -1);
+
+	// replace with longer, shorter and empty replacements
+
+	String r = repeated("ab,", 30);
+	ASL_ASSERT(r.replace(",", ", ") == repeated("ab, ", 30));
+	ASL_ASSERT(r.replace("ab,", "x") == repeated("x", 30));
+	ASL_ASSERT(r.replace(",", "") == repeated("ab", 30));
+	ASL_ASSERT(r.replace("b,a", "-") == "a" + repeated("-", 29) + "b,");
+	ASL_ASSERT(r.replace("z", "y") == r && r.replace("", "y") == r);
+	ASL_ASSERT(String("aaaa").replace("aa", "a") == "aa");
+
+	// case conversion of long ASCII runs mixed with UTF-8 characters
+
+	String lower = repeated("the quick brown fox jumps over the lazy dog @[`{ 0123456789 ", 3);
+	String upper = repeated("THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG @[`{ 0123456789 ", 3);
+	ASL_ASSERT(lower.toUpperCase() == upper && upper.toLowerCase() == lower);
+#ifndef ASL_ANSI
+	String mixed = lower + "ñandú " + lower + "жизни" + lower;
+	ASL_ASSERT(mixed.toUpperCase() == upper + "ÑANDÚ " + upper + "ЖИЗНИ" + upper);
+	ASL_ASSERT(mixed.toUpperCase().toLowerCase() == mixed);
+#endif
+}
+
+static String formatted(double x, int digits = 17)
+{
+	char s[32];
+	myftoa(x, s, digits);
+	return s;
+}
+
+static String formatted(float x)
+{
+	char s[32];
+	myftoa(x, s);
+	return s;
+}
+
+static bool sameBits(double a, double b)
+{
+	return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+ASL_TEST(NumberText)
+{
+	// shortest round-trip formatting, with the layout of %g
+
+	ASL_CHECK(formatted(0.1), ==, "0.1");
+	ASL_CHECK(formatted(0.3), ==, "0.3");
+	ASL_CHECK(formatted(1.0 / 3), ==, "0.3333333333333333");
+	ASL_CHECK(formatted(2.0 / 3), ==, "0.6666666666666666");
+	ASL_CHECK(formatted(100.0), ==, "100");
+	ASL_CHECK(formatted(-2.5), ==, "-2.5");
+	ASL_CHECK(formatted(1e16), ==, "10000000000000000");
+	ASL_CHECK(formatted(1e17), ==, "1e+17");
+	ASL_CHECK(formatted(1.5e-7), ==, "1.5e-07");
+	ASL_CHECK(formatted(0.0001), ==, "0.0001");
+	ASL_CHECK(formatted(123456789012345680.0), ==, "1.2345678901234568e+17");
+	ASL_CHECK(formatted(1.7976931348623157e308), ==, "1.7976931348623157e+308");
+	ASL_CHECK(formatted(4.9406564584124654e-324), ==, "5e-324");
+	ASL_CHECK(formatted(2.2250738585072014e-308), ==, "2.2250738585072014e-308");
+	ASL_CHECK(formatted(9007199254740993.0), ==, "9007199254740992");
+	ASL_CHECK(formatted(0.0), ==, "0");
+	ASL_CHECK(formatted(-0.0), ==, "-0");
+	ASL_CHECK(formatted(infinity()), ==, "inf");
+	ASL_CHECK(formatted(-(double)infinity()), ==, "-inf");
+	ASL_CHECK(formatted(1.0 / 3, 15), ==, "0.333333333333333");
+	ASL_CHECK(formatted(0.1 + 0.2, 15), ==, "0.3");
+	ASL_CHECK(formatted(0.1 + 0.2), ==, "0.30000000000000004");
+	ASL_CHECK(formatted(999999999999999.9, 15), ==, "1e+15");
+	ASL_CHECK(formatted(0.1f), ==, "0.1");
+	ASL_CHECK(formatted(1.0f / 3), ==, "0.33333334");
+	ASL_CHECK(formatted(16777216.0f), ==, "16777216");
+	ASL_CHECK(formatted(3.4028235e38f), ==, "3.4028235e+38");
+	ASL_CHECK(formatted(1e-45f), ==, "1e-45");
+
+	ASL_CHECK(String(0.1), ==, "0.1");
+	ASL_CHECK(String(1e100), ==, "1e+100");
+	ASL_CHECK(String(0.2f), ==, "0.2");
+	ASL_CHECK(Var(0.1).toString(), ==, "0.1");
+	ASL_CHECK(Json::encode(Var(0.1)), ==, "0.1");
+	ASL_CHECK(Json::encode(Var(1e21)), ==, "1e+21");
+
+	// correctly rounded parsing
+
+	ASL_ASSERT(sameBits(myatof("0.1"), 0.1));
+	ASL_ASSERT(sameBits(myatof("-0"), -0.0));
+	ASL_ASSERT(sameBits(myatof("9007199254740993"), 9007199254740992.0));
+	ASL_ASSERT(sameBits(myatof("9007199254740993.000000000000001"), 9007199254740994.0));
+	ASL_ASSERT(sameBits(myatof("2.2250738585072011e-308"), 2.2250738585072009e-308));
+	ASL_ASSERT(sameBits(myatof("2.4703282292062327e-324"), 0.0));
+	ASL_ASSERT(sameBits(myatof("2.4703282292062328e-324"), 4.9406564584124654e-324));
+	ASL_ASSERT(sameBits(myatof("1.7976931348623157e308"), 1.7976931348623157e308));
+	ASL_ASSERT(myatof("1.7976931348623159e308") == infinity());
+	ASL_ASSERT(myatof("1e-400") == 0 && myatof("1e400") == infinity());
+	ASL_ASSERT(sameBits(myatof("123456789012345678901234567890"), 1.2345678901234568e29));
+	ASL_ASSERT(sameBits(myatof("0.000000000000000000000000000001234567890123456789012345"), 1.2345678901234568e-30));
+	ASL_ASSERT(myatof("nan") != myatof("nan") && myatof("-Infinity") == -infinity());
+
+	const char* text = " -12,5e2; 7";
+	const char* next;
+	ASL_ASSERT(myatof(text, text + 11, &next, ',') == -1250 && next == text + 8);
+	ASL_ASSERT(myatof(text, text + 5, &next) == -12 && next == text + 4);
+	ASL_ASSERT(myatof(text + 8, text + 11, &next) == 0 && next == text + 8);
+	ASL_ASSERT(myatof("5.") == 5 && myatof(".5") == 0.5 && myatof("1e") == 1);
+
+	ASL_ASSERT(Json::decode("[0.1, 1e-7, 12345678901234567890, -3.25E+2]") ==
+		Json::decode("[1e-1, 0.0000001, 1.2345678901234567e19, -325]"));
+	ASL_ASSERT(String("2.5e-3").toDouble() == 0.0025 && StringView("3.75x").toDouble() == 3.75);
+
+	// formatting then parsing gives back the same bits, for random and for boundary values
+
+	Random rnd(false);
+	rnd.seed(11);
+	for (int i = 0; i < 20000; i++)
+	{
+		ULong bits = rnd.getLong();
+		if (i % 4 == 0)
+			bits &= 0x800fffffffffffffull; // subnormals
+		double x;
+		memcpy(&x, &bits, sizeof(x));
+		if (x != x || x == infinity() || x == -infinity())
+			continue;
+		char s[32];
+		myftoa(x, s);
+		if (!sameBits(myatof(s), x) || strtod(s, 0) != x)
+		{
+			ASL_CHECK(s, ==, String(0, "%.17g", x));
+			break;
+		}
+		float f = (float)x;
+		myftoa(f, s);
+		if ((float)myatof(s) != f)
+		{
+			ASL_CHECK(s, ==, String(0, "%.9g", f));
+			break;
+		}
+	}
+}
+
 ASL_TEST(JSON)
 {
 	String a = "A/*...*/{x=3.5, //...\ny=\"s\", z=[Y, N]}";
@@ -433,6 +817,86 @@ ASL_TEST(JSON)
 	ASL_CHECK(Xdl::decode(xdl2), == , v);
 	ASL_CHECK(Json::decode(json1), == , v);
 	ASL_CHECK(Json::decode(json2), == , v);
+
+	Var records = Json::decode("[{\"x\":1,\"y\":2},{\"y\":3,\"x\":4},{\"x\":5,\"z\":6},{\"w\":null},{}]");
+	ASL_CHECK(Json::encode(records), ==, "[{\"x\":1,\"y\":2},{\"x\":4,\"y\":3},{\"x\":5,\"z\":6},{\"w\":null},{}]");
+	ASL_ASSERT(!records[2].has("y") && records[3].length() == 1 && records[4].length() == 0);
+	Var classes = Xdl::decode("[A{x=1},B{y=2}]");
+	ASL_ASSERT(classes[1].is("B") && !classes[1].has("x") && classes[1].length() == 2);
+}
+
+String cborHex(const Var& v)
+{
+	return encodeHex(Cbor::encode(v)).toLowerCase();
+}
+
+ASL_TEST(Cbor)
+{
+	// examples from RFC 8949 appendix A
+
+	ASL_CHECK(cborHex(0), ==, "00");
+	ASL_CHECK(cborHex(23), ==, "17");
+	ASL_CHECK(cborHex(24), ==, "1818");
+	ASL_CHECK(cborHex(1000), ==, "1903e8");
+	ASL_CHECK(cborHex(1000000), ==, "1a000f4240");
+	ASL_CHECK(cborHex(-1), ==, "20");
+	ASL_CHECK(cborHex(-1000), ==, "3903e7");
+	ASL_CHECK(cborHex(1.1), ==, "fb3ff199999999999a");
+	ASL_CHECK(cborHex(100000.0f), ==, "fa47c35000");
+	ASL_CHECK(cborHex(false), ==, "f4");
+	ASL_CHECK(cborHex(Var::NUL), ==, "f6");
+	ASL_CHECK(cborHex(Var()), ==, "f7");
+	ASL_CHECK(cborHex("IETF"), ==, "6449455446");
+	ASL_CHECK(cborHex(Var(Var::ARRAY)), ==, "80");
+	ASL_CHECK(cborHex(Var("a", 1)), ==, "a1616101");
+	ASL_CHECK(cborHex(array<Var>(1, "a")), ==, "82016161");
+
+	ASL_CHECK(Cbor::decode(decodeHex("3bffffffffffffffff")), ==, -18446744073709551616.0);
+	ASL_CHECK(Cbor::decode(decodeHex("f93e00")), ==, 1.5f);
+	ASL_CHECK(Cbor::decode(decodeHex("f90001")), ==, 5.960464477539063e-8f);
+	ASL_CHECK(Cbor::decode(decodeHex("c11a514b67b0")), ==, 1363896240.0);
+	ASL_CHECK(Cbor::decode(decodeHex("7f657374726561646d696e67ff")), ==, "streaming");
+	ASL_CHECK(Cbor::decode(decodeHex("bf61610161629f0203ffff")), ==, Var("a", 1)("b", array<Var>(2, 3)));
+	ASL_CHECK(Cbor::decode(decodeHex("83010203")), ==, Var(array<Var>(1, 2, 3)));
+
+	// typed arrays: raw little-endian blocks
+
+	ASL_CHECK(cborHex(array<float>(1.0f, -2.0f)), ==, "d855480000803f000000c0");
+	ASL_CHECK(cborHex(array<int>(1, -2)), ==, "d84e4801000000feffffff");
+	ASL_CHECK(Cbor::decode(decodeHex("d84146" "0001" "0002" "7fff")), ==, Var(array<Var>(1, 2, 32767))); // uint16 BE
+	ASL_ASSERT(Cbor::decode(decodeHex("d84146" "0001" "0002" "7fff"))[2].is(Var::INT));
+	ASL_CHECK(Cbor::decode(decodeHex("d851443f800000"))[0], ==, 1.0f);
+
+	Array<float> fs;
+	Array<double> ds;
+	for (int i = 0; i < 1000; i++)
+	{
+		fs << i * 0.37f - 100;
+		ds << 1.0 / (i + 3);
+	}
+
+	Var v = Var("i", 17)("neg", -123456789)("big", 3e10)("f", 2.5f)("d", 0.1)("s", "text")("t", true)("n", Var::NUL)
+		("long", String('x', 300))("mixed", array<Var>(1, 2.5, "x", Var::NUL))("fs", fs)("ds", ds)("empty", Var(Var::DIC))
+		("nested", array<Var>(Var("a", array<Var>(1, 2)), Var(Var::ARRAY)));
+	Array<byte> data = Cbor::encode(v);
+	Var v2 = Cbor::decode(data);
+	ASL_CHECK(v2, ==, v);
+	ASL_ASSERT(v2["f"].is(Var::FLOAT) && v2["d"].is(Var::NUMBER) && v2["i"].is(Var::INT));
+	ASL_ASSERT(v2["fs"][5].is(Var::FLOAT) && (float)v2["fs"][999] == fs[999]);
+	ASL_ASSERT(v2["ds"][7].is(Var::NUMBER) && (double)v2["ds"][7] == ds[7]);
+	ASL_ASSERT(data.length() < 1000 * 12 + 500);
+
+	StreamBuffer buffer;
+	Cbor::encode(v, buffer);
+	Cbor::encode("end", buffer);
+	StreamBufferReader reader(*buffer);
+	ASL_CHECK(Cbor::decode(reader), ==, v);
+	ASL_CHECK(Cbor::decode(reader), ==, "end");
+	ASL_ASSERT(!reader);
+
+	ASL_ASSERT(!Cbor::decode(data.slice(0, data.length() - 1)).ok());
+	ASL_ASSERT(!Cbor::decode(decodeHex("9bffffffffffffffff")).ok());
+	ASL_ASSERT(!Cbor::decode(Array<byte>()).ok());
 }
 
 ASL_TEST(Var)
@@ -559,6 +1023,134 @@ ASL_TEST(Var)
 	}
 }
 
+ASL_TEST(VarPacked)
+{
+	Array<double> d;
+	d << 1.5 << -2 << 1e3;
+	Var a = Var::packed(d);
+	d[0] = 7;
+	ASL_ASSERT(a.type() == Var::ARRAY && a.is(Var::ARRAY) && a.packedType() == Var::NUMBER && a.length() == 3);
+	ASL_ASSERT(a.isArrayOf(Var::NUMBER) && a.isArrayOf(3, Var::NUMBER) && !a.isArrayOf(Var::INT));
+	ASL_ASSERT(a.contains(-2) && !a.contains(7) && !a.contains("x"));
+	ASL_CHECK(a.toString(), ==, "[1.5,-2,1000]");
+	ASL_ASSERT(a == Var(array<Var>(1.5, -2, 1e3)) && Var(array<Var>(1.5, -2.0, 1e3)) == a && a != Var(array<Var>(1.5, -2)));
+
+	Array<double> d2 = a; // shares storage
+	ASL_ASSERT(d2.length() == 3 && d2[2] == 1000);
+	d2[1] = 5;
+	const Var& ca = a;
+	ASL_ASSERT(ca[1] == 5 && a.item(1) == 5 && a.packedType() == Var::NUMBER); // reading does not unpack
+	Array<int> n = a;
+	ASL_ASSERT(n.length() == 3 && n[0] == 1 && n[1] == 5);
+
+	Var b = a.clone();
+	b << 2.5;
+	ASL_ASSERT(b.packedType() == Var::NUMBER && b.length() == 4 && a.length() == 3);
+	b << "x"; // other types turn it into a regular array
+	ASL_ASSERT(b.type() == Var::ARRAY && b.packedType() == Var::NONE && b.length() == 5 && b[3] == 2.5 && b[4] == "x");
+	ASL_ASSERT(b[0].is(Var::NUMBER));
+
+	Var c = Var::packed(array<float>(1.0f, 2.5f));
+	ASL_ASSERT(c.packedType() == Var::FLOAT);
+	Var c2 = c;
+	c << 4.5f; // appending keeps it packed and shared
+	ASL_ASSERT(c.packedType() == Var::FLOAT && c2.length() == 3 && c2[2] == 4.5f);
+	c[1] = "y"; // element writes unpack it, also for copies
+	ASL_ASSERT(c.packedType() == Var::NONE && c[0].type() == Var::FLOAT && c[1] == "y");
+	ASL_ASSERT(c2.packedType() == Var::NONE && c2[1] == "y");
+	c2 << 7;
+	ASL_ASSERT(c.length() == 4 && c[3] == 7);
+	int count = 0;
+	Var e = Var::packed(array<int>(3, 4));
+	foreach(Var& x, e)
+		count += (int)x;
+	ASL_CHECK(count, ==, 7);
+	ASL_ASSERT(e.packedType() == Var::INT);
+	Var e2 = e;
+	e[0] = 9.0;
+	ASL_ASSERT(e2[0] == 9.0 && e2[1] == 4);
+	ASL_ASSERT(e.pack() && e2.packedType() == Var::NUMBER && e2.item(0) == 9.0);
+
+	Var f = array<Var>(1, 2, 3);
+	ASL_ASSERT(f.pack() && f.packedType() == Var::INT && f == Var(array<Var>(1, 2, 3)));
+	f = array<Var>(1, 2.5f);
+	ASL_ASSERT(f.pack() && f.packedType() == Var::NUMBER);
+	f = array<Var>(1, "2");
+	ASL_ASSERT(!f.pack() && f.packedType() == Var::NONE);
+
+	Var g = Json::decode("{\"i\":[1,2,3],\"d\":[1,2.5,-3,1e3],\"m\":[1,\"a\"],\"e\":[]}", Json::PACKED);
+	ASL_ASSERT(g["i"].packedType() == Var::INT && g["d"].packedType() == Var::NUMBER);
+	ASL_ASSERT(g["m"].packedType() == Var::NONE && g["e"].packedType() == Var::NONE && g["e"].length() == 0);
+	ASL_CHECK(Json::encode(g["d"]), ==, "[1,2.5,-3,1000]");
+	ASL_CHECK(Json::encode(g["i"]), ==, "[1,2,3]");
+	Array<double> gd = g["d"];
+	ASL_ASSERT(gd.length() == 4 && gd[1] == 2.5 && gd[3] == 1000);
+
+	Array<int> big(40);
+	for (int i = 0; i < big.length(); i++)
+		big[i] = i * 3;
+	Var h = Var("big", Var::packed(big));
+	ASL_CHECK(Json::encode(h, Json::PRETTY), ==, Json::encode(Var("big", Var(big).array()), Json::PRETTY));
+	ASL_CHECK(Xdl::encode(h), ==, Xdl::encode(Var("big", Var(big).array())));
+	ASL_ASSERT(Json::decode(Json::encode(h)) == h);
+	ASL_ASSERT(Cbor::decode(Cbor::encode(h)) == h);
+
+	// packing is optional, and regular arrays share their elements with their copies
+
+	ASL_ASSERT(Var(big).packedType() == Var::NONE && Xdl::decode("[1, 2, 3]").packedType() == Var::NONE);
+	ASL_ASSERT(Xdl::decode("[1, 2, 3]", Json::PACKED).packedType() == Var::INT);
+	Var v1 = Json::decode("[1,2,3]");
+	Var v2 = v1;
+	v2[0] = 5;
+	ASL_ASSERT(v1[0] == 5);
+}
+
+ASL_TEST(Arena)
+{
+	Arena* arena = new Arena(1024);
+	char* p = (char*)arena->alloc(5);
+	char* q = (char*)arena->alloc(3000); // bigger than a chunk
+	ASL_ASSERT(((size_t)p & 15) == 0 && ((size_t)q & 15) == 0 && q != p);
+	memset(q, 1, 3000);
+	ASL_ASSERT(arena->size() >= 4024);
+
+	Array<String> names(*arena);
+	Array<int> numbers(*arena, 2);
+	numbers[0] = 5;
+	numbers[1] = 6;
+	for (int i = 0; i < 1000; i++)
+	{
+		names << String(0, "name %i", i);
+		numbers << i;
+	}
+	numbers.remove(0);
+	ASL_ASSERT(names.length() == 1000 && names[999] == "name 999" && numbers.length() == 1001 && numbers[0] == 6);
+
+	String json = "{\"name\":\"a long enough string value\",\"list\":[1,2.5,\"x\",{\"b\":[3,4]}],\"n\":null}";
+	Var v = Json::decode(json, *arena);
+	ASL_ASSERT(v == Json::decode(json));
+	ASL_ASSERT(v["list"][3]["b"].packedType() == Var::NONE);
+	ASL_ASSERT(Json::decode(json, *arena, Json::PACKED)["list"][3]["b"].packedType() == Var::INT);
+	ASL_ASSERT(Xdl::decode("{a=[1,2,3], b=\"some text that is not short\"}", *arena)["a"] == Var(array<Var>(1, 2, 3)));
+	Var list = v["list"];
+	Var copy = v.clone();
+	delete arena; // everything still works, the memory is kept while used
+	copy["list"][0] = 10;
+	ASL_ASSERT(v["list"][0] == 1 && list[3]["b"][1] == 4 && copy["list"][0] == 10);
+	ASL_CHECK(v["name"], ==, "a long enough string value");
+	ASL_ASSERT(names[500] == "name 500" && numbers[1000] == 999);
+
+	// growing moves an array out of the arena, copying it if shared
+
+	arena = new Arena;
+	Array<int> small(*arena, 2);
+	Array<int> shared = small;
+	delete arena;
+	small << 7 << 8;
+	ASL_ASSERT(small.length() == 4 && small[3] == 8 && shared.length() == 3 && shared[2] == 7);
+	list << 5;
+	ASL_ASSERT(list.length() == 5 && list[4] == 5);
+}
 
 ASL_TEST(Base64)
 {
@@ -577,6 +1169,57 @@ ASL_TEST(Base64)
 	ASL_ASSERT(data == data2);
 	String b64w = " MjAwMS\n1BIFN\n\twYWNlIE 9keXNzZXk = \n"; // with whitespace
 	ASL_ASSERT(String(decodeBase64(b64w)) == input);
+
+	Array<byte> bin(300);
+	for (int i = 0; i < bin.length(); i++)
+		bin[i] = byte(i * 37 + (i >> 3));
+	for (int n = 1; n <= bin.length(); n += 7) // long enough for the SIMD paths
+	{
+		Array<byte> part = bin.slice(0, n);
+		String e = encodeBase64(part);
+		ASL_ASSERT(e.length() == (n + 2) / 3 * 4);
+		ASL_ASSERT(decodeBase64(e) == part);
+		ASL_ASSERT(encodeBase64Url(part) == e.replace("+", "-").replace("/", "_").replace("=", ""));
+		ASL_ASSERT(decodeBase64(encodeBase64Url(part)) == part);
+		ASL_ASSERT(decodeHex(encodeHex(part)) == part);
+		ASL_ASSERT(decodeHex(encodeHex(part).toUpperCase()) == part);
+	}
+
+	data = array<byte>(0xfb, 0xff, 0xbf);
+	ASL_ASSERT(encodeBase64(data) == "+/+/");
+	ASL_ASSERT(encodeBase64Url(data) == "-_-_");
+	ASL_ASSERT(decodeBase64("-_-_") == data);
+	ASL_ASSERT(encodeBase64Url(array<byte>(0x05, 0xf0, 0x7a, 0x45)) == "BfB6RQ");
+	ASL_ASSERT(decodeBase64("BfB6RQ") == array<byte>(0x05, 0xf0, 0x7a, 0x45));
+
+	ASL_ASSERT(decodeBase64("BfB6R").length() == 0); // invalid input
+	ASL_ASSERT(decodeBase64("BfB*RQ==").length() == 0);
+	ASL_ASSERT(decodeBase64("Bf=6RQ==").length() == 0);
+	ASL_ASSERT(decodeBase64("BfB6RQ==BfB6").length() == 0);
+	ASL_ASSERT(decodeBase64(String('A', 40) + "!" + String('A', 39)).length() == 0);
+	ASL_ASSERT(decodeHex("05f07").length() == 0);
+	ASL_ASSERT(decodeHex("05f07g").length() == 0);
+	ASL_ASSERT(decodeHex(encodeHex(bin) + "x0").length() == 0);
+	ASL_ASSERT(decodeHex("05F07A45") == array<byte>(0x05, 0xf0, 0x7a, 0x45));
+
+	String e = encodeBase64(bin);
+	StringBuilder out;
+	Base64Encoder encoder;
+	for (int i = 0, k = 1; i < bin.length(); i += k, k += 5)
+		encoder.encode(bin.ptr() + i, min(k, bin.length() - i), out);
+	encoder.finish(out);
+	ASL_ASSERT(out.string() == e);
+
+	Base64Decoder decoder;
+	Array<byte> bin2;
+	for (int i = 0, k = 1; i < e.length(); i += k, k += 3)
+		decoder.decode(*e + i, min(k, e.length() - i), bin2);
+	ASL_ASSERT(decoder.finish(bin2));
+	ASL_ASSERT(bin2 == bin);
+
+	bin2.clear();
+	ASL_ASSERT(!decoder.decode("BfB6R*", 6, bin2) && decoder.error());
+	ASL_ASSERT(!decoder.finish(bin2));
 }
 
 #ifndef __ANDROID__
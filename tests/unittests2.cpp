@@ -98,6 +98,10 @@ ASL_TEST(XML)
 	ASL_ASSERT(!isancestor(html, p2));
 
 
+	Xml::write(dom, "data.xml");
+	Xml dom2 = Xml::read("data.xml");
+	ASL_ASSERT(Xml::encode(dom2, false) == Xml::encode(dom, false));
+
 	String xml3 = "<e a='q=\"s\"'><b/></e>";
 	Xml e3 = Xml::decode(xml3);
 	ASL_ASSERT(e3["a"] == "q=\"s\"");
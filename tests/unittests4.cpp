@@ -4,7 +4,15 @@
 #include <asl/Uuid.h>
 #include <asl/Array2.h>
 #include <asl/Matrix.h>
+#include <asl/MatrixN.h>
+#include <asl/LevenbergMarquardt.h>
+#include <asl/SparseMatrix.h>
+#include <asl/PointCloud.h>
 #include <asl/StreamBuffer.h>
+#include <asl/StringBuilder.h>
+#include <asl/TextFile.h>
+#include <asl/Xdl.h>
+#include <asl/Xml.h>
 #include <stdio.h>
 #include <asl/testing.h>
 
@@ -112,6 +120,80 @@ ASL_TEST(StreamBuffer)
 	ASL_ASSERT(a == 'a' && x == 4 && y == 3.5);
 }
 
+ASL_TEST(StringBuilder)
+{
+	StringBuilder b(64);
+	String s;
+	ASL_ASSERT(b.isEmpty() && b.numBlocks() == 0 && b.string() == "");
+	b << "" << String();
+	ASL_ASSERT(b.isEmpty() && b.numBlocks() == 0);
+
+	for (int i = 0; i < 300; i++)
+	{
+		b << "item" << i << ' ';
+		s << "item" << i << ' ';
+	}
+	b << 2.5 << String("|") << StringView("xyz", 2) << (Long)-12345678901LL;
+	s << "2.5|xy-12345678901";
+	String big(200, 0);
+	for (int i = 0; i < 200; i++)
+		big << char('a' + i % 26);
+	b << big;
+	s << big;
+
+	ASL_ASSERT(b.numBlocks() > 1);
+	ASL_CHECK(b.length(), ==, s.length());
+	ASL_CHECK(b.string(), ==, s);
+
+	String joined;
+	for (int i = 0; i < b.numBlocks(); i++)
+		joined << b.block(i);
+	ASL_CHECK(joined, ==, s);
+
+	File file = File::temp(".txt");
+	String path = file.path();
+	file.write("<", 1);
+	ASL_CHECK(b.writeTo(file), ==, (Long)s.length());
+	file.write(">", 1);
+	file.close();
+	ASL_CHECK(String(File(path).content()), ==, "<" + s + ">");
+
+	b.clear();
+	ASL_ASSERT(b.isEmpty() && b.string() == "");
+	b << "a";
+	ASL_CHECK(b.string(), ==, "a");
+
+	Var data = Var("a", 1)("b", array<Var>(1.5, "x\n\"y\"", true))("c", Var("d", -3.25f));
+	StringBuilder out(64);
+	out << "json=";
+	Json::encode(data, out, Json::PRETTY);
+	ASL_CHECK(out.string(), ==, "json=" + Json::encode(data, Json::PRETTY));
+
+	ASL_ASSERT(Json::write(path, data));
+	ASL_CHECK(Json::read(path).toString(), ==, data.toString());
+	ASL_ASSERT(Xdl::write(path, data));
+	ASL_CHECK(Xdl::read(path).toString(), ==, data.toString());
+
+	Xml xml = Xml("root", Dic<>("k", "<&>")) << (Xml("item", "a&b'c") << Xml("empty"));
+	ASL_ASSERT(Xml::write(path, xml));
+	ASL_CHECK(TextFile(path).text(), ==, "<?xml version=\"1.0\"?>\n" + Xml::encode(xml) + "\n");
+
+	Var list = Var(Var::ARRAY);
+	for (int i = 0; i < 1000; i++)
+		list << Var("i", i)("s", String(0, "s%i", i));
+	{
+		File sinkFile(path, File::WRITE);
+		StringBuilder sink(sinkFile, 256);
+		Json::encode(list, sink);
+		ASL_ASSERT(sink.numBlocks() <= 1);
+		sink.flush();
+		ASL_ASSERT(!sink.error() && sink.numBlocks() == 0);
+		ASL_CHECK(sink.length(), ==, (Long)Json::encode(list).length());
+	}
+	ASL_CHECK(String(File(path).content()), ==, Json::encode(list));
+	File(path).remove();
+}
+
 ASL_TEST(Array2)
 {
 	Array2<int> a(2, 3);
@@ -140,6 +222,163 @@ ASL_TEST(Array2)
 	ASL_ASSERT(a4 == Array2<int>(2, 1, array(1, 11)));
 }
 
+template<class T>
+bool checkArrayOps(T lo, T hi)
+{
+	typedef typename ArrayOpTraits<T>::Sum S;
+	bool ok = true;
+	for (int n = 0; n < 300; n += 37)
+	{
+		Array<T> a(n), b(n), c(n);
+		for (int i = 0; i < n; i++)
+		{
+			a[i] = T(lo + (hi - lo) * ((i * 37 % 101) / 100.0));
+			b[i] = T(lo + (hi - lo) * ((i * 13 % 97) / 96.0));
+		}
+		S s = 0, d = 0;
+		T mn = n ? a[0] : T(0), mx = mn;
+		for (int i = 0; i < n; i++)
+		{
+			s += a[i];
+			d += (S)a[i] * b[i];
+			mn = min(mn, a[i]);
+			mx = max(mx, a[i]);
+		}
+		double tol = sizeof(T) == sizeof(float) ? 1e-4 : 1e-12;
+		ok = ok && fabs(double(ops::sum(a) - s)) <= tol * (1 + fabs(double(s)));
+		ok = ok && fabs(double(ops::dot(a, b) - d)) <= tol * (1 + fabs(double(d)));
+		T l = 0, h = 0;
+		ops::minmax(a, l, h);
+		ok = ok && l == mn && h == mx;
+		Array<T> sa = ops::add(a, b), ss = ops::subtract(a, b), sm = ops::multiply(a, b), sc = ops::scale(a, T(3));
+		Array<T> cl = ops::clamp(a, T(lo / 2 + hi / 4), T(hi / 2));
+		for (int i = 0; i < n; i++)
+		{
+			ok = ok && sa[i] == T(a[i] + b[i]) && ss[i] == T(a[i] - b[i]) && sm[i] == T(a[i] * b[i]);
+			ok = ok && sc[i] == T(a[i] * T(3)) && cl[i] == clamp(a[i], T(lo / 2 + hi / 4), T(hi / 2));
+		}
+	}
+	return ok;
+}
+
+ASL_TEST(ArrayOps)
+{
+	ASL_ASSERT(checkArrayOps<float>(-10.0f, 10.0f));
+	ASL_ASSERT(checkArrayOps<double>(-1e3, 1e3));
+	ASL_ASSERT(checkArrayOps<int>(-30000, 30000));
+	ASL_ASSERT(checkArrayOps<byte>(0, 255));
+
+	Array<int> big(100000, 60000);
+	ASL_ASSERT(ops::sum(big) == Long(6000000000LL) && ops::dot(big, big) == Long(360000000000000LL));
+	Array<byte> bytes(300000, 255);
+	ASL_ASSERT(ops::dot(bytes, bytes) == Long(300000) * 65025);
+
+	Array<float> f(20);
+	for (int i = 0; i < f.length(); i++)
+		f[i] = i * 20.0f - 50.5f;
+	f[3] = 1e20f;
+	Array<byte> fb(f.length());
+	ops::convert(f.ptr(), fb.ptr(), f.length());
+	Array<int> fi = f.with<int>();
+	Array<double> fd = f.with<double>();
+	for (int i = 0; i < f.length(); i++)
+	{
+		ASL_ASSERT(fb[i] == (f[i] <= 0 ? 0 : f[i] >= 255 ? 255 : (byte)f[i]));
+		ASL_ASSERT(fd[i] == f[i] && fd.with<float>()[i] == f[i]);
+		if (i != 3)
+			ASL_ASSERT(fi[i] == (int)f[i] && fi.with<float>()[i] == (float)fi[i] && fi.with<double>()[i] == fi[i]);
+	}
+	ASL_ASSERT(fd.with<byte>()[5] == 49 && f.with<byte>()[12] == 189);
+	Array<byte> ib(fi.length());
+	ops::convert(fi.ptr(), ib.ptr(), fi.length());
+	ASL_ASSERT(ib[19] == 255 && ib[0] == 0 && ib[5] == 49);
+
+	Array<int> wide(21, 300);
+	wide[20] = -1;
+	Array<byte> wb = wide.with<byte>();
+	ASL_ASSERT(wb[0] == 44 && wb[19] == 44 && wb[20] == 255);
+	ASL_ASSERT(Array2<int>(2, 2, 300).with<byte>()(1, 1) == 44 && Matrix_<int>(2, 2, 258).with<byte>()(0, 1) == 2);
+	ASL_ASSERT(fb.with<float>()[5] == 49 && fb.with<int>()[19] == 255 && fb.with<double>()[18] == 255);
+
+	Array2<float> m(3, 5);
+	for (int i = 0; i < m.data().length(); i++)
+		m.data()[i] = float(i);
+	Array2<float> mt = ops::transpose(m);
+	ASL_ASSERT(mt.rows() == 5 && mt.cols() == 3 && mt(4, 2) == m(2, 4) && mt(1, 0) == 1);
+	ASL_ASSERT(ops::sum(m) == 105 && ops::add(m, m)(2, 4) == 28 && ops::add(m, mt).rows() == 0);
+	Matrixd md(2, 2, 3.0);
+	ASL_APPROX(ops::norm(md), 6.0, EPS);
+	Array2<byte> img(40, 41);
+	img.set(7);
+	ASL_ASSERT(ops::sum(img.with<int>()) == 7 * 40 * 41);
+}
+
+template<class T>
+bool checkTranspose(int rows, int cols)
+{
+	Array2<T> a(rows, cols);
+	for (int i = 0; i < rows; i++)
+		for (int j = 0; j < cols; j++)
+			a(i, j) = T((i * 7 + j * 3) % 251);
+	Array2<T> t = a.transposed();
+	bool ok = t.rows() == cols && t.cols() == rows;
+	for (int i = 0; i < rows && ok; i++)
+		for (int j = 0; j < cols; j++)
+			ok = ok && t(j, i) == a(i, j);
+	Array2View<T> v = a.view(3, rows - 2, 1, cols - 4);
+	Array2<T> vt(v.cols(), v.rows());
+	ops::transpose(v.ptr(), v.rows(), v.cols(), v.stride(), vt.data().ptr(), vt.cols());
+	for (int i = 0; i < v.rows() && ok; i++)
+		for (int j = 0; j < v.cols(); j++)
+			ok = ok && vt(j, i) == v(i, j);
+	return ok;
+}
+
+ASL_TEST(Array2View)
+{
+	Array2<int> a(5, 6);
+	for (int i = 0; i < 5; i++)
+		for (int j = 0; j < 6; j++)
+			a(i, j) = i * 10 + j;
+
+	Array2View<int> v = a.view(1, 4, 2, 5);
+	ASL_ASSERT(v.rows() == 3 && v.cols() == 3 && v.stride() == 6 && !v.isContiguous());
+	ASL_ASSERT(v(0, 0) == 12 && v(2, 2) == 34 && v[1][1] == 23);
+	ASL_ASSERT(v.view(1, 3, 1, 2)(1, 0) == 33);
+	ASL_ASSERT(a.rowView(2).isContiguous() && a.rowView(2)(0, 5) == 25);
+	ASL_ASSERT(a.colView(3).rows() == 5 && a.colView(3)(4, 0) == 43);
+
+	Array2<int> c = v.clone();
+	ASL_ASSERT(c.rows() == 3 && c.cols() == 3 && c(2, 0) == 32);
+	v.set(-1);
+	ASL_ASSERT(a(1, 2) == -1 && a(3, 4) == -1 && a(1, 1) == 11 && a(3, 5) == 35 && c(0, 0) == 12);
+	a.view(0, 3, 0, 3).copy(c);
+	ASL_ASSERT(a(0, 0) == 12 && a(2, 2) == 34 && a(1, 2) == 24);
+	a.colView(5).set(7);
+	ASL_ASSERT(a(0, 5) == 7 && a(4, 5) == 7 && a(4, 4) == 44);
+
+	ASL_ASSERT(checkTranspose<float>(67, 133));
+	ASL_ASSERT(checkTranspose<double>(133, 67));
+	ASL_ASSERT(checkTranspose<int>(70, 70));
+	ASL_ASSERT(checkTranspose<byte>(45, 150));
+	ASL_ASSERT(checkTranspose<float>(8, 9));
+
+	Matrixd m(6, 6);
+	for (int i = 0; i < m.length(); i++)
+		m[i] = i % 7 - 2.5;
+	Matrixd b = Matrixd(m.view(1, 4, 2, 6)), s = Matrixd(m.view(2, 6, 0, 2));
+	ASL_ASSERT(b.rows() == 3 && b.cols() == 4 && b(0, 0) == m(1, 2) && s(3, 1) == m(5, 1));
+	ASL_ASSERT((b * m.view(2, 6, 0, 2) - b * s).norm() < 1e-12);
+	ASL_ASSERT((Matrixd::product(m.view(1, 4, 2, 6), m.view(2, 6, 0, 2)) - b * s).norm() < 1e-12);
+	ASL_ASSERT((b + m.view(0, 3, 0, 4))(2, 3) == b(2, 3) + m(2, 3));
+	ASL_ASSERT((b - m.view(0, 3, 0, 4))(1, 1) == b(1, 1) - m(1, 1) && (b + m.view(0, 2, 0, 2)).rows() == 0);
+	Matrixd b2 = b.clone();
+	b2 += m.view(3, 6, 2, 6);
+	b2 -= m.view(3, 6, 2, 6);
+	ASL_ASSERT(b2 == b && (b * m.view(0, 3, 0, 2)).rows() == 0);
+	ASL_ASSERT(m.transposed()(4, 1) == m(1, 4));
+}
+
 ASL_TEST(Matrix)
 {
 	Matrix A(2, 2, array<float>(
@@ -159,4 +398,397 @@ ASL_TEST(Matrix)
 
 	ASL_ASSERT(C == A);
 #endif
+
+	Random rnd(false);
+	rnd.seed(7);
+	int sizes[][3] = { { 3, 5, 2 }, { 50, 40, 60 }, { 131, 77, 263 }, { 200, 300, 150 } };
+	for (int s = 0; s < 4; s++)
+	{
+		int m = sizes[s][0], k = sizes[s][1], n = sizes[s][2];
+		Matrixd X(m, k), Y(k, n), Z(m, n);
+		for (int i = 0; i < X.length(); i++)
+			X[i] = rnd(-1.0, 1.0);
+		for (int i = 0; i < Y.length(); i++)
+			Y[i] = rnd(-1.0, 1.0);
+		for (int i = 0; i < m; i++)
+			for (int j = 0; j < n; j++)
+			{
+				double z = 0;
+				for (int p = 0; p < k; p++)
+					z += X(i, p) * Y(p, j);
+				Z(i, j) = z;
+			}
+		ASL_CHECK((X * Y - Z).norm(), <, 1e-10);
+		ASL_CHECK((X.multiply(Y, 4) - Z).norm(), <, 1e-10);
+		Matrix Xf = X.with<float>(), Yf = Y.with<float>(), Zf = Z.with<float>();
+		ASL_CHECK((Xf * Yf - Zf).norm(), <, 1e-5f * m * n);
+		ASL_CHECK((Xf.multiply(Yf, 3) - Zf).norm(), <, 1e-5f * m * n);
+	}
+	ASL_ASSERT((Matrix(2, 3) * Matrix(2, 3)).rows() == 0);
+
+	Matrixd M(3, 3);
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			M(i, j) = i == j ? 2 : (i - j == 1 || j - i == 1) ? -1 : 0;
+	Matrixd rhs(3, 2, array<double>(1, 0, 0, 1, 1, 2));
+	LU<double> lu(M);
+	ASL_ASSERT(!lu.singular());
+	ASL_APPROX(lu.det(), 4.0, EPS);
+	ASL_CHECK((M * lu.solve(rhs) - rhs).norm(), <, EPS);
+	Cholesky<double> chol(M);
+	ASL_ASSERT(chol.ok());
+	ASL_APPROX(chol.det(), 4.0, EPS);
+	ASL_CHECK((M * chol.solve(rhs) - rhs).norm(), <, EPS);
+	ASL_CHECK((chol.L() * chol.L().transposed() - M).norm(), <, EPS);
+	ASL_ASSERT(!Cholesky<double>(-M).ok());
+	ASL_ASSERT(LU<double>(Matrixd(2, 2, array<double>(1, 2, 2, 4))).singular());
+
+	Matrixd P(120, 120);
+	for (int i = 0; i < P.length(); i++)
+		P[i] = rnd(-1.0, 1.0);
+	Matrixd Pi = P.inverse();
+	ASL_CHECK((P * Pi - Matrixd::identity(120)).norm(), <, 1e-9);
+	Matrixd P2(300, 300);
+	for (int i = 0; i < P2.length(); i++)
+		P2[i] = rnd(-1.0, 1.0);
+	ASL_CHECK((P2 * P2.inverse() - Matrixd::identity(300)).norm(), <, 1e-8);
+	ASL_APPROX(P.det() * Pi.det(), 1.0, 1e-9);
+
+	// least squares line fit y = 2x + 1
+	Matrixd F(5, 2), y(5, 1);
+	for (int i = 0; i < 5; i++)
+	{
+		F(i, 0) = i;
+		F(i, 1) = 1;
+		y[i] = 2 * i + 1 + (i % 2 ? 0.1 : -0.1);
+	}
+	QR<double> qr(F);
+	ASL_ASSERT(qr.fullRank());
+	Matrixd ab = qr.solve(y);
+	ASL_APPROX(ab[0], 2.0, 0.05);
+	ASL_APPROX(ab[1], 1.0, 0.1);
+	ASL_CHECK((solve(F, y) - ab).norm(), <, EPS);
+	ASL_CHECK((F.pseudoinverse() * y - ab).norm(), <, EPS);
+	ASL_CHECK((F.transposed().pseudoinverse() - F.pseudoinverse().transposed()).norm(), <, EPS);
+	F(1, 0) = 0;
+	F(2, 0) = 0;
+	F(3, 0) = 0;
+	F(4, 0) = 0;
+	ASL_ASSERT(QR<double>(F).rank() == 1);
+
+	Matrix Af = Matrix(2, 2, array<float>(4, 1, 1, 3));
+	ASL_APPROX(Cholesky<float>(Af).det(), 11.0f, EPSf);
+	ASL_CHECK((Af * Af.inverse() - Matrix::identity(2)).norm(), <, EPSf);
+
+	Matrixd Ae(3, 4), Be(3, 4), De(3, 4);
+	for (int i = 0; i < Ae.length(); i++)
+	{
+		Ae[i] = i * 0.5 - 2;
+		Be[i] = sin(i * 1.0);
+		De[i] = i * i * 0.25;
+	}
+	double s = 1.5;
+	Matrixd Ce = lazy(Ae) * s + Be - De;
+	ASL_ASSERT(Ce == Ae * s + Be - De);
+	Matrixd Ee = 2.0 * Ce - Be;
+	const double* pc = Ce.data().ptr();
+	Ce.assign(lazy(Ce) * 2 - Be);
+	ASL_ASSERT(Ce == Ee && Ce.data().ptr() == pc);
+	Ce.assign(-lazy(Ae) + (lazy(Be) - De) * 0.5);
+	ASL_ASSERT(Ce == -Ae + (Be - De) * 0.5);
+	Ee = Be.clone();
+	Ee.axpy(-3, Ae);
+	ASL_ASSERT(Ee == Be - Ae * 3.0);
+	Ee += lazy(De) * 2;
+	ASL_ASSERT(Ee == Be - Ae * 3.0 + De * 2.0);
+	Ce.assign(lazy(Ae) + Matrixd(2, 2, 0.0));
+	ASL_ASSERT(Ce.rows() == 0);
+	Matrix Cf = lazy(Af) * 2 + Af;
+	ASL_ASSERT(Cf == Af * 3.0f);
+}
+
+ASL_TEST(MatrixN)
+{
+	MatrixN_<double, 3> A;
+	double a[] = { 4, -2, 1, 3, 6, -4, 2, 1, 8 };
+	A = MatrixN_<double, 3>(a);
+	Matrixd Ad = A;
+	ASL_ASSERT(Ad.rows() == 3 && Ad.cols() == 3 && Ad(1, 2) == -4);
+	ASL_ASSERT((MatrixN_<double, 3>(Ad) == A));
+
+	ASL_APPROX(A.det(), Ad.det(), EPS);
+	ASL_CHECK((A * A.inverse() - MatrixN_<double, 3>::identity()).norm(), <, EPS);
+	ASL_CHECK((A.inverse().matrix() - Ad.inverse()).norm(), <, EPS);
+
+	MatrixN_<double, 3, 2> b;
+	for (int i = 0; i < b.length(); i++)
+		b[i] = i - 2.5;
+	MatrixN_<double, 3, 2> x = solve(A, b);
+	ASL_CHECK((A * x - b).norm(), <, EPS);
+	ASL_CHECK((x.matrix() - solve(Ad, b.matrix())).norm(), <, EPS);
+
+	MatrixN_<double, 2, 3> bt = b.transposed();
+	ASL_ASSERT(bt(1, 2) == b(2, 1) && bt.rows() == 2 && bt.cols() == 3);
+	MatrixN_<double, 2> S = bt * A * b + 2.0 * MatrixN_<double, 2>::identity();
+	ASL_CHECK((S.matrix() - (bt.matrix() * Ad * b.matrix() + Matrixd::identity(2) * 2.0)).norm(), <, EPS);
+	ASL_APPROX(S.trace(), S(0, 0) + S(1, 1), EPS);
+
+	MatrixN_<double, 2, 2> P = A.slice<2, 2>(1, 1);
+	ASL_ASSERT(P(0, 0) == 6 && P(1, 1) == 8);
+	ASL_ASSERT(A.col(1)(2, 0) == 1 && A.row(2)(0, 2) == 8);
+	MatrixN_<float, 3> Af = A;
+	ASL_APPROX(Af.det(), (float)A.det(), 1e-3f);
+
+	MatrixN_<double, 2> Z(0.0);
+	ASL_ASSERT(Z.det() == 0);
+	ASL_ASSERT((MatrixN_<double, 2>(Ad) == Z)); // wrong size
+}
+
+ASL_TEST(LevenbergMarquardt)
+{
+#ifdef ASL_HAVE_LAMBDA
+	// Rosenbrock function as residuals, minimum at (1, 1)
+	Matrixd x0(2, 1);
+	x0[0] = -1.2;
+	x0[1] = 1;
+	LevenbergMarquardt<double> lm;
+	Matrixd x = lm.solve([](const Matrixd& x) {
+		Matrixd r(2, 1);
+		r[0] = 10 * (x[1] - sqr(x[0]));
+		r[1] = 1 - x[0];
+		return r;
+	}, x0);
+	ASL_ASSERT(lm.converged());
+	ASL_APPROX(x[0], 1.0, 1e-5);
+	ASL_APPROX(x[1], 1.0, 1e-5);
+
+	// fit y = a * exp(b * t) with noise, numeric (serial and parallel) and analytic Jacobians
+	int n = 50;
+	Array<double> t(n), y(n);
+	for (int i = 0; i < n; i++)
+	{
+		t[i] = i * 0.1;
+		y[i] = 2.5 * exp(-0.7 * t[i]) + ((i % 3) - 1) * 0.001;
+	}
+	auto residuals = [&](const Matrixd& p) {
+		Matrixd r(n, 1);
+		for (int i = 0; i < n; i++)
+			r[i] = p[0] * exp(p[1] * t[i]) - y[i];
+		return r;
+	};
+	auto jacobian = [&](const Matrixd& p) {
+		Matrixd J(n, 2);
+		for (int i = 0; i < n; i++)
+		{
+			J(i, 0) = exp(p[1] * t[i]);
+			J(i, 1) = p[0] * t[i] * exp(p[1] * t[i]);
+		}
+		return J;
+	};
+	Matrixd p0(2, 1, 1.0);
+	Matrixd p1 = lm.solve(residuals, p0);
+	ASL_APPROX(p1[0], 2.5, 1e-2);
+	ASL_APPROX(p1[1], -0.7, 1e-2);
+	ASL_CHECK(lm.residual(), <, 0.01);
+	Matrixd p2 = lm.threads(3).solve(residuals, p0);
+	ASL_CHECK((p2 - p1).norm(), <, 1e-6);
+	Matrixd p3 = lm.solve(residuals, jacobian, p0);
+	ASL_CHECK((p3 - p1).norm(), <, 1e-6);
+
+	LevenbergMarquardt<double> lm2;
+	lm2.maxIterations(2);
+	lm2.solve(residuals, p0);
+	ASL_ASSERT(!lm2.converged() && lm2.iterations() == 2);
+#endif
+}
+
+ASL_TEST(SparseMatrix)
+{
+	SparseMatrix<double>::Builder builder(3, 4);
+	builder.add(2, 3, 1).add(0, 1, 2).add(1, 0, 3).add(0, 1, 0.5).add(2, 0, -1).add(0, 3, 4);
+	SparseMatrix<double> S = builder.build();
+	ASL_ASSERT(S.nonzeros() == 5);
+	ASL_APPROX(S(0, 1), 2.5, EPS);
+	ASL_APPROX(S(2, 0), -1.0, EPS);
+	ASL_ASSERT(S(1, 1) == 0);
+	Matrixd D = S.dense();
+	ASL_ASSERT(SparseMatrix<double>(D).dense() == D);
+	ASL_ASSERT(S.transposed().dense() == D.transposed());
+	Matrixd v(4, 2);
+	for (int i = 0; i < v.length(); i++)
+		v[i] = i - 3.5;
+	ASL_CHECK((S * v - D * v).norm(), <, EPS);
+	ASL_CHECK((S.multiply(v, 4) - D * v).norm(), <, EPS);
+	Matrixd w(3, 1, 2.0);
+	ASL_CHECK((S.transposeMultiply(w) - D.transposed() * w).norm(), <, EPS);
+
+	// 2D Poisson problem on a k x k grid (symmetric positive definite)
+	int k = 30, n = k * k;
+	SparseMatrix<double>::Builder lap(n, n);
+	for (int i = 0; i < k; i++)
+		for (int j = 0; j < k; j++)
+		{
+			int p = i * k + j;
+			lap.add(p, p, 4 + 0.01 * i);
+			if (i > 0) lap.add(p, p - k, -1);
+			if (i < k - 1) lap.add(p, p + k, -1);
+			if (j > 0) lap.add(p, p - 1, -1);
+			if (j < k - 1) lap.add(p, p + 1, -1.0);
+		}
+	SparseMatrix<double> A = lap.build();
+	ASL_ASSERT(A.nonzeros() == 5 * n - 4 * k);
+	Matrixd b(n, 1);
+	for (int i = 0; i < n; i++)
+		b[i] = sin(i * 0.1);
+
+	IterativeSolver<double> cg;
+	Matrixd x = cg.solve(A, b);
+	ASL_ASSERT(cg.converged());
+	ASL_CHECK((A * x - b).norm(), <, 1e-8 * b.norm());
+
+	Matrixd x2 = cg.jacobi(false).threads(2).solve(A, b);
+	ASL_ASSERT(cg.converged());
+	ASL_CHECK((x2 - x).norm(), <, 1e-7);
+
+	// non-symmetric: add a convection term
+	Matrixd Ad = A.dense();
+	for (int p = 0; p < n - 1; p++)
+		Ad(p, p + 1) += 0.5;
+	SparseMatrix<double> B(Ad);
+	IterativeSolver<double> bicg(IterativeSolver<double>::BICGSTAB);
+	Matrixd y = bicg.solve(B, b);
+	ASL_ASSERT(bicg.converged());
+	ASL_CHECK((B * y - b).norm(), <, 1e-8 * b.norm());
+	ASL_ASSERT(bicg.maxIterations(2).solve(B, b).rows() == n && !bicg.converged());
+
+	IterativeSolver<float> solverf(IterativeSolver<float>::BICGSTAB);
+	Matrix xf = solverf.solve(SparseMatrix<float>(Ad.with<float>()), b.with<float>());
+	ASL_ASSERT(solverf.converged());
+	ASL_CHECK((xf.with<double>() - y).norm(), <, 1e-3);
+}
+
+ASL_TEST(PointCloud)
+{
+	Matrix4 m = Matrix4::translate(1, -2, 3) * Matrix4::rotate(Vec3(1, 0.5f, -1.25f), 0.75f) * Matrix4::scale(1.5f);
+	Matrix4 proj = m;
+	proj(3, 2) = 0.25f;
+	ASL_ASSERT(m.isAffine() && !proj.isAffine());
+	int n = 1003;
+	Array<Vec3> points(n), out(n);
+	for (int i = 0; i < n; i++)
+		points[i] = Vec3(i * 0.01f, sin(i * 0.1f), 2 + cos(i * 0.07f));
+
+	m.transform(points.ptr(), out.ptr(), n);
+	for (int i = 0; i < n; i++)
+		ASL_APPROX(out[i], m * points[i], EPSf * 10);
+
+	proj.transform(points.ptr(), out.ptr(), n);
+	for (int i = 0; i < n; i++)
+		ASL_APPROX(out[i], (proj * Vec4(points[i], 1)).h2c(), EPSf * 10);
+
+	Array<Vec3> inplace = points.clone();
+	m.transform(inplace.ptr(), inplace.ptr(), n, 4);
+	m.transform(points.ptr(), out.ptr(), n);
+	ASL_ASSERT(inplace == out);
+
+	Array<Vec3d> pointsd(n), outd(n);
+	for (int i = 0; i < n; i++)
+		pointsd[i] = points[i];
+	Matrix4d md = m;
+	md.transform(pointsd.ptr(), outd.ptr(), n);
+	for (int i = 0; i < n; i++)
+		ASL_APPROX(outd[i], md * pointsd[i], EPS);
+	Matrix4d projd = proj;
+	projd.transform(pointsd.ptr(), outd.ptr(), n);
+	for (int i = 0; i < n; i++)
+		ASL_APPROX(outd[i], (projd * Vec4d(pointsd[i], 1)).h2c(), EPS);
+
+	PointCloud cloud(points);
+	ASL_ASSERT(cloud.length() == n);
+	PointCloud cloud2 = cloud.transformed(proj);
+	cloud.transform(m, 2);
+	for (int i = 0; i < n; i++)
+	{
+		ASL_APPROX(cloud[i], m * points[i], EPSf * 10);
+		ASL_APPROX(cloud2[i], (proj * Vec4(points[i], 1)).h2c(), EPSf * 10);
+	}
+
+	Posed pose(Vec3d(1, 2, 3), Quaterniond::fromAxisAngle(Vec3d(0, 0, 1), PI / 2));
+	PointCloudd cloudd(pointsd);
+	cloudd << Vec3d(1, 0, 0);
+	cloudd.transform(pose);
+	ASL_APPROX(cloudd[n], Vec3d(1, 3, 3), EPS);
+	pose.transform(pointsd.ptr(), outd.ptr(), n);
+	for (int i = 0; i < n; i++)
+		ASL_APPROX(outd[i], cloudd[i], EPS);
+	ASL_ASSERT(cloudd.points().length() == n + 1);
+}
+
+template<class T>
+double quaternionDiff(const Quaternion_<T>& a, const Quaterniond& b)
+{
+	return max(max(fabs(a.w - b.w), fabs(a.x - b.x)), max(fabs(a.y - b.y), fabs(a.z - b.z)));
+}
+
+template<class T>
+Posed toPosed(const Pose_<T>& a)
+{
+	return Posed(Vec3d(a.position().x, a.position().y, a.position().z), Quaterniond(a.orientation()));
+}
+
+template<class T>
+double poseDiff(const Pose_<T>& a, const Posed& b)
+{
+	return max((toPosed(a).position() - b.position()).length(), quaternionDiff(a.orientation(), b.orientation()));
+}
+
+// Returns the largest difference between batch pose operations and the same done one by one in double precision
+
+template<class T>
+double checkPoseBatch()
+{
+	int n = 1003;
+	Array<Quaternion_<T> > qa(n), qb(n), q(n);
+	Array<Pose_<T> > pa(n), pb(n), p(n);
+	Array<T> t(n);
+	for (int i = 0; i < n; i++)
+	{
+		Vec3_<T> axis(T(sin(i * 0.3)), T(cos(i * 0.7)), T(0.5 - i % 3));
+		T angle = i < 20 ? T(i * 1e-4) : T(i * 0.01);
+		qa[i] = Quaternion_<T>::fromAxisAngle(axis, T(i * 0.37));
+		qb[i] = Quaternion_<T>::fromAxisAngle(Vec3_<T>(T(0.2), 1, T(-0.3)), angle) ^ qa[i];
+		if (i % 5 == 1)
+			qb[i] = -qb[i];
+		if (i == 7)
+			qb[i] = qa[i];
+		t[i] = T((i % 11) / 10.0);
+		pa[i] = Pose_<T>(Vec3_<T>(T(i * 0.01), 1, T(-2)), qa[i]);
+		pb[i] = Pose_<T>(Vec3_<T>(T(0.5), T(i * -0.02), 3), qb[i]);
+	}
+	double err = 0;
+	Quaternion_<T>::slerp(qa.ptr(), qb.ptr(), t.ptr(), q.ptr(), n);
+	for (int i = 0; i < n; i++)
+		err = max(err, quaternionDiff(q[i], Quaterniond(qa[i]).slerp(qb[i], t[i])));
+	Pose_<T>::compose(pa.ptr(), pb.ptr(), p.ptr(), n);
+	for (int i = 0; i < n; i++)
+		err = max(err, poseDiff(p[i], toPosed(pa[i]) * toPosed(pb[i])));
+	Pose_<T>::invert(p.ptr(), p.ptr(), n);
+	for (int i = 0; i < n; i++)
+		err = max(err, poseDiff(p[i], (toPosed(pa[i]) * toPosed(pb[i])).inverse()));
+	Pose_<T>::interpolate(pa.ptr(), pb.ptr(), t.ptr(), p.ptr(), n, 4);
+	for (int i = 0; i < n; i++)
+		err = max(err, poseDiff(p[i], toPosed(pa[i]).interpolate(toPosed(pb[i]), t[i])));
+	return err;
+}
+
+ASL_TEST(PoseBatch)
+{
+	Posed a(Vec3d(1, 2, 3), Quaterniond::fromAxisAngle(Vec3d(0, 0, 1), PI / 2));
+	Posed b(Vec3d(-1, 0, 2), Quaterniond::fromAxisAngle(Vec3d(1, 1, 0), 0.3));
+	ASL_APPROX((a * b).matrix(), a.matrix() * b.matrix(), EPS);
+	ASL_APPROX((a * a.inverse()).position(), Vec3d(0, 0, 0), EPS);
+	ASL_APPROX(a.inverse().matrix(), a.matrix().inverse(), EPS);
+
+	ASL_ASSERT(checkPoseBatch<float>() < 5e-5);
+	ASL_ASSERT(checkPoseBatch<double>() < 1e-13);
 }